@@ -0,0 +1,382 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+#define BENCH_FEN_LENGTH			128
+#define EVAL_BENCH_REPEATS			2000000
+#define MAKE_BENCH_DEPTH			5
+#define EVASION_BENCH_POSITIONS		256
+
+//-- Used when "evalbench" is given no file
+static const char *bench_positions[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	"rnbqkb1r/pp1p1ppp/2p5/4P3/2B5/8/PPP1NnPP/RNBQK2R w KQkq - 0 6",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"2r3k1/1q1nbppp/r3p3/3pP3/pPpP4/P1Q2N2/2RN1PPP/2R4K b - - 0 22",
+	"r1bq1rk1/pp2nppp/2n1p3/2ppP3/3P4/P1PB1N2/2P2PPP/R1BQK2R w KQ - 1 9",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+	"8/8/7k/2R1Q1n1/1pRp4/8/2B5/5K2 w - -",
+	"2k5/p1pp4/1p3B2/8/3Q1R2/2N5/5P2/5K2 w - -",
+	"5k2/p1pK3p/1p2Q1p1/5Pq1/4P3/8/P5P1/8 b - -",
+	"1k6/8/8/5PP1/3Pp2p/P7/8/4K3 w - -"
+};
+
+//-- Read one position per line (FEN or EPD); returns the number loaded
+static int load_bench_positions(char *filename, char (**fens)[BENCH_FEN_LENGTH])
+{
+	int count = 0;
+	int size = 0;
+
+	*fens = NULL;
+
+	if (filename == NULL || filename[0] == 0) {
+		count = sizeof(bench_positions) / sizeof(bench_positions[0]);
+		*fens = (char(*)[BENCH_FEN_LENGTH])malloc(count * BENCH_FEN_LENGTH);
+		for (int i = 0; i < count; i++)
+			strcpy((*fens)[i], bench_positions[i]);
+		return count;
+	}
+
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) {
+		printf("info string Unable to open %s\n", filename);
+		return 0;
+	}
+
+	char line[BENCH_FEN_LENGTH];
+	while (fgets(line, BENCH_FEN_LENGTH, f)) {
+		char *p = strchr(line, '\n');
+		if (p) *p = 0;
+		if (strlen(line) < 8)
+			continue;
+		if (count == size) {
+			size = (size ? 2 * size : 1024);
+			*fens = (char(*)[BENCH_FEN_LENGTH])realloc(*fens, size * BENCH_FEN_LENGTH);
+			assert(*fens);
+		}
+		strcpy((*fens)[count++], line);
+	}
+	fclose(f);
+	return count;
+}
+
+//-- Evaluations per second of calc_evaluation() (no eval cache) for each available mobility kernel
+void eval_bench(char *filename)
+{
+	char (*fens)[BENCH_FEN_LENGTH];
+	struct t_chess_eval eval[1];
+	int count;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	count = load_bench_positions(filename, &fens);
+	if (count == 0) {
+		free(fens);
+		return;
+	}
+
+	int repeats = EVAL_BENCH_REPEATS / count;
+	if (repeats < 1) repeats = 1;
+
+	BOOL saved_avx2 = use_avx2;
+	long long checksum[2] = { 0, 0 };
+
+	init_eval(eval);
+
+	for (int kernel = 0; kernel <= 1; kernel++) {
+
+		if (kernel == 1 && !avx2_kernels_available())
+			break;
+		use_avx2 = (kernel == 1);
+
+		t_nodes evaluations = 0;
+		unsigned long start = time_now();
+
+		for (int i = 0; i < count; i++) {
+			set_fen(position, fens[i]);
+			for (int r = 0; r < repeats; r++)
+				checksum[kernel] += calc_evaluation(position, eval);
+			evaluations += repeats;
+		}
+
+		unsigned long finish = time_now();
+		if (finish == start)
+			finish++;
+
+		printf("info string Eval Bench (%s): %d positions, %I64d evaluations in %d milliseconds = %I64d evals per second\n",
+			   use_avx2 ? "avx2" : "scalar", count, evaluations, finish - start, 1000 * evaluations / (finish - start));
+	}
+
+	if (avx2_kernels_available() && checksum[0] != checksum[1])
+		printf("info string Eval Bench: ERROR - avx2 and scalar kernels disagree!\n");
+
+	use_avx2 = saved_avx2;
+	free(fens);
+}
+
+//-- Sliders and blockers the eval uses for each color's rooks, queens and bishops (x-rays through friendly sliders)
+struct t_fill_bench_sets
+{
+	t_bitboard sliders[3][2];
+	t_bitboard occupied[3][2];
+	t_bitboard empty[3][2];
+};
+
+static void fill_bench_sets(struct t_board *board, struct t_fill_bench_sets *sets)
+{
+	for (t_chess_color color = WHITE; color <= BLACK; color++) {
+		sets->sliders[0][color] = board->pieces[color][ROOK];
+		sets->sliders[1][color] = board->pieces[color][QUEEN];
+		sets->sliders[2][color] = board->pieces[color][BISHOP];
+		sets->occupied[0][color] = board->all_pieces ^ board->pieces[color][QUEEN] ^ board->pieces[color][ROOK];
+		sets->occupied[1][color] = sets->occupied[0][color] ^ board->pieces[color][BISHOP];
+		sets->occupied[2][color] = board->occupied[OPPONENT(color)] | board->pieces[color][PAWN];
+		for (int p = 0; p < 3; p++)
+			sets->empty[p][color] = ~sets->occupied[p][color];
+	}
+}
+
+//-- Bulk slider attack maps per second: one magic lookup per piece against each set-wise fill kernel
+void fill_bench(char *filename)
+{
+	char (*fens)[BENCH_FEN_LENGTH];
+	struct t_fill_bench_sets *sets;
+	t_bitboard attacks[3][2];
+	int count;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	count = load_bench_positions(filename, &fens);
+	if (count == 0) {
+		free(fens);
+		return;
+	}
+
+	sets = (struct t_fill_bench_sets *)malloc(count * sizeof(struct t_fill_bench_sets));
+	for (int i = 0; i < count; i++) {
+		set_fen(position, fens[i]);
+		fill_bench_sets(position, &sets[i]);
+	}
+
+	int repeats = EVAL_BENCH_REPEATS / count;
+	if (repeats < 1) repeats = 1;
+
+	int saved_kernel = fill_kernel;
+	t_bitboard checksum[4] = { 0, 0, 0, 0 };
+
+	//-- Kernel -1 is the magic loop
+	for (int kernel = -1; kernel <= FILL_KERNEL_AVX2; kernel++) {
+
+		if (kernel == FILL_KERNEL_AVX2 && !avx2_kernels_available())
+			break;
+		fill_kernel = kernel;
+
+		unsigned long start = time_now();
+
+		for (int r = 0; r < repeats; r++) {
+			for (int i = 0; i < count; i++) {
+				struct t_fill_bench_sets *s = &sets[i];
+				if (kernel < 0) {
+					for (t_chess_color color = WHITE; color <= BLACK; color++) {
+						t_bitboard b;
+						attacks[0][color] = attacks[1][color] = attacks[2][color] = 0;
+						for (b = s->sliders[0][color]; b;)
+							attacks[0][color] |= rook_attacks(bitscan_reset(&b), s->occupied[0][color]);
+						for (b = s->sliders[1][color]; b;) {
+							t_chess_square square = bitscan_reset(&b);
+							attacks[1][color] |= rook_attacks(square, s->occupied[1][color]) | bishop_attacks(square, s->occupied[1][color]);
+						}
+						for (b = s->sliders[2][color]; b;)
+							attacks[2][color] |= bishop_attacks(bitscan_reset(&b), s->occupied[2][color]);
+					}
+				}
+				else {
+					rook_fill(s->sliders[0], s->empty[0], attacks[0]);
+					queen_fill(s->sliders[1], s->empty[1], attacks[1]);
+					bishop_fill(s->sliders[2], s->empty[2], attacks[2]);
+				}
+				checksum[kernel + 1] += (attacks[0][WHITE] ^ attacks[1][WHITE] * 3 ^ attacks[2][WHITE] * 5)
+					+ (attacks[0][BLACK] ^ attacks[1][BLACK] * 3 ^ attacks[2][BLACK] * 5) * 7;
+			}
+		}
+
+		unsigned long finish = time_now();
+		if (finish == start)
+			finish++;
+
+		t_nodes maps = (t_nodes)repeats * count;
+		printf("info string Fill Bench (%s): %d positions, %I64d attack maps in %d milliseconds = %I64d maps per second\n",
+			   kernel < 0 ? "magic" : fill_kernel_name(kernel), count, maps, finish - start, 1000 * maps / (finish - start));
+
+		if (kernel >= 0 && checksum[kernel + 1] != checksum[0])
+			printf("info string Fill Bench: ERROR - %s fills and magics disagree!\n", fill_kernel_name(kernel));
+	}
+
+	fill_kernel = saved_kernel;
+
+	//-- King evasions, magic per square against one filled map, on the checks one move from the positions
+	struct t_board *checks = (struct t_board *)malloc(EVASION_BENCH_POSITIONS * sizeof(struct t_board));
+	struct t_move_list moves[1], evasions[1];
+	struct t_undo undo[1];
+	int check_count = 0;
+
+	for (int i = 0; i < count && check_count < EVASION_BENCH_POSITIONS; i++) {
+		set_fen(position, fens[i]);
+		generate_legal_moves(position, moves);
+		for (int m = 0; m < moves->count && check_count < EVASION_BENCH_POSITIONS; m++) {
+			make_move(position, moves->move[m], undo);
+			if (position->in_check)
+				copy_board(&checks[check_count++], position);
+			unmake_move(position, undo);
+		}
+	}
+
+	BOOL saved_evasions = use_fill_evasions;
+	t_nodes generated[2] = { 0, 0 };
+
+	for (int fill = 0; fill <= 1 && check_count > 0; fill++) {
+
+		use_fill_evasions = fill;
+		int evasion_repeats = EVAL_BENCH_REPEATS / check_count;
+
+		unsigned long start = time_now();
+
+		for (int r = 0; r < evasion_repeats; r++) {
+			for (int i = 0; i < check_count; i++) {
+				generate_evade_check(&checks[i], evasions);
+				generated[fill] += evasions->count;
+			}
+		}
+
+		unsigned long finish = time_now();
+		if (finish == start)
+			finish++;
+
+		t_nodes lists = (t_nodes)evasion_repeats * check_count;
+		printf("info string Fill Bench (evasions, %s): %d positions, %I64d move lists in %d milliseconds = %I64d lists per second\n",
+			   fill ? fill_kernel_name(fill_kernel) : "magic", check_count, lists, finish - start, 1000 * lists / (finish - start));
+	}
+
+	if (generated[0] != generated[1])
+		printf("info string Fill Bench: ERROR - filled and magic evasions disagree!\n");
+
+	use_fill_evasions = saved_evasions;
+	free(checks);
+	free(sets);
+	free(fens);
+}
+
+//-- Perft nodes per second with make / unmake against copy-make, over the same positions
+void make_bench(char *filename)
+{
+	char (*fens)[BENCH_FEN_LENGTH];
+	int count;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	count = load_bench_positions(filename, &fens);
+	if (count == 0) {
+		free(fens);
+		return;
+	}
+
+#ifdef COPY_MAKE
+	printf("info string Make Bench: the search is built for copy-make\n");
+#else
+	printf("info string Make Bench: the search is built for make / unmake\n");
+#endif
+
+	t_nodes total[2] = { 0, 0 };
+
+	for (int method = 0; method <= 1; method++) {
+
+		unsigned long start = time_now();
+
+		for (int i = 0; i < count; i++) {
+			set_fen(position, fens[i]);
+			total[method] += (method == 0 ? do_perft(position, MAKE_BENCH_DEPTH) : do_perft_copy(position, MAKE_BENCH_DEPTH));
+		}
+
+		unsigned long finish = time_now();
+		if (finish == start)
+			finish++;
+
+		printf("info string Make Bench (%s): %d positions, %I64d nodes in %d milliseconds = %I64d nodes per second\n",
+			   method == 0 ? "make / unmake" : "copy-make", count, total[method], finish - start, 1000 * total[method] / (finish - start));
+	}
+
+	printf("info string Make Bench: copy-make copies %d bytes a move\n", (int)(use_nnue ? sizeof(struct t_board) : COMPACT_BOARD_SIZE));
+
+	if (total[0] != total[1])
+		printf("info string Make Bench: ERROR - make / unmake and copy-make disagree!\n");
+
+	free(fens);
+}
+
+//-- One line of the footprint report
+static size_t footprint_line(const char *name, size_t bytes)
+{
+	printf("info string Footprint: %-22s %9d bytes\n", name, (int)bytes);
+	return bytes;
+}
+
+#define FOOTPRINT(t)						footprint_line(#t, sizeof(t))
+
+//-- Memory used by the engine's tables, so the working set of the search can be kept in cache
+void footprint_report()
+{
+	size_t total = 0;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	//-- Looked up during the search
+	total += FOOTPRINT(xmove_list);
+	total += FOOTPRINT(move_directory);
+	total += FOOTPRINT(slider_attacks);
+	total += FOOTPRINT(rook_magic) + FOOTPRINT(bishop_magic);
+	total += FOOTPRINT(between);
+	total += FOOTPRINT(xray);
+	total += FOOTPRINT(can_move);
+	total += FOOTPRINT(knight_mask) + FOOTPRINT(king_mask) + FOOTPRINT(pawn_attackers);
+	total += FOOTPRINT(rook_rays) + FOOTPRINT(bishop_rays) + FOOTPRINT(queen_rays);
+	total += FOOTPRINT(forward_squares) + FOOTPRINT(connected_pawn_mask) + FOOTPRINT(square_rank_mask) + FOOTPRINT(square_column_mask);
+	total += FOOTPRINT(piece_square_table);
+	total += FOOTPRINT(passed_pawn_bonus);
+	total += FOOTPRINT(hash_value);
+	total += FOOTPRINT(check_info);
+	total += FOOTPRINT(draw_stack);
+	total += FOOTPRINT(cuckoo) + FOOTPRINT(cuckoo_from) + FOOTPRINT(cuckoo_to);
+	total += FOOTPRINT(kpk_bitbase);
+	total += FOOTPRINT(material_index_value);
+	total += footprint_line("material_record", MATERIAL_INDEX_SIZE * sizeof(struct t_material_record));
+	total += FOOTPRINT(position);
+	if (use_nnue)
+		total += FOOTPRINT(nnue_network);
+	printf("info string Footprint: %-22s %9d bytes\n", "total", (int)total);
+
+	//-- Sized by the UCI options
+	footprint_line("hash_table", (hash_mask + HASH_ATTEMPTS) * sizeof(struct t_hash_record));
+	footprint_line("pawn_hash", (pawn_hash_mask + 1) * sizeof(struct t_pawn_hash_record));
+	footprint_line("eval_hash", (eval_hash_mask + 1) * sizeof(struct t_eval_hash_record));
+}
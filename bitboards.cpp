@@ -16,386 +16,292 @@
 #include "procs.h"
 #include "bittwiddle.h"
 
-t_bitboard index_to_bitboard(t_bitboard mask, int index)
+//===========================================================//
+// Board geometry, generated by the compiler
+//
+// Each table entry is a constant expression, so the tables
+// are in the executable's read-only data: nothing is built
+// at startup and the pages are shared by every running
+// engine.  SQUARES() and TARGETS() write out the 64 (or
+// 64 x 64) initializers.
+//===========================================================//
+
+#define SQUARES_8(m, a, s)					m(a, s) m(a, s + 1) m(a, s + 2) m(a, s + 3) m(a, s + 4) m(a, s + 5) m(a, s + 6) m(a, s + 7)
+#define SQUARES(m, a)						SQUARES_8(m, a, 0) SQUARES_8(m, a, 8) SQUARES_8(m, a, 16) SQUARES_8(m, a, 24) SQUARES_8(m, a, 32) SQUARES_8(m, a, 40) SQUARES_8(m, a, 48) SQUARES_8(m, a, 56)
+#define TARGETS_8(f, s, t)					f(s, t), f(s, t + 1), f(s, t + 2), f(s, t + 3), f(s, t + 4), f(s, t + 5), f(s, t + 6), f(s, t + 7),
+#define TARGETS(f, s)						{ TARGETS_8(f, s, 0) TARGETS_8(f, s, 8) TARGETS_8(f, s, 16) TARGETS_8(f, s, 24) TARGETS_8(f, s, 32) TARGETS_8(f, s, 40) TARGETS_8(f, s, 48) TARGETS_8(f, s, 56) }
+
+#define SQUARE_ENTRY(f, s)					f(s),
+#define WHITE_ENTRY(f, s)					f(WHITE, s),
+#define BLACK_ENTRY(f, s)					f(BLACK, s),
+#define TARGET_ROW(f, s)					TARGETS(f, s),
+
+static constexpr BOOL on_board(int rank, int column)
 {
-    t_bitboard a = mask;
-    t_bitboard b;
-    t_bitboard result = 0;
-    int n = popcount(mask);
-    int i;
-
-    assert(mask != 0);
-
-    for (i = 0; i < n; i++) {
-        b = ((a - 1) & a) ^ a;
-        a &= (a - 1);
-        if (((int)1 << i) & index)
-            result |= b;
-    }
-    return(result);
+    return rank >= 0 && rank <= 7 && column >= 0 && column <= 7;
 }
 
-void init_bitboards()
+//-- The square one step away, if there is one
+static constexpr t_bitboard step_bits(int s, int dr, int dc)
 {
-    t_chess_square s, target, target64, xtarget;
-    int d, delta;
-    int i, r, f;
-    t_chess_color color;
-    t_bitboard b;
-
-	//-- Square Column / Rank Mask
-	memset(square_column_mask, 0, sizeof(square_column_mask));
-	memset(square_rank_mask, 0, sizeof(square_column_mask));
-	for (f = 0; f <= 7; f++){
-		for (r = 0; r <= 7; r++){
-			for (i = 0; i <= 7; i++){
-				square_column_mask[r * 8 + f] |= SQUARE64(i * 8 + f);
-				square_rank_mask[r * 8 + f] |= SQUARE64(r * 8 + i);
-			}
-		}
-	}
-
-    // Initialize rank
-    for (r = 0; r < 8; r++) {
-        rank_mask[WHITE][r] = 0;
-        rank_mask[BLACK][r] = 0;
-        for (f = 0; f < 8; f++) {
-            rank_mask[WHITE][r] |= SQUARE64((r * 8) + f);
-            rank_mask[BLACK][r] |= SQUARE64(((7 - r) * 8) + f);
-        }
-    }
+    return on_board(RANK(s) + dr, COLUMN(s) + dc) ? SQUARE64((RANK(s) + dr) * 8 + COLUMN(s) + dc) : 0;
+}
 
-    //-- Column Mask
-    for (f = 0; f < 8; f++) {
-        column_mask[f] = 0;
-        for (r = 0; r < 8; r++)
-            column_mask[f] |= SQUARE64(f + r * 8);
+//-- Squares along a direction up to and including the first blocker
+static constexpr t_bitboard ray_bits(int s, int dr, int dc, t_bitboard occupied)
+{
+    t_bitboard b = 0;
+    for (int r = RANK(s) + dr, c = COLUMN(s) + dc; on_board(r, c); r += dr, c += dc) {
+        b |= SQUARE64(r * 8 + c);
+        if (occupied & SQUARE64(r * 8 + c))
+            break;
     }
+    return b;
+}
 
-    //-- Neighboring file
-    for (f = 0; f < 8; f++) {
-        neighboring_file[f] = 0;
-        if (f > 0) {
-            for (r = 0; r < 8; r++)
-                neighboring_file[f] |= SQUARE64((f - 1) + r * 8);
-        }
-        if (f < 7) {
-            for (r = 0; r < 8; r++)
-                neighboring_file[f] |= SQUARE64((f + 1) + r * 8);
-        }
-    }
+//-- Squares along a direction whose occupancy matters to a slider (the last square never blocks anything)
+static constexpr t_bitboard mask_bits(int s, int dr, int dc)
+{
+    t_bitboard b = 0;
+    for (int r = RANK(s) + dr, c = COLUMN(s) + dc; on_board(r + dr, c + dc); r += dr, c += dc)
+        b |= SQUARE64(r * 8 + c);
+    return b;
+}
 
-    //-- Initialize Castle Possible
-    castle[0].possible = SQUARE64(F1) | SQUARE64(G1);
-    castle[1].possible = SQUARE64(D1) | SQUARE64(C1) | SQUARE64(B1);
-    castle[2].possible = SQUARE64(F8) | SQUARE64(G8);
-    castle[3].possible = SQUARE64(D8) | SQUARE64(C8) | SQUARE64(B8);
-
-    //-- Initialize Castle Attacks
-    castle[0].not_attacked = (SQUARE64(F1) | SQUARE64(G1));
-    castle[1].not_attacked = (SQUARE64(D1) | SQUARE64(C1));
-    castle[2].not_attacked = (SQUARE64(F8) | SQUARE64(G8));
-    castle[3].not_attacked = (SQUARE64(D8) | SQUARE64(C8));
-
-    //-- Initialize Rook Square
-    castle[0].rook_from = H1;
-    castle[1].rook_from = A1;
-    castle[2].rook_from = H8;
-    castle[3].rook_from = A8;
-
-    castle[0].rook_to	= F1;
-    castle[1].rook_to = D1;
-    castle[2].rook_to = F8;
-    castle[3].rook_to = D8;
-
-    //-- Initialize King Square
-    castle[0].king_from = E1;
-    castle[1].king_from = E1;
-    castle[2].king_from = E8;
-    castle[3].king_from = E8;
-
-    for (i = 0; i < 4; i++) {
-        castle[i].rook_from_to = (SQUARE64(castle[i].rook_from) | SQUARE64(castle[i].rook_to));
-        castle[i].rook_piece = PIECEINDEX((i >> 1), ROOK);
-    }
-    // Initialize BETWEEN array
-    for (s = A1; s <= H8; s++) {
-        for (target = A1; target <= H8; target++) {
-            between[s][target] = 0;
-            line[s][target] = 0;
-            xray[s][target] = 0;
-        }
-    }
+static constexpr t_bitboard rook_bits(int s, t_bitboard occupied)
+{
+    return ray_bits(s, 1, 0, occupied) | ray_bits(s, -1, 0, occupied) | ray_bits(s, 0, 1, occupied) | ray_bits(s, 0, -1, occupied);
+}
 
-    for (s = A1; s <= H8; s++) {
-
-        // Pawn attacks
-        b = SQUARE64(s);
-
-        //--White
-        pawn_attackers[WHITE][s] = 0;
-        if (b & ~(rank_mask[WHITE][FIRST_RANK] | rank_mask[WHITE][SECOND_RANK])) {
-            if (COLUMN(s) > 0)
-                pawn_attackers[WHITE][s] |= (b >> 9);
-            if (COLUMN(s) < 7)
-                pawn_attackers[WHITE][s] |= (b >> 7);
-        }
-        //--Black
-        pawn_attackers[BLACK][s] = 0;
-        if (b & ~(rank_mask[BLACK][FIRST_RANK] | rank_mask[BLACK][SECOND_RANK])) {
-            if (COLUMN(s) > 0)
-                pawn_attackers[BLACK][s] |= (b << 7);
-            if (COLUMN(s) < 7)
-                pawn_attackers[BLACK][s] |= (b << 9);
-        }
-
-		//-- in front white
-		forward_squares[WHITE][s] = 0;
-		forward_squares[WHITE][s] = (b << 8) | (b << 16) | (b << 24) | (b << 32) | (b << 40) | (b << 48) | (b << 56);
-
-		//--in front black
-		forward_squares[BLACK][s] = 0;
-		forward_squares[BLACK][s] = (b >> 8) | (b >> 16) | (b >> 24) | (b >> 32) | (b >> 40) | (b >> 48) | (b >> 56);
-
-		// Bishop
-        line[s][s] = SQUARE64(s);
-        d = 0;
-        for (delta = direction[BISHOP][d]; (delta = direction[BISHOP][d]) != 0; d++) {
-            target = x88_SQUARE(s) + delta;
-            while (x88_ONBOARD(target)) {
-                target64 = x88_TO_64(target);
-                line[s][target64] = (SQUARE64(target64) | line[s][x88_TO_64(target - delta)]);
-                if (x88_ONBOARD(target + delta))
-                    between[s][x88_TO_64(target + delta)] = (SQUARE64(x88_TO_64(target)) | between[s][x88_TO_64(target)]);
-                bishop_rays[s] |= SQUARE64(target64);
-                queen_rays[s] |= SQUARE64(target64);
-                xray[s][target64] = 0;
-                xtarget = target + delta;
-                while (x88_ONBOARD(xtarget)) {
-                    xray[s][target64] |= SQUARE64(x88_TO_64(xtarget));
-                    xtarget += delta;
-                }
-                target += delta;
-            }
-        }
-        // Rook
-        line[s][s] = SQUARE64(s);
-        d = 0;
-        for (delta = direction[ROOK][d]; (delta = direction[ROOK][d]) != 0; d++) {
-            target = x88_SQUARE(s) + delta;
-            while (x88_ONBOARD(target)) {
-                target64 = x88_TO_64(target);
-                line[s][target64] = (SQUARE64(target64) | line[s][x88_TO_64(target - delta)]);
-                if (x88_ONBOARD(target + delta))
-                    between[s][x88_TO_64(target + delta)] = (SQUARE64(x88_TO_64(target)) | between[s][x88_TO_64(target)]);
-                rook_rays[s] |= SQUARE64(target64);
-                queen_rays[s] |= SQUARE64(target64);
-                xray[s][target64] = 0;
-                xtarget = target + delta;
-                while (x88_ONBOARD(xtarget)) {
-                    xray[s][target64] |= SQUARE64(x88_TO_64(xtarget));
-                    xtarget += delta;
-                }
-                target += delta;
-            }
-        }
-        // Knight
-        knight_mask[s] = 0;
-        d = 0;
-        for (delta = direction[KNIGHT][d]; (delta = direction[KNIGHT][d]) != 0; d++) {
-            target = x88_SQUARE(s) + delta;
-            if (x88_ONBOARD(target))
-                knight_mask[s] |= SQUARE64(x88_TO_64(target));
-        }
-        // King
-        king_mask[s] = 0;
-        d = 0;
-        for (delta = direction[KING][d]; (delta = direction[KING][d]) != 0; d++) {
-            target = x88_SQUARE(s) + delta;
-            if (x88_ONBOARD(target))
-                king_mask[s] |= SQUARE64(x88_TO_64(target));
-        }
-
-		//-- Connected passed pawn mask
-		connected_pawn_mask[s] = king_mask[s] & neighboring_file[COLUMN(s)];
-    }
+static constexpr t_bitboard bishop_bits(int s, t_bitboard occupied)
+{
+    return ray_bits(s, 1, 1, occupied) | ray_bits(s, 1, -1, occupied) | ray_bits(s, -1, 1, occupied) | ray_bits(s, -1, -1, occupied);
+}
+
+static constexpr t_bitboard rook_ray_bits(int s) { return rook_bits(s, 0); }
+static constexpr t_bitboard bishop_ray_bits(int s) { return bishop_bits(s, 0); }
+static constexpr t_bitboard queen_ray_bits(int s) { return rook_bits(s, 0) | bishop_bits(s, 0); }
 
-	assert(connected_pawn_mask[C2] == (SQUARE64(B1) | SQUARE64(B2) | SQUARE64(B3) | SQUARE64(D1) | SQUARE64(D2) | SQUARE64(D3)));
-    assert(pawn_attackers[WHITE][E4] == (SQUARE64(D3) | SQUARE64(F3)));
-    assert(pawn_attackers[BLACK][H4] == SQUARE64(G5));
-    assert(pawn_attackers[WHITE][A8] == SQUARE64(B7));
-    assert(xray[C2][E4] == (SQUARE64(F5) | SQUARE64(G6) | SQUARE64(H7)));
-    assert(line[C2][F2] == (SQUARE64(C2) | SQUARE64(D2) | SQUARE64(E2) | SQUARE64(F2)));
-    assert(line[D4][G1] == (SQUARE64(D4) | SQUARE64(E3) | SQUARE64(F2) | SQUARE64(G1)));
+static constexpr t_bitboard knight_bits(int s)
+{
+    return step_bits(s, 2, 1) | step_bits(s, 2, -1) | step_bits(s, 1, 2) | step_bits(s, 1, -2)
+         | step_bits(s, -1, 2) | step_bits(s, -1, -2) | step_bits(s, -2, 1) | step_bits(s, -2, -1);
 }
 
-void init_magic()
+static constexpr t_bitboard king_bits(int s)
 {
-    t_chess_square square;
-    t_bitboard mask, and_result;
-    int i, index;
+    return step_bits(s, 1, -1) | step_bits(s, 1, 0) | step_bits(s, 1, 1) | step_bits(s, 0, -1)
+         | step_bits(s, 0, 1) | step_bits(s, -1, -1) | step_bits(s, -1, 0) | step_bits(s, -1, 1);
+}
 
-    for (square = A1; square <= H8; square++) {
-        // Reset
-        for (i = 0; i < 4096; i++)
-            rook_magic_moves[square][i] = 0;
-        for (i = 0; i < 512; i++)
-            bishop_magic_moves[square][i] = 0;
-
-        // Rooks
-        mask = create_rook_mask(square);
-        for (i = 0; i < (int)1 << popcount(mask); i++) {
-            and_result = index_to_bitboard(mask, i);
-            index = (int)((and_result * rook_magic[square].magic) >> 52);
-            assert((rook_magic_moves[square][index] == 0) || (rook_magic_moves[square][index] == create_rook_attacks(square, and_result)));
-            rook_magic_moves[square][index] = create_rook_attacks(square, and_result);
-        }
-        // Bishops
-        mask = create_bishop_mask(square);
-        for (i = 0; i < (int)1 << popcount(mask); i++) {
-            and_result = index_to_bitboard(mask, i);
-            index = (int)((and_result * bishop_magic[square].magic) >> 55);
-            assert((bishop_magic_moves[square][index] == 0) || (bishop_magic_moves[square][index] == create_bishop_attacks(square, and_result)));
-            bishop_magic_moves[square][index] = create_bishop_attacks(square, and_result);
-        }
-    }
+static constexpr t_bitboard rank_bits(int r) { return (t_bitboard)0xff << (8 * r); }
+static constexpr t_bitboard column_bits(int f) { return (t_bitboard)0x0101010101010101ULL << f; }
+
+static constexpr t_bitboard neighboring_file_bits(int f)
+{
+    return (f > 0 ? column_bits(f - 1) : 0) | (f < 7 ? column_bits(f + 1) : 0);
 }
 
-t_bitboard create_rook_mask(t_chess_square s)
+static constexpr int sign(int x) { return (x > 0) - (x < 0); }
+
+//-- On the same rank, file or diagonal (and not the same square)
+static constexpr BOOL aligned(int from, int to)
 {
-    int s_rank, s_column, r, c;
-    t_bitboard b = 0;
+    return from != to && (RANK(from) == RANK(to) || COLUMN(from) == COLUMN(to)
+                          || RANK(from) - RANK(to) == COLUMN(from) - COLUMN(to) || RANK(from) - RANK(to) == COLUMN(to) - COLUMN(from));
+}
 
-    s_rank = RANK(s);
-    s_column = COLUMN(s);
+static constexpr t_bitboard between_bits(int from, int to)
+{
+    return aligned(from, to) ? ray_bits(from, sign(RANK(to) - RANK(from)), sign(COLUMN(to) - COLUMN(from)), SQUARE64(to)) & ~SQUARE64(to) : 0;
+}
 
-    // East
-    r = s_rank;
-    c = s_column;
-    for (c = s_column + 1; c < 7; c++) {
-        b |= SQUARE64(r * 8 + c);
-    }
+static constexpr t_bitboard xray_bits(int from, int to)
+{
+    return aligned(from, to) ? ray_bits(to, sign(RANK(to) - RANK(from)), sign(COLUMN(to) - COLUMN(from)), 0) : 0;
+}
 
-    // West
-    r = s_rank;
-    c = s_column;
-    for (c = s_column - 1; c > 0; c--) {
-        b |= SQUARE64(r * 8 + c);
-    }
+//-- Pawns of "color" which would attack the square
+static constexpr t_bitboard pawn_attacker_bits(int color, int s)
+{
+    return color == WHITE ? (RANK(s) >= 2 ? step_bits(s, -1, -1) | step_bits(s, -1, 1) : 0)
+                          : (RANK(s) <= 5 ? step_bits(s, 1, -1) | step_bits(s, 1, 1) : 0);
+}
 
-    // North
-    r = s_rank;
-    c = s_column;
-    for (r = s_rank + 1; r < 7; r++) {
-        b |= SQUARE64(r * 8 + c);
-    }
+static constexpr t_bitboard forward_bits(int color, int s)
+{
+    return ray_bits(s, color == WHITE ? 1 : -1, 0, 0);
+}
 
-    // South
-    r = s_rank;
-    c = s_column;
-    for (r = s_rank - 1; r > 0; r--) {
-        b |= SQUARE64(r * 8 + c);
-    }
+static constexpr t_bitboard connected_pawn_bits(int s)
+{
+    return king_bits(s) & neighboring_file_bits(COLUMN(s));
+}
 
-    return b;
+static constexpr t_bitboard square_rank_bits(int s) { return rank_bits(RANK(s)); }
+static constexpr t_bitboard square_column_bits(int s) { return column_bits(COLUMN(s)); }
+
+constexpr t_bitboard between[64][64] = { SQUARES(TARGET_ROW, between_bits) };
+constexpr t_bitboard xray[64][64] = { SQUARES(TARGET_ROW, xray_bits) };
+constexpr t_bitboard bishop_rays[64] = { SQUARES(SQUARE_ENTRY, bishop_ray_bits) };
+constexpr t_bitboard rook_rays[64] = { SQUARES(SQUARE_ENTRY, rook_ray_bits) };
+constexpr t_bitboard queen_rays[64] = { SQUARES(SQUARE_ENTRY, queen_ray_bits) };
+constexpr t_bitboard knight_mask[64] = { SQUARES(SQUARE_ENTRY, knight_bits) };
+constexpr t_bitboard king_mask[64] = { SQUARES(SQUARE_ENTRY, king_bits) };
+constexpr t_bitboard pawn_attackers[2][64] = { { SQUARES(WHITE_ENTRY, pawn_attacker_bits) }, { SQUARES(BLACK_ENTRY, pawn_attacker_bits) } };
+constexpr t_bitboard forward_squares[2][64] = { { SQUARES(WHITE_ENTRY, forward_bits) }, { SQUARES(BLACK_ENTRY, forward_bits) } };
+constexpr t_bitboard connected_pawn_mask[64] = { SQUARES(SQUARE_ENTRY, connected_pawn_bits) };
+constexpr t_bitboard square_rank_mask[64] = { SQUARES(SQUARE_ENTRY, square_rank_bits) };
+constexpr t_bitboard square_column_mask[64] = { SQUARES(SQUARE_ENTRY, square_column_bits) };
+
+constexpr t_bitboard rank_mask[2][8] = {
+    { rank_bits(0), rank_bits(1), rank_bits(2), rank_bits(3), rank_bits(4), rank_bits(5), rank_bits(6), rank_bits(7) },
+    { rank_bits(7), rank_bits(6), rank_bits(5), rank_bits(4), rank_bits(3), rank_bits(2), rank_bits(1), rank_bits(0) }
+};
+constexpr t_bitboard column_mask[8] = { column_bits(0), column_bits(1), column_bits(2), column_bits(3), column_bits(4), column_bits(5), column_bits(6), column_bits(7) };
+constexpr t_bitboard neighboring_file[8] = {
+    neighboring_file_bits(0), neighboring_file_bits(1), neighboring_file_bits(2), neighboring_file_bits(3),
+    neighboring_file_bits(4), neighboring_file_bits(5), neighboring_file_bits(6), neighboring_file_bits(7)
+};
+
+//-- possible, not_attacked, king_from, rook_from, rook_to, rook_from_to, rook_piece
+constexpr struct t_castle_record castle[4] = {
+    { SQUARE64(F1) | SQUARE64(G1), SQUARE64(F1) | SQUARE64(G1), E1, H1, F1, SQUARE64(H1) | SQUARE64(F1), WHITEROOK },
+    { SQUARE64(D1) | SQUARE64(C1) | SQUARE64(B1), SQUARE64(D1) | SQUARE64(C1), E1, A1, D1, SQUARE64(A1) | SQUARE64(D1), WHITEROOK },
+    { SQUARE64(F8) | SQUARE64(G8), SQUARE64(F8) | SQUARE64(G8), E8, H8, F8, SQUARE64(H8) | SQUARE64(F8), BLACKROOK },
+    { SQUARE64(D8) | SQUARE64(C8) | SQUARE64(B8), SQUARE64(D8) | SQUARE64(C8), E8, A8, D8, SQUARE64(A8) | SQUARE64(D8), BLACKROOK }
+};
+
+static_assert(connected_pawn_mask[C2] == (SQUARE64(B1) | SQUARE64(B2) | SQUARE64(B3) | SQUARE64(D1) | SQUARE64(D2) | SQUARE64(D3)), "connected_pawn_mask");
+static_assert(pawn_attackers[WHITE][E4] == (SQUARE64(D3) | SQUARE64(F3)), "pawn_attackers");
+static_assert(pawn_attackers[BLACK][H4] == SQUARE64(G5), "pawn_attackers");
+static_assert(pawn_attackers[WHITE][A8] == SQUARE64(B7), "pawn_attackers");
+static_assert(xray[C2][E4] == (SQUARE64(F5) | SQUARE64(G6) | SQUARE64(H7)), "xray");
+static_assert(between[D4][G1] == (SQUARE64(E3) | SQUARE64(F2)), "between");
+static_assert(between[C2][D3] == 0 && between[C2][E1] == 0, "between");
+static_assert(between[A1][H8] == (SQUARE64(B2) | SQUARE64(C3) | SQUARE64(D4) | SQUARE64(E5) | SQUARE64(F6) | SQUARE64(G7)), "between");
+
+//===========================================================//
+// Magics
+//
+// The numbers were found once by a seeded search and are
+// fixed here; masks, shifts and offsets are constant too.
+// Only the shared attack table is filled at startup, in
+// PEXT or magic order depending on the CPU.
+//===========================================================//
+
+static constexpr t_magic rook_magics[64] = {
+    0x0a80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xc200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00a0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000a00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010a004a00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xc020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010a386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490a000084ULL,
+    0x0080002000504000ULL, 0x200020005000c000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040a100021ULL,
+    0x000200282410a102ULL, 0x000200282410a102ULL, 0x000200282410a102ULL, 0x4048240043802106ULL
+};
+
+static constexpr t_magic bishop_magics[64] = {
+    0x40106000a1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050c040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422a02000001ULL,
+    0x000a220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880c00a00100ULL, 0x0080400200522010ULL, 0x0001000188180b04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100a0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380d1004100ULL, 0x0008004422020284ULL, 0x01010a1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100c00ULL, 0x0202200802010104ULL,
+    0x8c0a020200440085ULL, 0x01a0008080b10040ULL, 0x0889520080122800ULL, 0x100902022202010aULL,
+    0x04081a0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0a00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440a210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00ac102001210220ULL, 0x0220021002009900ULL, 0x84440c080a013080ULL,
+    0x0001008044200440ULL, 0x0004c04410841000ULL, 0x2000500104011130ULL, 0x1a0c010011c20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822c08200ULL, 0x48081010008a2a80ULL
+};
+
+static constexpr int bit_count(t_bitboard b)
+{
+    int n = 0;
+    for (; b; b &= b - 1)
+        n++;
+    return n;
 }
 
-t_bitboard create_bishop_mask(t_chess_square s)
+static constexpr t_bitboard rook_mask_bits(int s)
 {
-    int s_rank, s_column, r, c;
-    t_bitboard b = 0;
+    return mask_bits(s, 1, 0) | mask_bits(s, -1, 0) | mask_bits(s, 0, 1) | mask_bits(s, 0, -1);
+}
 
-    s_rank = RANK(s);
-    s_column = COLUMN(s);
+static constexpr t_bitboard bishop_mask_bits(int s)
+{
+    return mask_bits(s, 1, 1) | mask_bits(s, 1, -1) | mask_bits(s, -1, 1) | mask_bits(s, -1, -1);
+}
 
-    // North East
-    for (c = s_column + 1, r = s_rank + 1; c < 7 && r < 7; c++, r++) {
-        b |= SQUARE64(r * 8 + c);
-    }
-    // North West
-    for (c = s_column - 1, r = s_rank + 1; c > 0 && r < 7; c--, r++) {
-        b |= SQUARE64(r * 8 + c);
-    }
-    // South East
-    for (c = s_column + 1, r = s_rank - 1; c < 7 && r > 0; c++, r--) {
-        b |= SQUARE64(r * 8 + c);
-    }
-    // South West
-    for (c = s_column - 1, r = s_rank - 1; c > 0 && r > 0; c--, r--) {
-        b |= SQUARE64(r * 8 + c);
-    }
+//-- Rook entries come first, then bishops
+static constexpr int rook_offset(int s)
+{
+    int offset = 0;
+    for (int i = 0; i < s; i++)
+        offset += 1 << bit_count(rook_mask_bits(i));
+    return offset;
+}
 
-    return b;
+static constexpr int rook_table_size = rook_offset(64);
+
+static constexpr int bishop_offset(int s)
+{
+    int offset = rook_table_size;
+    for (int i = 0; i < s; i++)
+        offset += 1 << bit_count(bishop_mask_bits(i));
+    return offset;
 }
 
-t_bitboard create_rook_attacks(t_chess_square s, t_bitboard mask)
+#define ROOK_MAGIC(a, s)					{ rook_mask_bits(s), rook_magics[s], rook_offset(s), 64 - bit_count(rook_mask_bits(s)) },
+#define BISHOP_MAGIC(a, s)					{ bishop_mask_bits(s), bishop_magics[s], bishop_offset(s), 64 - bit_count(bishop_mask_bits(s)) },
+
+constexpr struct t_magic_structure rook_magic[64] = { SQUARES(ROOK_MAGIC, 0) };
+constexpr struct t_magic_structure bishop_magic[64] = { SQUARES(BISHOP_MAGIC, 0) };
+
+static_assert(bishop_offset(64) == SLIDER_TABLE_SIZE, "slider table size");
+
+//-- Every occupancy of the mask, in ascending order (which is also PEXT order)
+static void init_slider_square(const struct t_magic_structure *m, t_chess_square square, t_chess_piece piece)
 {
-    int s_rank, s_column, r, c;
-    t_bitboard b = 0;
+    t_bitboard occupancy = 0;
+    t_bitboard attacks;
+    int i = 0, index;
 
-    s_rank = RANK(s);
-    s_column = COLUMN(s);
+    do {
+        attacks = (piece == ROOK ? rook_bits(square, occupancy) : bishop_bits(square, occupancy));
+        index = (use_pext ? i : (int)((occupancy * m->magic) >> m->shift));
 
-    // East
-    for (c = s_column + 1, r = s_rank; c <= 7; c++) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // West
-    for (c = s_column - 1, r = s_rank; c >= 0; c--) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // North
-    for (c = s_column, r = s_rank + 1; r <= 7; r++) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // South
-    for (c = s_column, r = s_rank - 1; r >= 0; r--) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
+        //-- Magic collisions must be constructive
+        assert(slider_attacks[m->offset + index] == 0 || slider_attacks[m->offset + index] == attacks);
+        slider_attacks[m->offset + index] = attacks;
 
-    return b;
+        occupancy = (occupancy - m->mask) & m->mask;
+        i++;
+    } while (occupancy);
 }
 
-t_bitboard create_bishop_attacks(t_chess_square s, t_bitboard mask)
+void init_magic()
 {
-    int s_rank, s_column, r, c;
-    t_bitboard b = 0;
+    t_chess_square square;
 
-    s_rank = RANK(s);
-    s_column = COLUMN(s);
+    use_pext = cpu.fast_pext;
 
-    // North East
-    for (c = s_column + 1, r = s_rank + 1; c <= 7 && r <= 7; c++, r++) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // North West
-    for (c = s_column - 1, r = s_rank + 1; c >= 0 && r <= 7; c--, r++) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // South East
-    for (c = s_column + 1, r = s_rank - 1; c <= 7 && r >= 0; c++, r--) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
-    }
-    // South West
-    for (c = s_column - 1, r = s_rank - 1; c >= 0 && r >= 0; c--, r--) {
-        b |= SQUARE64(r * 8 + c);
-        if (mask & SQUARE64(r * 8 + c))
-            break;
+    memset(slider_attacks, 0, sizeof(slider_attacks));
+    for (square = A1; square <= H8; square++) {
+        init_slider_square(&rook_magic[square], square, ROOK);
+        init_slider_square(&bishop_magic[square], square, BISHOP);
     }
-
-    return b;
 }
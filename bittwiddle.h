@@ -5,61 +5,61 @@
 //
 //===========================================================//
 
-#if defined(MINGW64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-static inline t_chess_square bitscan(t_bitboard b) {
-    t_bitboard index;
-__asm__("bsfq %1, %0": "=r"(index): "rm"(b) );
-    return (t_chess_square)index;
-}
+//-- Vector kernels: x86-64 always has SSE2; AVX2 functions are compiled for it and only called once detect_cpu() finds it
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS
+#define AVX2_TARGET
+#elif defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+//-- Prefetch
+#if defined(__GNUC__)
 
 static inline void prefetch(struct t_move_record *move) {
     __builtin_prefetch(move, 0, 3);
 }
 
-#if defined (POPCOUNT)
+#elif defined(_MSC_VER)
 
-static inline int popcount(t_bitboard b)
-{
-    return __builtin_popcountll(b);
+static inline void prefetch(struct t_move_record *move) {
+    _mm_prefetch((const char *)move, _MM_HINT_T0);
 }
 
 #else
 
-static inline int popcount(t_bitboard b)
-{
-    int i = 0;
-    t_bitboard a = b;
-    while (a) {
-        i++;
-        a &= (a - 1);
-    }
-    return(i);
+static inline void prefetch(struct t_move_record *move) {
+
 }
 
 #endif
 
-static inline t_chess_square bitscan_reset(t_bitboard *b)
+//-- Bitscan: bsf is part of every x86-64 so there's nothing to dispatch (the compiler picks bsf or tzcnt)
+#if defined(_MSC_VER) && defined(_WIN64)
+
+static inline t_chess_square bitscan(t_bitboard b)
 {
-    //t_bitboard c = *b ^ (*b - 1);
-    //*b &= (*b - 1);
-    //unsigned int folded = (int) (c ^ (c >> 32));
-    //return bitscan_table[folded * 0x78291ACF >> 26];
-    //t_chess_square s = bitscan(*b);
-    //*b ^= SQUARE64(s);
-    //return s;
-    t_bitboard index;
-__asm__("bsfq %1, %0": "=r"(index): "rm"(*b) );
-    *b &= (*b - 1);
+    unsigned long index;
+    _BitScanForward64(&index, b);
     return (t_chess_square)index;
 }
 
-#else
-
-inline void prefetch(struct t_move_record *move) {
+#elif defined(__GNUC__)
 
+static inline t_chess_square bitscan(t_bitboard b)
+{
+    return (t_chess_square)__builtin_ctzll(b);
 }
 
+#else
+
 static inline t_chess_square bitscan(t_bitboard b)
 {
     b ^= (b - 1);
@@ -67,7 +67,17 @@ static inline t_chess_square bitscan(t_bitboard b)
     return bitscan_table[folded * 0x78291ACF >> 26];
 }
 
-static inline int popcount(t_bitboard b)
+#endif
+
+static inline t_chess_square bitscan_reset(t_bitboard *b)
+{
+    t_chess_square s = bitscan(*b);
+    *b &= (*b - 1);
+    return s;
+}
+
+//-- Popcount: hardware popcnt when built for it, otherwise chosen at startup by detect_cpu()
+static inline int software_popcount(t_bitboard b)
 {
     int i = 0;
     t_bitboard a = b;
@@ -78,12 +88,46 @@ static inline int popcount(t_bitboard b)
     return(i);
 }
 
-static inline t_chess_square bitscan_reset(t_bitboard *b)
+#if defined(POPCOUNT) && defined(_MSC_VER)
+
+static inline int popcount(t_bitboard b)
 {
-    t_bitboard c = *b ^ (*b - 1);
-    *b &= (*b - 1);
-    unsigned int folded = (int) (c ^ (c >> 32));
-    return bitscan_table[folded * 0x78291ACF >> 26];
+    return (int)__popcnt64(b);
+}
+
+#elif defined(POPCOUNT) && defined(__GNUC__)
+
+static inline int popcount(t_bitboard b)
+{
+    return __builtin_popcountll(b);
+}
+
+#elif defined(_MSC_VER) && defined(_WIN64)
+
+static inline int popcount(t_bitboard b)
+{
+    if (use_popcnt)
+        return (int)__popcnt64(b);
+    return software_popcount(b);
+}
+
+#elif defined(__GNUC__) && defined(__x86_64__)
+
+static inline int popcount(t_bitboard b)
+{
+    if (use_popcnt) {
+        t_bitboard count;
+__asm__("popcntq %1, %0": "=r"(count): "rm"(b) );
+        return (int)count;
+    }
+    return software_popcount(b);
+}
+
+#else
+
+static inline int popcount(t_bitboard b)
+{
+    return software_popcount(b);
 }
 
 #endif
@@ -91,3 +135,108 @@ static inline t_chess_square bitscan_reset(t_bitboard *b)
 static inline BOOL is_bit_set(t_bitboard b, int i) {
     return ((SQUARE64(i) & b) != 0);
 }
+
+//-- Parallel bit extract (BMI2).  Only called when use_pext is set, the C version keeps other builds linking
+#if defined(_MSC_VER) && defined(_WIN64)
+
+#include <immintrin.h>
+
+static inline t_bitboard pext(t_bitboard b, t_bitboard mask) {
+    return _pext_u64(b, mask);
+}
+
+#elif defined(__GNUC__) && defined(__x86_64__)
+
+static inline t_bitboard pext(t_bitboard b, t_bitboard mask) {
+    t_bitboard r;
+__asm__("pextq %2, %1, %0": "=r"(r): "r"(b), "rm"(mask) );
+    return r;
+}
+
+#else
+
+static inline t_bitboard pext(t_bitboard b, t_bitboard mask) {
+    t_bitboard r = 0;
+    t_bitboard bit;
+    for (bit = 1; mask; bit += bit) {
+        if (b & mask & -mask)
+            r |= bit;
+        mask &= mask - 1;
+    }
+    return r;
+}
+
+#endif
+
+//-- First move record for a piece moving between two squares; captures and promotions follow it in xmove_list
+static inline struct t_move_record *directory_move(t_chess_square from, t_chess_square to, t_chess_piece piece) {
+    return &xmove_list[move_directory[from][to][piece]];
+}
+
+//-- The squares a pinned piece on "s" can move to, i.e. the line from the king through the piece
+static inline t_bitboard pin_ray(t_chess_square king_square, t_chess_square s) {
+    return between[king_square][s] | SQUARE64(s) | xray[king_square][s];
+}
+
+//-- Sliding piece attacks: PEXT on fast BMI2 CPUs, variable shift "fancy" magics otherwise
+static inline t_bitboard rook_attacks(t_chess_square s, t_bitboard occupied) {
+    const struct t_magic_structure *m = &rook_magic[s];
+    if (use_pext)
+        return slider_attacks[m->offset + pext(occupied, m->mask)];
+    return slider_attacks[m->offset + (((m->mask & occupied) * m->magic) >> m->shift)];
+}
+
+static inline t_bitboard bishop_attacks(t_chess_square s, t_bitboard occupied) {
+    const struct t_magic_structure *m = &bishop_magic[s];
+    if (use_pext)
+        return slider_attacks[m->offset + pext(occupied, m->mask)];
+    return slider_attacks[m->offset + (((m->mask & occupied) * m->magic) >> m->shift)];
+}
+
+//-- Every piece (both colors) attacking a square, for a given occupancy
+static inline t_bitboard attackers_to(struct t_board *board, t_chess_square s, t_bitboard occupied) {
+    return (pawn_attackers[WHITE][s] & board->pieces[WHITE][PAWN])
+           | (pawn_attackers[BLACK][s] & board->pieces[BLACK][PAWN])
+           | (knight_mask[s] & (board->pieces[WHITE][KNIGHT] | board->pieces[BLACK][KNIGHT]))
+           | (king_mask[s] & (board->pieces[WHITE][KING] | board->pieces[BLACK][KING]))
+           | (bishop_attacks(s, occupied) & (board->pieces[WHITE][BISHOP] | board->pieces[BLACK][BISHOP] | board->pieces[WHITE][QUEEN] | board->pieces[BLACK][QUEEN]))
+           | (rook_attacks(s, occupied) & (board->pieces[WHITE][ROOK] | board->pieces[BLACK][ROOK] | board->pieces[WHITE][QUEEN] | board->pieces[BLACK][QUEEN]));
+}
+
+//-- Check info for the current position, recalculated only when the ply's slot holds another position
+static inline struct t_check_info *get_check_info(struct t_board *board) {
+    struct t_check_info *info = &check_info[draw_stack_count];
+    if (info->hash != board->hash)
+        calc_check_info(board, info);
+    return info;
+}
+
+//-- How the search makes and takes back moves.  Built with COPY_MAKE the move is made on the copy
+//-- in the undo record, which search_board returns, and nothing is undone; otherwise make / unmake.
+static inline void search_make_move(struct t_board *board, struct t_move_record *move, struct t_undo *undo) {
+#ifdef COPY_MAKE
+    copy_make_move(board, move, undo->board, undo);
+#else
+    make_move(board, move, undo);
+#endif
+}
+
+static inline void search_unmake_move(struct t_board *board, struct t_undo *undo) {
+#ifdef COPY_MAKE
+    (void)board;
+    (void)undo;
+    draw_stack_count--;
+#else
+    unmake_move(board, undo);
+#endif
+}
+
+static inline struct t_board *search_board(struct t_board *board, struct t_undo *undo) {
+#ifdef COPY_MAKE
+    (void)board;
+    return undo->board;
+#else
+    (void)undo;
+    return board;
+#endif
+}
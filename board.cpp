@@ -94,44 +94,63 @@ void update_in_check(struct t_board *board, t_chess_square from_square, t_chess_
     }
 }
 
+//-- Pieces (of either color) which are the only thing between a king and one of the sliders
+static inline t_bitboard slider_blockers(struct t_board *board, t_chess_square king_square, t_bitboard sliders, t_bitboard *pinners) {
+
+    t_bitboard blockers = 0;
+    t_bitboard b;
+
+    *pinners = 0;
+    sliders &= (bishop_rays[king_square] & (board->piecelist[WHITEBISHOP] | board->piecelist[BLACKBISHOP] | board->piecelist[WHITEQUEEN] | board->piecelist[BLACKQUEEN]))
+        | (rook_rays[king_square] & (board->piecelist[WHITEROOK] | board->piecelist[BLACKROOK] | board->piecelist[WHITEQUEEN] | board->piecelist[BLACKQUEEN]));
+    while (sliders) {
+        t_chess_square s = bitscan_reset(&sliders);
+        b = between[king_square][s] & board->all_pieces;
+        if (b && !(b & (b - 1))) {
+            blockers |= b;
+            *pinners |= SQUARE64(s);
+        }
+    }
+    return blockers;
+}
+
+void calc_check_info(struct t_board *board, struct t_check_info *info) {
+
+    t_chess_color to_move = board->to_move;
+    t_chess_color opponent = OPPONENT(to_move);
+    t_chess_square king_square = board->king_square[opponent];
+    t_bitboard blockers;
+
+    info->hash = board->hash;
+
+    //-- Our pieces pinned by their sliders
+    blockers = slider_blockers(board, board->king_square[to_move], board->occupied[opponent], &info->pinners[to_move]);
+    info->pinned[to_move] = blockers & board->occupied[to_move];
+
+    //-- Their pinned pieces, and our pieces standing in front of our own sliders
+    blockers = slider_blockers(board, king_square, board->occupied[to_move], &info->pinners[opponent]);
+    info->pinned[opponent] = blockers & board->occupied[opponent];
+    info->discovered = blockers & board->occupied[to_move];
+
+    //-- Squares from which each piece type gives check
+    info->check_squares[BLANK] = 0;
+    info->check_squares[KNIGHT] = knight_mask[king_square];
+    info->check_squares[BISHOP] = bishop_attacks(king_square, board->all_pieces);
+    info->check_squares[ROOK] = rook_attacks(king_square, board->all_pieces);
+    info->check_squares[QUEEN] = info->check_squares[BISHOP] | info->check_squares[ROOK];
+    info->check_squares[PAWN] = pawn_attackers[to_move][king_square];
+    info->check_squares[KING] = 0;
+    info->check_squares[7] = 0;
+}
+
 BOOL is_pinned(struct t_board *board, t_chess_square square, t_chess_square pinned_to) {
 
     t_bitboard b = xray[pinned_to][square];
 
+    //-- Only a slider can sit on the x-ray beyond square, so any attacker found there is pinning it
     if (b) {
-        t_chess_color to_move = COLOR(board->square[square]);
-        t_chess_color opponent = OPPONENT(to_move);
-        t_bitboard attacker;
-        t_chess_square s;
-
-        board->all_pieces ^= SQUARE64(square);
-        //-- Bishop
-        attacker = (b & bishop_rays[pinned_to]);
-        if (attacker) {
-            attacker &= (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-            while (attacker) {
-                s = bitscan(attacker);
-                if ((between[pinned_to][s] & board->all_pieces) == 0) {
-                    board->all_pieces ^= SQUARE64(square);
-                    return TRUE;
-                }
-                attacker &= (attacker - 1);
-            }
-        }
-        //-- Rooks
-        attacker = (b & rook_rays[pinned_to]);
-        if (attacker) {
-            attacker &= (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-            while (attacker) {
-                s = bitscan(attacker);
-                if ((between[pinned_to][s] & board->all_pieces) == 0) {
-                    board->all_pieces ^= SQUARE64(square);
-                    return TRUE;
-                }
-                attacker &= (attacker - 1);
-            }
-        }
-        board->all_pieces ^= SQUARE64(square);
+        t_chess_color opponent = OPPONENT(COLOR(board->square[square]));
+        return (attackers_to(board, pinned_to, board->all_pieces ^ SQUARE64(square)) & b & board->occupied[opponent]) != 0;
     }
     return FALSE;
 }
@@ -141,103 +160,20 @@ BOOL is_in_check(struct t_board *board, t_chess_color color) {
 }
 
 BOOL is_square_attacked(struct t_board *board, t_chess_square square, t_chess_color color) {
-
-    // Pawns
-    if (pawn_attackers[color][square] & board->pieces[color][PAWN])
-        return TRUE;
-    // Knight
-    if (knight_mask[square] & board->pieces[color][KNIGHT])
-        return TRUE;
-    // King
-    if (king_mask[square] & board->pieces[color][KING])
-        return TRUE;
-
-    t_bitboard b;
-    t_chess_square s;
-    // Bishop & Queen Diagonals
-    b = bishop_rays[square] & (board->pieces[color][BISHOP] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            return TRUE;
-        b &= (b - 1);
-    }
-    // Rooks & Queen Horizonatal & Vertical
-    b = rook_rays[square] & (board->pieces[color][ROOK] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            return TRUE;
-        b &= (b - 1);
-    }
-    // No Attacks!
-    return FALSE;
+    return (attackers_to(board, square, board->all_pieces) & board->occupied[color]) != 0;
 }
 
 int attack_count(struct t_board *board, t_chess_square square, t_chess_color color) {
-    int count;
-    t_bitboard b;
-    t_chess_square s;
-
-    // Pawns
-    count = popcount(pawn_attackers[color][square] & board->pieces[color][PAWN]);
-    // Knight
-    count += popcount(knight_mask[square] & board->pieces[color][KNIGHT]);
-    // King
-    count += popcount(king_mask[square] & board->pieces[color][KING]);
-    // Bishop & Queen Diagonals
-    b = bishop_rays[square] & (board->pieces[color][BISHOP] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            count++;
-        b &= (b - 1);
-    }
-    // Rooks & Queen Horizonatal & Vertical
-    b = rook_rays[square] & (board->pieces[color][ROOK] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            count++;
-        b &= (b - 1);
-    }
-    // No Attacks!
-    return count;
+    return popcount(attackers_to(board, square, board->all_pieces) & board->occupied[color]);
 }
 
 t_chess_square who_is_attacking_square(struct t_board *board, t_chess_square square, t_chess_color color) {
 
-    t_bitboard b;
-    // Pawns
-    b = pawn_attackers[color][square] & board->pieces[color][PAWN];
-    if (b)
-        return bitscan(b);
-    // Knight
-    b = knight_mask[square] & board->pieces[color][KNIGHT];
-    if (b)
-        return bitscan(b);
-    // King
-    b = king_mask[square] & board->pieces[color][KING];
+    t_bitboard b = attackers_to(board, square, board->all_pieces) & board->occupied[color];
+
     if (b)
         return bitscan(b);
 
-    t_chess_square s;
-    // Bishop & Queen Diagonals
-    b = bishop_rays[square] & (board->pieces[color][BISHOP] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            return s;
-        b &= (b - 1);
-    }
-    // Rooks & Queen Horizonatal & Vertical
-    b = rook_rays[square] & (board->pieces[color][ROOK] | board->pieces[color][QUEEN]);
-    while (b) {
-        s = bitscan(b);
-        if ((between[square][s] & board->all_pieces) == 0)
-            return s;
-        b &= (b - 1);
-    }
     // No Attacks!
     return -1;
 }
@@ -245,19 +181,36 @@ t_chess_square who_is_attacking_square(struct t_board *board, t_chess_square squ
 // Initialize the board variable
 void init_board(struct t_board *board)
 {
-    int i;
-
     board->pieces[WHITE] = board->piecelist;
     board->pieces[BLACK] = board->piecelist + 8;
+}
+
+//-- A board is plain position state apart from the "pieces" pointers into its own piecelist
+void copy_board(struct t_board *to, struct t_board *from)
+{
+    memcpy(to, from, sizeof(struct t_board));
+    to->pieces[WHITE] = to->piecelist;
+    to->pieces[BLACK] = to->piecelist + 8;
+}
 
-    for (i = 0; i <= MAXPLY; i++) {
-        board->pv_data[i].best_line_length = 0;
-        board->pv_data[i].killer1 = NULL;
-        board->pv_data[i].killer2 = NULL;
-        board->pv_data[i].check_killer1 = NULL;
-        board->pv_data[i].check_killer2 = NULL;
-        init_eval(board->pv_data[i].eval);
+void init_search_stack(struct t_search_stack *stack)
+{
+    int i;
+    struct t_move_record **row = stack->pv_triangle;
+
+    for (i = 0; i <= MAXPLY + 1; i++) {
+        stack->ply[i].best_line_length = 0;
+        stack->ply[i].killer1 = NULL;
+        stack->ply[i].killer2 = NULL;
+        stack->ply[i].check_killer1 = NULL;
+        stack->ply[i].check_killer2 = NULL;
+        init_eval(stack->ply[i].eval);
+
+        //-- Rows shrink by one each ply; "row - i" lets the line keep its absolute ply indexes
+        stack->ply[i].best_line = row - i;
+        row += MAXPLY + 1 - i;
     }
+    assert(row == stack->pv_triangle + PV_TRIANGLE_SIZE);
 }
 
 // Add a piece to the board!
@@ -277,17 +230,20 @@ void add_piece(struct t_board *board, t_chess_piece piece, t_chess_square target
 
     board->hash ^= hash_value[piece][target_square];
 
+    board->material_pst += pst_value(piece, target_square);
+    board->game_phase += game_phase_weight[PIECETYPE(piece)];
+
     switch (PIECETYPE(piece)) {
     case PAWN:
         board->pawn_hash ^= hash_value[piece][target_square];
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece])];
+		board->material_index += material_index_value[piece][popcount(board->piecelist[piece])];
         break;
     case KING:
         board->king_square[color] = target_square;
 		board->pawn_hash ^= hash_value[piece][target_square];
         break;
     default:
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece])];
+		board->material_index += material_index_value[piece][popcount(board->piecelist[piece])];
     }
 }
 
@@ -305,17 +261,20 @@ void remove_piece(struct t_board *board, t_chess_square target_square)
     board->square[target_square] = BLANK;
     board->hash ^= hash_value[piece][target_square];
 
+    board->material_pst -= pst_value(piece, target_square);
+    board->game_phase -= game_phase_weight[PIECETYPE(piece)];
+
     switch (PIECETYPE(piece)) {
     case PAWN:
         board->pawn_hash ^= hash_value[piece][target_square];
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece]) + 1];
+		board->material_index -= material_index_value[piece][popcount(board->piecelist[piece]) + 1];
 		break;
     case KING:
         board->king_square[color] = -1;
 		board->hash ^= hash_value[piece][target_square];
 		break;
     default:
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece]) + 1];
+		board->material_index -= material_index_value[piece][popcount(board->piecelist[piece]) + 1];
     }
 
 }
@@ -342,6 +301,8 @@ void clear_board(struct t_board *board)
     board->fifty_move_count = 0;
     board->hash = 0;
     board->pawn_hash = 0;
+    board->material_pst = 0;
+    board->game_phase = 0;
     board->to_move = WHITE;
 }
 
@@ -489,9 +450,15 @@ BOOL integrity(struct t_board *board) {
         return FALSE;
     if (board->hash != calc_board_hash(board))
         return FALSE;
-	if (board->material_hash != calc_material_hash(board))
+	if (board->material_index != calc_material_index(board))
 		return FALSE;
 
+    //-- Incremental evaluation terms
+    if (board->material_pst != calc_board_pst(board))
+        return FALSE;
+    if (board->game_phase != calc_board_phase(board))
+        return FALSE;
+
     //-- In check and shouldn't be!
     if (attack_count(board, board->king_square[OPPONENT(board->to_move)], board->to_move) != 0)
         return FALSE;
@@ -566,7 +533,10 @@ void flip_board(struct t_board *board) {
 
     board->hash = calc_board_hash(board);
     board->pawn_hash = calc_pawn_hash(board);
-	board->material_hash = calc_material_hash(board);
+	board->material_index = calc_material_index(board);
+    board->material_pst = calc_board_pst(board);
+    if (use_nnue)
+        nnue_refresh_all(board);
 
     assert(integrity(board));
 }
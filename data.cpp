@@ -27,12 +27,13 @@ char engine_name[30];
 // Chess Board
 // ----------------------------------------------------------//
 struct t_board position[1];
+struct t_search_stack search_stack[1];						// per-ply search data (killers, evaluations, PV) for the position's search
 
 // ----------------------------------------------------------//
 // Global Move List Variables
 // ----------------------------------------------------------//
 struct t_move_record xmove_list[GLOBAL_MOVE_COUNT];
-struct t_move_record *move_directory[64][64][15];
+t_move_index move_directory[64][64][15];					// first record of each from, to and piece (see directory_move)
 
 // ----------------------------------------------------------//
 // Principle Variation Stack
@@ -94,44 +95,28 @@ const char direction[15][10] = {
     {-17, -16, -15, -1, 1, 15, 16, 17, 0}					// Black King
 };
 const char piece_count_value[15] = {0, 2, 3, 5, 9, 0, 0, 0, 0, 2, 3, 5, 9, 0, 0};
+const int game_phase_weight[8] = {0, 6, 12, 16, 44, 2, 0, 0};
 
 // ----------------------------------------------------------//
 // Static Exchange Evaluation
 // ----------------------------------------------------------//
 const int see_piece_value[15] = {0, 350, 350, 500, 900, 100, 10000, 0, 0, 350, 350, 500, 900, 100, 10000};
 
-// ----------------------------------------------------------//
-// Castling Data
-// ----------------------------------------------------------//
-struct t_castle_record castle[4];
-
 // ----------------------------------------------------------//
 // Repitition Variables
 // ----------------------------------------------------------//
 t_hash draw_stack[MAX_MOVES];
 int draw_stack_count;
 int search_start_draw_stack_count;
+int null_move_draw_stack_count;
+struct t_check_info check_info[MAX_MOVES];
+t_hash cuckoo[CUCKOO_SIZE];
+uchar cuckoo_from[CUCKOO_SIZE];
+uchar cuckoo_to[CUCKOO_SIZE];
 
 // ----------------------------------------------------------//
-// Bitboards
-// ----------------------------------------------------------//
-t_bitboard between[64][64];									// squares between any two squares on the board (*not* including start and finish)
-t_bitboard line[64][64];									// squares between any two squares on the board (*including* start and finish)
-t_bitboard bishop_rays[64];									// bishop moves on an empty board from each square
-t_bitboard rook_rays[64];									// rook moves on an empty board from each square
-t_bitboard queen_rays[64];									// queen moves on an empty board from each square
-t_bitboard knight_mask[64];									// knight moves from each square
-t_bitboard king_mask[64];									// king moves from each square
-t_bitboard rank_mask[2][8];									// mask of each rank indexed by color
-t_bitboard pawn_attackers[2][64];							// for each square it shows the squares from which a pawn could attack
-t_bitboard xray[64][64];									// Going from then to, these are the squares the other side of the "to" square
-t_bitboard neighboring_file[8];								// Adjacent files set to "1"
-t_bitboard column_mask[8];									// Mask out columns
-t_bitboard square_rank_mask[64];							// Mask the squares on the same rank
-t_bitboard square_column_mask[64];							// Mask the squares on the same column
-t_bitboard forward_squares[2][64];							// Mask of squares in front of give square in direction of pawn
-t_bitboard connected_pawn_mask[64];							// Mask for connected pawn for a given square
-
+// Bitboards (the geometry tables and castle records are compile-time constants in bitboards.cpp)
+// ----------------------------------------------------------//
 const t_chess_square bitscan_table[64] = {
     63, 30,  3, 32, 59, 14, 11, 33, 60, 24, 50,  9, 55, 19, 21, 34,
     61, 29,  2, 53, 51, 23, 41, 18, 56, 28,  1, 43, 46, 27,  0, 35,
@@ -149,7 +134,9 @@ t_piece_mask can_move[64][64];
 // ----------------------------------------------------------//
 t_chess_value piece_value[2][8];
 
-t_chess_value piece_square_table[16][2][64];
+struct t_eval_terms eval_terms;
+
+t_score piece_square_table[16][64];
 
 const t_chess_value pawn_pst[2][64] = {
     {0, 0, 0, 0, 0, 0, 0, 0,
@@ -315,23 +302,26 @@ const t_chess_color square_color[64]{
 		WHITE, BLACK, WHITE, BLACK, WHITE, BLACK, WHITE, BLACK
 };
 
-const t_chess_value passed_pawn_bonus[2][64]{
+//-- Tables below are packed middlegame / endgame scores
+#define S(mg, eg) MAKE_SCORE(mg, eg)
+
+const t_score passed_pawn_bonus[2][64]{
 		{0, 0, 0, 0, 0, 0, 0, 0,
-		15, 14, 12, 10, 10, 12, 14, 15,
-		30, 28, 26, 25, 25, 26, 28, 30,
-		50, 45, 40, 35, 35, 40, 45, 50,
-		75, 70, 65, 60, 60, 65, 70, 75,
-		105, 97, 90, 80, 80, 90, 97, 105,
-		145, 130, 115, 100, 100, 115, 130, 145,
+		S(15, 15), S(14, 14), S(12, 12), S(10, 10), S(10, 10), S(12, 12), S(14, 14), S(15, 15),
+		S(30, 30), S(28, 28), S(26, 26), S(25, 25), S(25, 25), S(26, 26), S(28, 28), S(30, 30),
+		S(50, 50), S(45, 45), S(40, 40), S(35, 35), S(35, 35), S(40, 40), S(45, 45), S(50, 50),
+		S(75, 75), S(70, 70), S(65, 65), S(60, 60), S(60, 60), S(65, 65), S(70, 70), S(75, 75),
+		S(105, 105), S(97, 97), S(90, 90), S(80, 80), S(80, 80), S(90, 90), S(97, 97), S(105, 105),
+		S(145, 145), S(130, 130), S(115, 115), S(100, 100), S(100, 100), S(115, 115), S(130, 130), S(145, 145),
 		0, 0, 0, 0, 0, 0, 0, 0},
 
 		{ 0, 0, 0, 0, 0, 0, 0, 0,
-		-145, -130, -115, -100, -100, -115, -130, -145,
-		-105, -97, -90, -80, -80, -90, -97, -105,
-		-75, -70, -65, -60, -60, -65, -70, -75,
-		-50, -45, -40, -35, -35, -40, -45, -50,
-		-30, -28, -26, -25, -25, -26, -28, -30,
-		-15, -14, -12, -10, -10, -12, -14, -15,
+		S(-145, -145), S(-130, -130), S(-115, -115), S(-100, -100), S(-100, -100), S(-115, -115), S(-130, -130), S(-145, -145),
+		S(-105, -105), S(-97, -97), S(-90, -90), S(-80, -80), S(-80, -80), S(-90, -90), S(-97, -97), S(-105, -105),
+		S(-75, -75), S(-70, -70), S(-65, -65), S(-60, -60), S(-60, -60), S(-65, -65), S(-70, -70), S(-75, -75),
+		S(-50, -50), S(-45, -45), S(-40, -40), S(-35, -35), S(-35, -35), S(-40, -40), S(-45, -45), S(-50, -50),
+		S(-30, -30), S(-28, -28), S(-26, -26), S(-25, -25), S(-25, -25), S(-26, -26), S(-28, -28), S(-30, -30),
+		S(-15, -15), S(-14, -14), S(-12, -12), S(-10, -10), S(-10, -10), S(-12, -12), S(-14, -14), S(-15, -15),
 		0, 0, 0, 0, 0, 0, 0, 0 }
 
 };
@@ -339,80 +329,59 @@ const t_chess_value passed_pawn_bonus[2][64]{
 // ----------------------------------------------------------//
 // Mobility
 // ----------------------------------------------------------//
-const t_chess_value horizontal_rook_mobility[2][8]{
-	{-10, -3, 0, 2,	4, 6, 8, 10},
-	{-20, -10, 0, 3, 6, 9, 12, 15}
+const t_score horizontal_rook_mobility[8]{
+	S(-10, -20), S(-3, -10), S(0, 0), S(2, 3), S(4, 6), S(6, 9), S(8, 12), S(10, 15)
 };
 
-const t_chess_value vertical_rook_mobility[2][8]{
-	{-10, 0, 6, 12, 18, 24, 30, 36},
-	{-30, -15, 0, 10, 20, 30, 35, 40}
+const t_score vertical_rook_mobility[8]{
+	S(-10, -30), S(0, -15), S(6, 0), S(12, 10), S(18, 20), S(24, 30), S(30, 35), S(36, 40)
 };
 
-const t_chess_value bishop_mobility[2][16]{
-	{-50, -40, -10, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26},
-	{-90, -50, -20, 0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48}
+const t_score bishop_mobility[16]{
+	S(-50, -90), S(-40, -50), S(-10, -20), S(2, 0), S(4, 4), S(6, 8), S(8, 12), S(10, 16),
+	S(12, 20), S(14, 24), S(16, 28), S(18, 32), S(20, 36), S(22, 40), S(24, 44), S(26, 48)
 };
 
-const t_chess_value double_pawn_penalty[2][8]{
-	{-45, 20, 0, 10, 10, 0, -20, -45},
-	{ -60, -25, -20, -20, -20, -20, -25, -60}
+const t_score double_pawn_penalty[8]{
+	S(-45, -60), S(20, -25), S(0, -20), S(10, -20), S(10, -20), S(0, -20), S(-20, -25), S(-45, -60)
 };
 
+#undef S
+
 // ----------------------------------------------------------//
 // Magics
 // ----------------------------------------------------------//
-t_bitboard rook_magic_moves[64][4096];
-const struct t_magic_structure rook_magic[64] = {
-    {0x000101010101017e, 0xe580008110204000},	{0x000202020202027c, 0x0160002008011000},	{0x000404040404047a, 0x3520080020000400},
-    {0x0008080808080876, 0x6408080448002002},	{0x001010101010106e, 0x1824080004020400},	{0x002020202020205e, 0x9e04088101020400},
-    {0x004040404040403e, 0x8508008001000200},	{0x008080808080807e, 0x5a000040a4840201},	{0x0001010101017e00, 0x0172800180504000},
-    {0x0002020202027c00, 0x0094200020483000},	{0x0004040404047a00, 0x0341400410000800},	{0x0008080808087600, 0x007e040020041200},
-    {0x0010101010106e00, 0x0042104404000800},	{0x0020202020205e00, 0x00cc042090008400},	{0x0040404040403e00, 0x00a88081000a0200},
-    {0x0080808080807e00, 0x006c810180840100},	{0x00010101017e0100, 0x0021150010208000},	{0x00020202027c0200, 0x0000158060004000},
-    {0x00040404047a0400, 0x0080bc2808402000},	{0x0008080808760800, 0x00113e1000200800},	{0x00101010106e1000, 0x0002510001010800},
-    {0x00202020205e2000, 0x0008660814001200},	{0x00404040403e4000, 0x0000760400408080},	{0x00808080807e8000, 0x0004158180800300},
-    {0x000101017e010100, 0x00c0826880004000},	{0x000202027c020200, 0x0000803901002800},	{0x000404047a040400, 0x0020005d88000400},
-    {0x0008080876080800, 0x0000136a18001000},	{0x001010106e101000, 0x0000053200100a00},	{0x002020205e202000, 0x0004301aa0010400},
-    {0x004040403e404000, 0x0001085c80048200},	{0x008080807e808000, 0x000000be04040100},	{0x0001017e01010100, 0x0001042142401000},
-    {0x0002027c02020200, 0x0140300036282000},	{0x0004047a04040400, 0x0009802008801000},	{0x0008087608080800, 0x0000201870841000},
-    {0x0010106e10101000, 0x0002020926000a00},	{0x0020205e20202000, 0x0004040078800200},	{0x0040403e40404000, 0x0002000250900100},
-    {0x0080807e80808000, 0x00008001b9800100},	{0x00017e0101010100, 0x0240001090418000},	{0x00027c0202020200, 0x0000100008334000},
-    {0x00047a0404040400, 0x0060086000234800},	{0x0008760808080800, 0x0088088011121000},	{0x00106e1010101000, 0x000204000e1d2800},
-    {0x00205e2020202000, 0x00020082002a0400},	{0x00403e4040404000, 0x0006021050270a00},	{0x00807e8080808000, 0x0000610002548080},
-    {0x007e010101010100, 0x0401410280201a00},	{0x007c020202020200, 0x0001408100104e00},	{0x007a040404040400, 0x0020100980084480},
-    {0x0076080808080800, 0x000a004808286e00},	{0x006e101010101000, 0x0000100120024600},	{0x005e202020202000, 0x0002000902008e00},
-    {0x003e404040404000, 0x0001010800807200},	{0x007e808080808000, 0x0002050400295a00},	{0x7e01010101010100, 0x004100a080004257},
-    {0x7c02020202020200, 0x000011008048c005},	{0x7a04040404040400, 0x8040441100086001},	{0x7608080808080800, 0x8014400c02002066},
-    {0x6e10101010101000, 0x00080220010a010e},	{0x5e20202020202000, 0x0002000810041162},	{0x3e40404040404000, 0x00010486100110e4},
-    {0x7e80808080808000, 0x000100020180406f}
+// Rooks and bishops share one attack table, filled by init_magic (rook_magic and bishop_magic are in bitboards.cpp)
+t_bitboard slider_attacks[SLIDER_TABLE_SIZE];
+BOOL use_pext = FALSE;
+
+// Filled by detect_cpu() at startup
+struct t_cpu_features cpu;
+BOOL use_popcnt = FALSE;
+BOOL use_avx2 = FALSE;
+int fill_kernel = FILL_KERNEL_SCALAR;
+BOOL use_fill_evasions = FALSE;
+
+// Set by "EvalFile"; the handcrafted evaluation is used whenever use_nnue is FALSE
+struct t_nnue_network nnue_network;
+BOOL use_nnue = FALSE;
+
+// Built by init_kpk() at startup
+unsigned int kpk_bitbase[KPK_SIZE / 32];
+
+// Every 3 and 4 man table, in an order where each table's captures and promotions lead to earlier ones
+const char *tablebase_names[TB_TABLE_COUNT] = {
+	"KQvK", "KRvK", "KBvK", "KNvK", "KPvK",
+	"KQQvK", "KQRvK", "KQBvK", "KQNvK", "KRRvK", "KRBvK", "KRNvK", "KBBvK", "KBNvK", "KNNvK",
+	"KQvKQ", "KQvKR", "KQvKB", "KQvKN", "KRvKR", "KRvKB", "KRvKN", "KBvKB", "KBvKN", "KNvKN",
+	"KQPvK", "KRPvK", "KBPvK", "KNPvK", "KQvKP", "KRvKP", "KBvKP", "KNvKP",
+	"KPPvK", "KPvKP"
 };
 
-t_bitboard bishop_magic_moves[64][512];
-const struct t_magic_structure bishop_magic[64] = {
-    {0x0040201008040200, 0x00a08800240c0040},	{0x0000402010080400, 0x0020085008088000},	{0x0000004020100a00, 0x0080440306000000},
-    {0x0000000040221400, 0x000c520480000000},	{0x0000000002442800, 0x0024856000000000},	{0x0000000204085000, 0x00091430a0000000},
-    {0x0000020408102000, 0x0009081820c00000},	{0x0002040810204000, 0x0005100400609000},	{0x0020100804020000, 0x0000004448220400},
-    {0x0040201008040000, 0x00001030010c0480},	{0x00004020100a0000, 0x00003228120a0000},	{0x0000004022140000, 0x00004c2082400000},
-    {0x0000000244280000, 0x0000108d50000000},	{0x0000020408500000, 0x0000128821100000},	{0x0002040810200000, 0x00000a0410245000},
-    {0x0004081020400000, 0x0000030180208800},	{0x0010080402000200, 0x0050000820500c00},	{0x0020100804000400, 0x0008010050180200},
-    {0x004020100a000a00, 0x0150008a00200500},	{0x0000402214001400, 0x000e000505090000},	{0x0000024428002800, 0x0014001239200000},
-    {0x0002040850005000, 0x0006000540186000},	{0x0004081020002000, 0x0001000603502000},	{0x0008102040004000, 0x0005000104480c00},
-    {0x0008040200020400, 0x0011400048880200},	{0x0010080400040800, 0x0008080020304800},	{0x0020100a000a1000, 0x00241800b4000c00},
-    {0x0040221400142200, 0x0020480010820040},	{0x0002442800284400, 0x011484002e822000},	{0x0004085000500800, 0x000c050044822000},
-    {0x0008102000201000, 0x0010090020401800},	{0x0010204000402000, 0x0004008004a10c00},	{0x0004020002040800, 0x0044214001005000},
-    {0x0008040004081000, 0x0008406000188200},	{0x00100a000a102000, 0x0002043000120400},	{0x0022140014224000, 0x0010280800120a00},
-    {0x0044280028440200, 0x0040120a00802080},	{0x0008500050080400, 0x0018282700021000},	{0x0010200020100800, 0x0008400c00090c00},
-    {0x0020400040201000, 0x0024200440050400},	{0x0002000204081000, 0x004420104000a000},	{0x0004000408102000, 0x0020085060000800},
-    {0x000a000a10204000, 0x00090428d0011800},	{0x0014001422400000, 0x00000a6248002c00},	{0x0028002844020000, 0x000140820a000400},
-    {0x0050005008040200, 0x0140900848400200},	{0x0020002010080400, 0x000890400c000200},	{0x0040004020100800, 0x0008240492000080},
-    {0x0000020408102000, 0x0010104980400000},	{0x0000040810204000, 0x0001480810300000},	{0x00000a1020400000, 0x0000060410a80000},
-    {0x0000142240000000, 0x0000000270150000},	{0x0000284402000000, 0x000000808c540000},	{0x0000500804020000, 0x00002010202c8000},
-    {0x0000201008040200, 0x0020a00810210000},	{0x0000402010080400, 0x0080801804828000},	{0x0002040810204000, 0x0002420010c09000},
-    {0x0004081020400000, 0x0000080828180400},	{0x000a102040000000, 0x0000000890285800},	{0x0014224000000000, 0x0000000008234900},
-    {0x0028440200000000, 0x00000000a0244500},	{0x0050080402000000, 0x0000022080900300},	{0x0020100804020000, 0x0000005002301100},
-    {0x0040201008040200, 0x0080881014040040}
-};
+// Loaded by "TablebasePath" (or built by "tbgen"); tablebase_pieces is the largest loaded, 0 if there are none
+struct t_tablebase tablebase[TB_TABLE_COUNT];
+int tablebase_count = 0;
+int tablebase_pieces = 0;
 
 // ----------------------------------------------------------//
 // Hash Table Data & Polyglot Random Numbers
@@ -420,9 +389,13 @@ const struct t_magic_structure bishop_magic[64] = {
 struct t_pawn_hash_record *pawn_hash;
 t_hash pawn_hash_mask;
 
-struct t_material_hash_record *material_hash;
-t_hash material_hash_mask;
-t_hash material_hash_values[16][10];
+struct t_eval_hash_record *eval_hash;
+t_hash eval_hash_mask;
+t_nodes eval_hash_probes;
+t_nodes eval_hash_hits;
+
+struct t_material_record *material_record;
+t_material_index material_index_value[16][MATERIAL_MAX_COUNT];
 
 struct t_hash_record *hash_table;
 t_hash hash_mask;
@@ -12,10 +12,11 @@ extern char engine_name[30];
 
 // Board Position
 extern struct t_board position[1];
+extern struct t_search_stack search_stack[1];
 
 // Global Move Directory
 extern struct t_move_record xmove_list[GLOBAL_MOVE_COUNT];
-extern struct t_move_record *move_directory[64][64][15];
+extern t_move_index move_directory[64][64][15];
 
 // Principle Variation Data
 extern struct t_perft_pv_data perft_pv_data[MAXPLY + 1];
@@ -51,35 +52,40 @@ extern const t_chess_value aspiration_window[2][6];
 extern const BOOL slider[15];
 extern const char direction[15][10];
 extern const char piece_count_value[15];
+extern const int game_phase_weight[8];
 
 // SEE Values
 extern const int see_piece_value[15];
 
 // Castling records
-extern struct t_castle_record castle[4];
+extern const struct t_castle_record castle[4];
 
 /* Repetition Variables */
 extern t_hash draw_stack[MAX_MOVES];
 extern int draw_stack_count;
 extern int search_start_draw_stack_count;
+extern int null_move_draw_stack_count;								// draw_stack entry made by the last null move, nothing before it can repeat
+extern struct t_check_info check_info[MAX_MOVES];					// indexed like draw_stack, so each ply keeps its own
+extern t_hash cuckoo[CUCKOO_SIZE];								// hash difference of each reversible move, side to move included
+extern uchar cuckoo_from[CUCKOO_SIZE];
+extern uchar cuckoo_to[CUCKOO_SIZE];
 
 // Bitboards
-extern t_bitboard between[64][64];									// squares between any two squares on the board (*not* including start and finish)
-extern t_bitboard line[64][64];										// squares between any two squares on the board (*including* start and finish)
-extern t_bitboard bishop_rays[64];									// bishop moves on an empty board from each square
-extern t_bitboard rook_rays[64];									// rook moves on an empty board from each square
-extern t_bitboard queen_rays[64];
-extern t_bitboard rank_mask[2][8];
-extern t_bitboard knight_mask[64];									// knight moves from each square
-extern t_bitboard king_mask[64];									// king moves from each square
-extern t_bitboard pawn_attackers[2][64];							// Squares of pawns of color which will attach a given square e.g. pawn_attackers[WHITE][E4] = D3 and F3
-extern t_bitboard xray[64][64];
-extern t_bitboard neighboring_file[8];
-extern t_bitboard column_mask[8];
-extern t_bitboard square_rank_mask[64];								// Mask the squares on the same rank
-extern t_bitboard square_column_mask[64];							// Mask the squares on the same column
-extern t_bitboard forward_squares[2][64];							// Mask of the squares infront of a give square, moving in the direction of a pawn
-extern t_bitboard connected_pawn_mask[64];							// Mask for connected pawn for a given square
+extern const t_bitboard between[64][64];									// squares between any two squares on the board (*not* including start and finish)
+extern const t_bitboard bishop_rays[64];									// bishop moves on an empty board from each square
+extern const t_bitboard rook_rays[64];									// rook moves on an empty board from each square
+extern const t_bitboard queen_rays[64];
+extern const t_bitboard rank_mask[2][8];
+extern const t_bitboard knight_mask[64];									// knight moves from each square
+extern const t_bitboard king_mask[64];									// king moves from each square
+extern const t_bitboard pawn_attackers[2][64];							// Squares of pawns of color which will attach a given square e.g. pawn_attackers[WHITE][E4] = D3 and F3
+extern const t_bitboard xray[64][64];
+extern const t_bitboard neighboring_file[8];
+extern const t_bitboard column_mask[8];
+extern const t_bitboard square_rank_mask[64];								// Mask the squares on the same rank
+extern const t_bitboard square_column_mask[64];							// Mask the squares on the same column
+extern const t_bitboard forward_squares[2][64];							// Mask of the squares infront of a give square, moving in the direction of a pawn
+extern const t_bitboard connected_pawn_mask[64];							// Mask for connected pawn for a given square
 
 extern const t_chess_square bitscan_table[64];
 
@@ -88,7 +94,8 @@ extern t_piece_mask can_move[64][64];
 
 // Piece Square Tables
 extern t_chess_value piece_value[2][8];
-extern t_chess_value piece_square_table[16][2][64];
+extern struct t_eval_terms eval_terms;
+extern t_score piece_square_table[16][64];
 
 extern const t_chess_value pawn_pst[2][64];
 extern const t_chess_value knight_pst[2][64];
@@ -101,26 +108,51 @@ extern const t_chess_value lone_king[64];
 extern const t_chess_value bishop_knight_corner[2][64];
 extern const t_chess_color square_color[64];
 
-extern const t_chess_value passed_pawn_bonus[2][64];
+extern const t_score passed_pawn_bonus[2][64];
 
 //-- Mobility
-extern const t_chess_value horizontal_rook_mobility[2][8];
-extern const t_chess_value vertical_rook_mobility[2][8];
+extern const t_score horizontal_rook_mobility[8];
+extern const t_score vertical_rook_mobility[8];
 
-extern const t_chess_value bishop_mobility[2][16];
+extern const t_score bishop_mobility[16];
 
-extern const t_chess_value double_pawn_penalty[2][8];
+extern const t_score double_pawn_penalty[8];
 
 // Magics
-extern t_bitboard rook_magic_moves[64][4096];
-extern t_bitboard bishop_magic_moves[64][512];
+extern t_bitboard slider_attacks[SLIDER_TABLE_SIZE];
 extern const struct t_magic_structure rook_magic[64];
 extern const struct t_magic_structure bishop_magic[64];
+extern BOOL use_pext;
+
+// CPU Features
+extern struct t_cpu_features cpu;
+extern BOOL use_popcnt;
+extern BOOL use_avx2;
+extern int fill_kernel;
+extern BOOL use_fill_evasions;
+
+// NNUE
+extern struct t_nnue_network nnue_network;
+extern BOOL use_nnue;
+
+// King + pawn vs. king bitbase (one bit per position, set if the pawn wins)
+extern unsigned int kpk_bitbase[KPK_SIZE / 32];
+
+// Endgame tablebases
+extern const char *tablebase_names[TB_TABLE_COUNT];
+extern struct t_tablebase tablebase[TB_TABLE_COUNT];
+extern int tablebase_count;
+extern int tablebase_pieces;
 
 // Hash Table
 extern struct t_pawn_hash_record *pawn_hash;
 extern t_hash pawn_hash_mask;
 
+extern struct t_eval_hash_record *eval_hash;
+extern t_hash eval_hash_mask;
+extern t_nodes eval_hash_probes;
+extern t_nodes eval_hash_hits;
+
 extern struct t_hash_record *hash_table;
 extern t_hash hash_mask;
 extern t_nodes hash_probes;
@@ -128,9 +160,8 @@ extern t_nodes hash_hits;
 extern t_nodes hash_full;
 extern int hash_age;
 
-extern struct t_material_hash_record *material_hash;
-extern t_hash material_hash_mask;
-extern t_hash material_hash_values[16][10];
+extern struct t_material_record *material_record;
+extern t_material_index material_index_value[16][MATERIAL_MAX_COUNT];
 
 extern t_hash hash_value[16][64];
 extern t_hash castle_hash[16];
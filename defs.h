@@ -26,6 +26,7 @@
 #endif
 #define ENGINE_AUTHOR						"Steve Maughan"
 #include <cassert>
+#include <cstddef>
 //===========================================================//
 // Primitive Logic
 //===========================================================///
@@ -40,6 +41,11 @@ typedef int BOOL;
 #define CHECKMATE							10000000
 #define MAXPLY								127
 #define MAX_MOVES							1024
+
+//-- Cuckoo table of reversible moves, for spotting a repetition one move ahead
+#define CUCKOO_SIZE							8192
+#define CUCKOO_H1(key)						((int)(key) & (CUCKOO_SIZE - 1))
+#define CUCKOO_H2(key)						((int)((key) >> 16) & (CUCKOO_SIZE - 1))
 #define MAX_CHECKMATE						(CHECKMATE - 2 * MAXPLY)
 
 #define WHITE								0
@@ -107,7 +113,7 @@ typedef enum movetypes {
     MOVE_KINGxPAWN
 } t_chess_move_type;
 
-#define GLOBAL_MOVE_COUNT					43764
+#define GLOBAL_MOVE_COUNT					43764		// fits a t_move_index
 
 //===========================================================//
 // Bitboards
@@ -120,8 +126,11 @@ typedef unsigned char						t_chess_square;
 typedef unsigned char						t_chess_color;
 typedef unsigned char						uchar;
 typedef long long unsigned int				t_magic;
-typedef unsigned int						t_piece_mask;
+typedef unsigned short						t_piece_mask;		// one bit per piece (0..14)
+typedef unsigned short						t_move_index;		// index into xmove_list
 typedef int									t_chess_value;
+typedef int									t_score;			// packed middlegame (low 16 bits) and endgame (high 16 bits) value
+typedef unsigned int						t_material_index;	// see material.cpp
 typedef long long int						t_history_value;
 typedef signed long							t_chess_time;
 
@@ -156,6 +165,11 @@ typedef enum enginestates {
 #define FLIPPIECECOLOR(x)					PIECEINDEX(OPPONENT(COLOR(x)), PIECETYPE(x))
 #define PIECEMASK(x)						((t_piece_mask)1 << (x))
 
+//-- Packed middlegame / endgame scores: both halves are added, subtracted and scaled by an int in one operation
+#define MAKE_SCORE(mg, eg)					((t_score)((unsigned int)(eg) << 16) + (t_score)(mg))
+#define MG_SCORE(s)							((t_chess_value)(short)(unsigned short)(unsigned int)(s))
+#define EG_SCORE(s)							((t_chess_value)(short)(unsigned short)(((unsigned int)(s) + 0x8000) >> 16))
+
 
 //===========================================================//
 // Global Move List Record Structure
@@ -172,6 +186,8 @@ struct t_move_record
     t_chess_piece							promote_to;
     t_hash									hash_delta;
     t_hash									pawn_hash_delta;
+    t_score									pst_delta;			// change in material + piece-square score
+    int										phase_delta;		// change in game phase (captures & promotions)
     uchar									castling_delta;
     int										index;
     t_chess_value							history;
@@ -185,21 +201,20 @@ struct t_move_list
 	struct t_move_record					*current_move;		// The move last played
 	struct t_move_record					*hash_move;			// The hash move
 	t_bitboard								pinned_pieces;		// A bitboard which stores the position of pinned pieces
+	struct t_chess_eval						*attack_eval;		// Set when ordering: the ply's evaluation, if its attack maps are for this position
     struct t_move_record					*move[256];			// The moves!
     signed long long						value[256];			// Notional values for all of the moves
 };
 
-struct t_undo
+//-- Sliding relationships to both kings, worked out once per position and shared by the
+//-- move generators, make_move and see
+struct t_check_info
 {
-    struct t_move_record					*move;
-    uchar									castling;
-    t_bitboard								ep_square;
-    t_chess_square							attacker;
-    uchar									fifty_move_count;
-    uchar									in_check;
-    t_hash									hash;
-    t_hash									pawn_hash;
-	t_hash									material_hash;
+	t_hash									hash;				// position it was calculated for
+	t_bitboard								check_squares[8];	// by piece type, squares where a piece of the side to move gives check
+	t_bitboard								discovered;			// pieces of the side to move which uncover a check when they leave the line
+	t_bitboard								pinned[2];			// pieces pinned against their own king
+	t_bitboard								pinners[2];			// sliders pinning the pieces in pinned[color]
 };
 
 struct t_castle_record
@@ -220,11 +235,54 @@ struct t_chess_eval
 {
 	struct t_pawn_hash_record				*pawn_evaluation;
 	int										game_phase;
-	t_chess_value							middlegame;
-	t_chess_value							endgame;
+	t_score									score;				// white minus black, tapered by calc_evaluation
 	t_chess_value							static_score;
+	BOOL									evaluated;			// static_score is valid for the position at this ply
 	t_bitboard								attacklist[15];
 	t_bitboard								*attacks[2];
+	t_hash									attack_hash;		// position the attack maps were built for (handcrafted evaluation only)
+	struct t_pawn_hash_record				*pawn_table;		// private pawn hash (tuning threads), NULL for the shared one
+	t_hash									pawn_table_mask;
+};
+
+//-- King + pawn vs. king bitbase: side to move x 24 pawn squares (files a-d, ranks 2-7) x 64 x 64 king squares
+#define KPK_SIZE							(2 * 24 * 64 * 64)
+
+//-- Material index: per side 9 pawn x 3 knight x 3 bishop x 3 rook x 2 queen counts
+#define MATERIAL_SIDE_SIZE					486
+#define MATERIAL_INDEX_SIZE					(MATERIAL_SIDE_SIZE * MATERIAL_SIDE_SIZE)
+#define MATERIAL_OVERFLOW					(1 << 20)	// added for each piece the index has no room for
+#define MATERIAL_MAX_COUNT					11			// counts 0-10: two of a piece and eight promoted pawns
+#define MATERIAL_SCALE_NORMAL				64
+
+//-- Endings the search settles without generating moves
+#define RECOGNIZE_NONE						0
+#define RECOGNIZE_DRAW						1		// dead draw, no mate is possible
+#define RECOGNIZE_KPK						2		// exact from the KPK bitbase
+#define RECOGNIZE_WON						3		// queen or rook against a bare king, bounded by the known ending score
+
+//-- Scalar terms the tuner may change (the defaults are in eval.h)
+struct t_eval_terms
+{
+	t_chess_value							mg_isolated_pawn;
+	t_chess_value							eg_isolated_pawn;
+	t_chess_value							mg_bishop_pair;
+	t_chess_value							eg_bishop_pair;
+	t_chess_value							mg_connected_knights;
+	t_chess_value							eg_connected_knights;
+	t_chess_value							rook_on_7th;		// applied to both halves
+	t_chess_value							mg_rook_on_open_file;
+	t_chess_value							mg_rook_on_semi_open_file;
+};
+
+//-- A labelled position held by the tuner (36 bytes)
+struct t_tune_position
+{
+	uchar									square[32];			// two squares per byte, piece index in each nibble
+	uchar									to_move;
+	uchar									castling;
+	uchar									ep;					// en-passant square, or 0 if there is none
+	uchar									result;				// 0 = black won, 1 = draw, 2 = white won
 };
 
 //===========================================================//
@@ -251,8 +309,7 @@ struct t_hash_record
 struct t_pawn_hash_record
 {
     t_hash									key;
-    t_chess_value							middlegame;
-    t_chess_value							endgame;
+    t_score									score;
     t_bitboard								forward_squares[2];
     t_bitboard								backward_squares[2];
     t_bitboard								attacks[2];
@@ -268,10 +325,23 @@ struct t_pawn_hash_record
 	int										pawn_count[2];
 };
 
-struct t_material_hash_record
+struct t_material_record
+{
+	void									(*eval_endgame)(struct t_board *board, struct t_chess_eval *eval);	// known ending, or NULL
+	t_score									imbalance;			// white minus black (bishop pairs)
+	uchar									scale[2];			// out of MATERIAL_SCALE_NORMAL, applied to the endgame score when that side is ahead
+	uchar									recognizer;			// RECOGNIZE_xxx
+};
+
+//-- "Eval Hash" in MB
+#define EVAL_HASH_DEFAULT					4
+#define EVAL_HASH_MIN						1
+#define EVAL_HASH_MAX						256
+
+struct t_eval_hash_record
 {
 	t_hash									key;
-	void									(*eval_endgame)(struct t_board *board, struct t_chess_eval *eval);
+	t_chess_value							static_score;
 };
 
 //===========================================================//
@@ -295,7 +365,94 @@ struct t_pv_data
     struct t_move_record					*check_killer2;
     int										legal_moves_played;
     int										best_line_length;
-    struct t_move_record					*best_line[MAXPLY + 1];
+    struct t_move_record					**best_line;		// this ply's row of the triangular PV, indexed by ply like the whole line
+};
+
+//-- Everything the search keeps per ply, so the board itself is just the position
+#define PV_TRIANGLE_SIZE					((MAXPLY + 1) * (MAXPLY + 2) / 2)
+
+struct t_search_stack
+{
+    struct t_pv_data						ply[MAXPLY + 2];
+    struct t_move_record					*pv_triangle[PV_TRIANGLE_SIZE];	// the row for ply n holds plies n to MAXPLY
+};
+
+//===========================================================//
+// NNUE Evaluation (the weights file format is described in nnue.cpp)
+//===========================================================//
+#define NNUE_FEATURES						40960	// HalfKP: 64 king squares x 10 pieces x 64 squares
+#define NNUE_HIDDEN							256		// accumulator width per perspective
+#define NNUE_L1								32
+#define NNUE_L2								32
+#define NNUE_WEIGHT_SHIFT					6		// hidden layer outputs are scaled down by 2^6 before clipping
+#define NNUE_OUTPUT_SCALE					16		// network output units per centipawn
+#define NNUE_MAX_SCORE						20000	// keeps network scores well clear of mate scores
+
+#define NNUE_MAGIC							"MAVNNUE1"
+#define NNUE_VERSION						1
+#define NNUE_HEADER_SIZE					16
+#define NNUE_FILE_SIZE						(NNUE_HEADER_SIZE + 2 * NNUE_HIDDEN + 2 * (size_t)NNUE_FEATURES * NNUE_HIDDEN + 4 * NNUE_L1 + NNUE_L1 * 2 * NNUE_HIDDEN + 4 * NNUE_L2 + NNUE_L2 * NNUE_L1 + 4 + NNUE_L2)
+
+struct t_nnue_accumulator
+{
+    short									v[2][NNUE_HIDDEN];	// first layer output from WHITE's and BLACK's point of view
+};
+
+struct t_nnue_network
+{
+    const short								*feature_bias;		// [NNUE_HIDDEN]
+    const short								*feature_weights;	// [NNUE_FEATURES][NNUE_HIDDEN]
+    const int								*l1_bias;			// [NNUE_L1]
+    const signed char						*l1_weights;		// [NNUE_L1][2 * NNUE_HIDDEN]
+    const int								*l2_bias;			// [NNUE_L2]
+    const signed char						*l2_weights;		// [NNUE_L2][NNUE_L1]
+    const int								*output_bias;		// [1]
+    const signed char						*output_weights;	// [NNUE_L2]
+    void									*view;				// mapped weights file (NULL if the weights are not ours to unmap)
+    size_t									size;
+};
+
+//===========================================================//
+// Endgame Tablebases (the file format is described in tablebase.cpp)
+//===========================================================//
+#define TB_MAX_PIECES						4		// kings included
+#define TB_TABLE_COUNT						35		// every 3 and 4 man table, see tablebase_names
+#define TB_NAME_LENGTH						8
+#define TB_WIN_SCORE						50000	// above any evaluation, well below mate scores
+#define TB_HEADER_SIZE						16
+#define TB_WDL_MAGIC						"MAVTBW1"
+#define TB_DTZ_MAGIC						"MAVTBZ1"
+
+//-- Win / draw / loss codes, from the side to move's point of view
+#define TB_DRAW								0
+#define TB_WIN								1
+#define TB_LOSS								2
+#define TB_ILLEGAL							3		// also used for indices which are not the canonical form of a position
+
+struct t_tb_position
+{
+    int										count;
+    t_chess_piece							piece[TB_MAX_PIECES];
+    t_chess_square							square[TB_MAX_PIECES];
+    t_chess_color							to_move;
+};
+
+struct t_tablebase
+{
+    char									name[TB_NAME_LENGTH];	// e.g. "KRvKN", white is always the stronger side
+    int										count;
+    t_chess_piece							piece[TB_MAX_PIECES];	// white king, black king, then the rest as named
+    BOOL									pawns;
+    t_hash									key;				// piece counts as named (see material_key)
+    t_hash									flipped_key;		// piece counts with the colours swapped
+    unsigned int							size;				// positions, both sides to move
+    const uchar								*wdl;				// 2 bits per position
+    const uchar								*dtz;				// plies to the next capture or pawn move (NULL if there is no DTZ file)
+    void									*wdl_view;			// mapped files, or malloc'd tables when generated in memory
+    void									*dtz_view;
+    size_t									wdl_size;
+    size_t									dtz_size;
+    BOOL									mapped;
 };
 
 //===========================================================//
@@ -310,7 +467,9 @@ struct t_board
     t_chess_color							to_move;
     t_hash									hash;
     t_hash									pawn_hash;
-	t_hash									material_hash;
+	t_material_index						material_index;
+    t_score									material_pst;		// white minus black material + piece-square score
+    int										game_phase;			// 256 at the start, falls as pieces come off
     BOOL									chess960;
     uchar									castling;
     t_bitboard								ep_square;
@@ -319,7 +478,29 @@ struct t_board
     t_chess_square							check_attacker;
     t_chess_square							square[64];
     uchar									fifty_move_count;
-    struct t_pv_data						pv_data[MAXPLY + 2];
+    struct t_nnue_accumulator				nnue;				// kept up to date by make_move / unmake_move while use_nnue is set
+};
+
+//-- Everything in a board ahead of the NNUE accumulator; all a copy needs when NNUE is off
+#define COMPACT_BOARD_SIZE					offsetof(struct t_board, nnue)
+
+//-- Built with COPY_MAKE the search makes each move on a copy of the position held in the
+//-- undo record, so nothing has to be taken back (see search_make_move in bittwiddle.h)
+struct t_undo
+{
+    struct t_move_record					*move;
+    uchar									castling;
+    t_bitboard								ep_square;
+    t_chess_square							attacker;
+    uchar									fifty_move_count;
+    uchar									in_check;
+    int										null_move_draw_stack_count;
+    t_hash									hash;
+    t_hash									pawn_hash;
+	t_material_index						material_index;
+#ifdef COPY_MAKE
+    struct t_board							board[1];			// the position after the move
+#endif
 };
 
 //===========================================================//
@@ -347,6 +528,7 @@ struct t_uci_options
 {
     int										hash_table_size;
     int										pawn_hash_table_size;
+    unsigned int							eval_hash_table_size;
     BOOL									current_line;
     BOOL									show_search_statistics;
 	BOOL									eval_test;
@@ -390,13 +572,50 @@ struct t_book_move {
     int										learn;
 };
 
+//===========================================================//
+// CPU Features (detected at startup)
+//===========================================================//
+struct t_cpu_features
+{
+    BOOL									popcnt;
+    BOOL									bmi1;
+    BOOL									bmi2;
+    BOOL									avx2;
+    BOOL									fast_pext;
+};
+
+//===========================================================//
+// Slider Batch (one lane per rook, bishop or queen of either color)
+//===========================================================//
+#define MAX_SLIDER_LANES					20		// ten rooks a side, rounded up to whole groups of four
+
+struct t_slider_batch
+{
+    int										count;
+    t_chess_square							square[MAX_SLIDER_LANES];
+    t_chess_color							color[MAX_SLIDER_LANES];
+    t_bitboard								occupied[MAX_SLIDER_LANES];		// blockers this slider sees
+    t_bitboard								not_occupied[MAX_SLIDER_LANES];	// squares that count towards mobility
+};
+
+//===========================================================//
+// Set-wise slider fills (fill.cpp)
+//===========================================================//
+#define FILL_KERNEL_SCALAR					0
+#define FILL_KERNEL_SSE2					1
+#define FILL_KERNEL_AVX2					2
+
 //===========================================================//
 // "Magics"
 //===========================================================//
+#define SLIDER_TABLE_SIZE					107648		// 102400 rook + 5248 bishop entries
+
 struct t_magic_structure
 {
     t_bitboard								mask;
     t_magic									magic;
+    int										offset;		// first entry in slider_attacks
+    int										shift;		// 64 - popcount(mask)
 };
 
 //===========================================================//
@@ -410,6 +629,7 @@ struct t_magic_structure
 #define MOVE_ORDER_KILLER3					(MAX_CHESS_INT >> 6)
 #define MOVE_ORDER_KILLER4					(MAX_CHESS_INT >> 7)
 #define MOVE_ORDER_ETC						(MAX_CHESS_INT >> 5)
+#define MOVE_ORDER_ESCAPE					(MAX_CHESS_INT >> 8)		// quiet move taking a threatened piece to safety
 
 //===========================================================//
 // Multi-PV
@@ -16,10 +16,18 @@ BOOL repetition_draw(struct t_board *board)
 {
     int i;
     int reps = 0;
+    int end;
 
     if (board->fifty_move_count >= 4) {
         if (board->fifty_move_count >= 100) return !is_checkmate(board);
+
+        //-- Positions before a null move are not part of the game
+        end = draw_stack_count - null_move_draw_stack_count;
+        if (end > board->fifty_move_count)
+            end = board->fifty_move_count;
         i = 4;
+        if (i > end)
+            return FALSE;
         do
         {
             if (draw_stack[draw_stack_count - i] == board->hash) {
@@ -30,11 +38,97 @@ BOOL repetition_draw(struct t_board *board)
                     return TRUE;
             }
             i += 2;
-        } while (board->fifty_move_count >= i);
+        } while (end >= i);
     }
     return FALSE;
 }
 
+//-- Every reversible move is stored by the hash difference it makes, so a position in the
+//-- draw stack that is one move away from the current one is found with two lookups
+void init_cuckoo()
+{
+	int count = 0;
+
+	for (int i = 0; i < CUCKOO_SIZE; i++) {
+		cuckoo[i] = 0;
+		cuckoo_from[i] = 0;
+		cuckoo_to[i] = 0;
+	}
+
+	for (t_chess_color color = WHITE; color <= BLACK; color++) {
+		for (t_chess_piece piece = KNIGHT; piece <= KING; piece++) {
+			if (piece == PAWN)
+				continue;
+
+			t_chess_piece p = PIECEINDEX(color, piece);
+			for (t_chess_square s1 = A1; s1 <= H8; s1++) {
+
+				t_bitboard moves;
+				switch (piece) {
+				case KNIGHT: moves = knight_mask[s1]; break;
+				case BISHOP: moves = bishop_rays[s1]; break;
+				case ROOK: moves = rook_rays[s1]; break;
+				case QUEEN: moves = queen_rays[s1]; break;
+				default: moves = king_mask[s1]; break;
+				}
+
+				for (t_chess_square s2 = s1 + 1; s2 <= H8; s2++) {
+					if (!(moves & SQUARE64(s2)))
+						continue;
+
+					//-- Cuckoo insertion, the displaced entry moves to its other slot
+					t_hash key = hash_value[p][s1] ^ hash_value[p][s2] ^ white_to_move_hash;
+					uchar from = s1;
+					uchar to = s2;
+					int i = CUCKOO_H1(key);
+					while (TRUE) {
+						t_hash k = cuckoo[i]; cuckoo[i] = key; key = k;
+						uchar f = cuckoo_from[i]; cuckoo_from[i] = from; from = f;
+						uchar t = cuckoo_to[i]; cuckoo_to[i] = to; to = t;
+						if (key == 0)
+							break;
+						i = (i == CUCKOO_H1(key)) ? CUCKOO_H2(key) : CUCKOO_H1(key);
+					}
+					count++;
+				}
+			}
+		}
+	}
+	assert(count == 3668);
+}
+
+//-- Can the side to move reach an earlier position with one reversible move?
+BOOL upcoming_repetition(struct t_board *board)
+{
+	int end = board->fifty_move_count;
+	if (end > draw_stack_count - null_move_draw_stack_count)
+		end = draw_stack_count - null_move_draw_stack_count;
+	if (end < 3)
+		return FALSE;
+
+	for (int i = 3; i <= end; i += 2) {
+
+		t_hash key = board->hash ^ draw_stack[draw_stack_count - i];
+		int j = CUCKOO_H1(key);
+		if (cuckoo[j] != key) {
+			j = CUCKOO_H2(key);
+			if (cuckoo[j] != key)
+				continue;
+		}
+
+		t_chess_square s1 = cuckoo_from[j];
+		t_chess_square s2 = cuckoo_to[j];
+		if (between[s1][s2] & board->all_pieces)
+			continue;
+
+		//-- The piece has to be ours, or it's the move that led here
+		t_chess_piece piece = board->square[s1] ? board->square[s1] : board->square[s2];
+		if (piece && COLOR(piece) == board->to_move)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 BOOL is_checkmate(struct t_board *board)
 {
 	if (!board->in_check)
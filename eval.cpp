@@ -19,26 +19,76 @@
 #include "procs.h"
 #include "bittwiddle.h"
 
+//-- The network when one is loaded, otherwise the handcrafted evaluation
+static inline t_chess_value score_position(struct t_board *board, struct t_chess_eval *eval) {
+	if (use_nnue)
+		return nnue_evaluate(board, eval);
+	return calc_evaluation(board, eval);
+}
+
 t_chess_value evaluate(struct t_board *board, struct t_chess_eval *eval) {
 
+	eval->evaluated = TRUE;
+
 	//-- Known ending?
-	int index = board->material_hash & material_hash_mask;
-	if (material_hash[index].key == board->material_hash){
-		assert(material_hash[index].eval_endgame != NULL);
-		material_hash[index].eval_endgame(board, eval);
+	if (board->material_index < MATERIAL_INDEX_SIZE && material_record[board->material_index].eval_endgame){
+		material_record[board->material_index].eval_endgame(board, eval);
 		return eval->static_score;
 	}
-	else
-		return calc_evaluation(board, eval);
+
+	//-- Evaluated this position before?
+	struct t_eval_hash_record *eval_record = &eval_hash[board->hash & eval_hash_mask];
+	eval_hash_probes++;
+	if (eval_record->key == board->hash){
+		eval_hash_hits++;
+		assert(eval_record->static_score == score_position(board, eval));
+		eval->static_score = eval_record->static_score;
+		return eval->static_score;
+	}
+
+	eval_record->key = board->hash;
+	eval_record->static_score = score_position(board, eval);
+	return eval_record->static_score;
+}
+
+//-- The search only evaluates a ply when it reads the score; the result is kept until the next move is made
+t_chess_value get_static_score(struct t_board *board, struct t_chess_eval *eval) {
+
+	if (eval->evaluated)
+		return eval->static_score;
+	return evaluate(board, eval);
+}
+
+//-- Blend the two halves of a packed score by the game phase
+static inline t_chess_value taper(t_score score, int game_phase) {
+	return ((MG_SCORE(score) * game_phase) + (EG_SCORE(score) * (256 - game_phase))) / 256;
+}
+
+//-- As get_static_score but settles for material + piece-square if that is clearly outside the window
+t_chess_value get_lazy_score(struct t_board *board, struct t_chess_eval *eval, t_chess_value alpha, t_chess_value beta) {
+
+	if (eval->evaluated)
+		return eval->static_score;
+
+	//-- Known endings must always be scored properly, and the material + piece-square estimate means nothing to the network
+	if (use_nnue || (board->material_index < MATERIAL_INDEX_SIZE && material_record[board->material_index].eval_endgame))
+		return evaluate(board, eval);
+
+	t_chess_value score = (1 - 2 * board->to_move) * taper(board->material_pst, board->game_phase);
+	if (score - LAZY_EVAL_MARGIN >= beta || score + LAZY_EVAL_MARGIN <= alpha)
+		return score;
+
+	return evaluate(board, eval);
 }
 
 t_chess_value calc_evaluation(struct t_board *board, struct t_chess_eval *eval) {
 
 	t_chess_value score;
+	struct t_material_record spare;
+	struct t_material_record *material = lookup_material(board, &spare);
 
-	//-- Normal Position
-	eval->middlegame = 0;
-    eval->endgame = 0;
+	//-- Normal Position: start from the material + piece-square score kept by make_move, plus the material imbalance
+	eval->score = board->material_pst + material->imbalance;
 
     //-- Are we in the middle game, endgame or somewhere in between
 	calc_game_phase(board, eval);
@@ -55,8 +105,13 @@ t_chess_value calc_evaluation(struct t_board *board, struct t_chess_eval *eval)
 	//-- Is the king in danger
     calc_king_safety(board, eval);
 
+	//-- Endings the side ahead can rarely win are pulled towards a draw
+	t_chess_color ahead = (EG_SCORE(eval->score) < 0 ? BLACK : WHITE);
+	if (material->scale[ahead] != MATERIAL_SCALE_NORMAL)
+		eval->score = MAKE_SCORE(MG_SCORE(eval->score), EG_SCORE(eval->score) * material->scale[ahead] / MATERIAL_SCALE_NORMAL);
+
 	//-- Return the rights score
-    score = (1 - 2 * board->to_move) * (((eval->middlegame * eval->game_phase) + (eval->endgame * (256 - eval->game_phase))) / 256);
+    score = (1 - 2 * board->to_move) * taper(eval->score, eval->game_phase);
 
 	//-- Store the score
     eval->static_score = score;
@@ -65,18 +120,14 @@ t_chess_value calc_evaluation(struct t_board *board, struct t_chess_eval *eval)
 }
 
 inline void calc_game_phase(struct t_board *board, struct t_chess_eval *eval) {
-    //-- Phase of the game
-    eval->game_phase = 2 * popcount(board->piecelist[WHITEPAWN] ^ board->piecelist[BLACKPAWN]);
-    eval->game_phase += 44 * popcount(board->piecelist[WHITEQUEEN] ^ board->piecelist[BLACKQUEEN]);
-    eval->game_phase += 16 * popcount(board->piecelist[WHITEROOK] ^ board->piecelist[BLACKROOK]);
-    eval->game_phase += 12 * popcount(board->piecelist[WHITEBISHOP] ^ board->piecelist[BLACKBISHOP]);
-    eval->game_phase += 6 * popcount(board->piecelist[WHITEKNIGHT] ^ board->piecelist[BLACKKNIGHT]);
+    //-- Phase of the game (kept up to date by make_move)
+    assert(board->game_phase == calc_board_phase(board));
+    eval->game_phase = board->game_phase;
 }
 
 inline void calc_pawn_value(struct t_board *board, struct t_chess_eval *eval) {
     eval->pawn_evaluation = lookup_pawn_hash(board, eval);
-    eval->middlegame += eval->pawn_evaluation->middlegame;
-    eval->endgame += eval->pawn_evaluation->endgame;
+    eval->score += eval->pawn_evaluation->score;
 }
 
 static inline int square_distance(int s1, int s2)
@@ -94,16 +145,17 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
     t_chess_color color, opponent;
     t_chess_square square;
     t_chess_piece piece;
-    t_chess_piece piece_type;
     t_bitboard b;
 	t_bitboard moves;
-	int move_count;
 	struct t_pawn_hash_record *pawn_record = eval->pawn_evaluation;
 
+	//-- Sliders of both colors are gathered here and scored together by the mobility kernels
+	struct t_slider_batch rooks, queens, bishops;
+	rooks.count = queens.count = bishops.count = 0;
+
 	for (color = WHITE; color <= BLACK; color++) {
 
-		t_chess_value middlegame = 0;
-		t_chess_value endgame = 0;
+		t_score score = 0;
 
 		opponent = OPPONENT(color);
 
@@ -120,46 +172,22 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 
 		//-- Rooks on the 7th
 		if (b & rank_mask[color][6] && board->pieces[opponent][KING] & rank_mask[color][7]){
-			middlegame = +MG_ROOK_ON_7TH;
-			endgame = +MG_ROOK_ON_7TH;
+			score = MAKE_SCORE(eval_terms.rook_on_7th, eval_terms.rook_on_7th);
 		}
 
 		//-- Rooks on Open file
 		if (b & pawn_record->open_file){
-			middlegame += pawn_record->pawn_count[color] * MG_ROOK_ON_OPEN_FILE;
+			score += MAKE_SCORE(pawn_record->pawn_count[color] * eval_terms.mg_rook_on_open_file, 0);
 		}
 
 		//-- Rooks on Semi-Open file
 		if (b & pawn_record->semi_open_file[color]){
-			middlegame += pawn_record->pawn_count[color] * MG_ROOK_ON_SEMI_OPEN_FILE;
+			score += MAKE_SCORE(pawn_record->pawn_count[color] * eval_terms.mg_rook_on_semi_open_file, 0);
 		}
 
-		//-- Loop around for all pieces
-		while (b){
-
-			//-- Find the square it resides
-			square = bitscan_reset(&b);
-
-			//-- Generate moves
-			moves = rook_magic_moves[square][((rook_magic[square].mask & _all_pieces) * rook_magic[square].magic) >> 52];
-			eval->attacks[color][ROOK] |= moves;
-			moves &= _not_occupied;
-
-			//-- Mobility (along ranks)
-			move_count = popcount(moves & square_rank_mask[square]);
-			middlegame += horizontal_rook_mobility[MIDDLEGAME][move_count];
-			endgame += horizontal_rook_mobility[ENDGAME][move_count];
-
-			//-- Mobility (along files)
-			move_count = popcount(moves & square_column_mask[square]);
-			middlegame += vertical_rook_mobility[MIDDLEGAME][move_count];
-			endgame += vertical_rook_mobility[ENDGAME][move_count];
-
-			// piece-square tables
-			middlegame += piece_square_table[piece][MIDDLEGAME][square];
-			endgame += piece_square_table[piece][ENDGAME][square];
-
-		}
+		//-- Mobility along ranks and files is left to the kernel
+		while (b)
+			add_slider(&rooks, color, bitscan_reset(&b), _all_pieces, _not_occupied);
 
 		//=========================================================
 		//-- Queens
@@ -171,27 +199,9 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 		_all_pieces ^= board->pieces[color][BISHOP];
 		_not_occupied = ~(board->occupied[color] & _all_pieces);
 
-		while (b){
-			//-- Find the square it resides
-			square = bitscan_reset(&b);
-
-			//-- Rook-like Moves
-			t_bitboard rook_moves = rook_magic_moves[square][((rook_magic[square].mask & _all_pieces) * rook_magic[square].magic) >> 52];
-			eval->attacklist[piece] |= rook_moves;
-			rook_moves &= _not_occupied;
-
-			//-- Bishop-like moves
-			t_bitboard bishop_moves = bishop_magic_moves[square][((bishop_magic[square].mask & _all_pieces) * bishop_magic[square].magic) >> 55];
-			eval->attacklist[piece] |= bishop_moves;
-			bishop_moves &= _not_occupied;
-
-			//-- Mobility
-			middlegame += popcount((rook_moves & square_column_mask[square]) | bishop_moves);
-
-			//-- piece-square tables
-			middlegame += piece_square_table[piece][MIDDLEGAME][square];
-			endgame += piece_square_table[piece][ENDGAME][square];
-		}
+		//-- Mobility is counted on files and diagonals
+		while (b)
+			add_slider(&queens, color, bitscan_reset(&b), _all_pieces, _not_occupied);
 
 		//=========================================================
 		//-- Bishops
@@ -200,38 +210,15 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 		eval->attacklist[piece] = 0;
 		b = board->piecelist[piece];
 
-		//-- Bishop pair bonus
-		if (b & (b - 1)){
-			middlegame += MG_BISHOP_PAIR;
-			endgame += EG_BISHOP_PAIR;
-		}
-
 		//-- Remove Own Pieces (leave pawns)
 		_all_pieces = board->occupied[opponent] | board->pieces[color][PAWN];
 		_not_occupied = ~board->pieces[color][PAWN];
 
-		while (b){
-			//-- Find the square it resides
-			square = bitscan_reset(&b);
-
-			//-- Generate moves
-			moves = bishop_magic_moves[square][((bishop_magic[square].mask & _all_pieces) * bishop_magic[square].magic) >> 55];
-			eval->attacklist[piece] |= moves;
-			moves &= _not_occupied;
-
-			//-- Mobility
-			move_count = popcount(moves);
-			middlegame += bishop_mobility[MIDDLEGAME][move_count];
-			endgame += bishop_mobility[ENDGAME][move_count];
+		while (b)
+			add_slider(&bishops, color, bitscan_reset(&b), _all_pieces, _not_occupied);
 
-			//-- Trapped
-			//middlegame -= trapped_bishop[MIDDLEGAME][move_count];
-			//endgame -= trapped_bishop[ENDGAME][move_count];
-
-			// piece-square tables
-			middlegame += piece_square_table[piece][MIDDLEGAME][square];
-			endgame += piece_square_table[piece][ENDGAME][square];
-		}
+		//-- Trapped
+		//score -= trapped_bishop[move_count];
 
 		//=========================================================
 		//-- Knights
@@ -247,7 +234,7 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 			square = bitscan_reset(&b);
 
 			//-- Opponents King Tropism
-			middlegame -= square_distance(square, board->king_square[opponent]) * 2;
+			score -= MAKE_SCORE(square_distance(square, board->king_square[opponent]) * 2, 0);
 
 			//-- Generate moves
 			moves = knight_mask[square];
@@ -256,18 +243,12 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 
 			//-- Connected to another knight
 			if (knight_mask[square] & board->piecelist[piece]){
-				middlegame += MG_CONNECTED_KNIGHTS;
-				endgame += EG_CONNECTED_KNIGHTS;
+				score += MAKE_SCORE(eval_terms.mg_connected_knights, eval_terms.eg_connected_knights);
 			}
 
 			//-- Trapped
 			//move_count = popcount(moves);
-			//middlegame -= trapped_knight[MIDDLEGAME][move_count];
-			//endgame -= trapped_knight[ENDGAME][move_count];
-
-			// piece-square tables
-			middlegame += piece_square_table[piece][MIDDLEGAME][square];
-			endgame += piece_square_table[piece][ENDGAME][square];
+			//score -= trapped_knight[move_count];
 		}
 
 		//=========================================================
@@ -277,13 +258,35 @@ inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval) {
 		eval->attacklist[piece] = king_mask[board->king_square[color]];
 
 		//-- Add to board scores
-		eval->middlegame += middlegame * (1 - color * 2);
-		eval->endgame += endgame * (1 - color * 2);
+		eval->score += score * (1 - color * 2);
+	}
+
+	//=========================================================
+	//-- Slider mobility and attacks for both colors at once
+	//=========================================================
+	t_bitboard attacks[2];
+
+	attacks[WHITE] = attacks[BLACK] = 0;
+	eval->score += rook_mobility_kernel(&rooks, attacks);
+	eval->attacks[WHITE][ROOK] = attacks[WHITE];
+	eval->attacks[BLACK][ROOK] = attacks[BLACK];
+
+	attacks[WHITE] = attacks[BLACK] = 0;
+	eval->score += queen_mobility_kernel(&queens, attacks);
+	eval->attacks[WHITE][QUEEN] = attacks[WHITE];
+	eval->attacks[BLACK][QUEEN] = attacks[BLACK];
+
+	attacks[WHITE] = attacks[BLACK] = 0;
+	eval->score += bishop_mobility_kernel(&bishops, attacks);
+	eval->attacks[WHITE][BISHOP] = attacks[WHITE];
+	eval->attacks[BLACK][BISHOP] = attacks[BLACK];
 
-		//-- Create combined attacks
+	//-- Create combined attacks
+	for (color = WHITE; color <= BLACK; color++)
 		eval->attacks[color][BLANK] = eval->attacks[color][PAWN] | eval->attacks[color][ROOK] | eval->attacks[color][BISHOP] | eval->attacks[color][KNIGHT] | eval->attacks[color][QUEEN] | eval->attacks[color][KING];
 
-	}
+	//-- Move ordering and SEE can use the maps while the search stays in this position
+	eval->attack_hash = board->hash;
 }
 
 
@@ -295,8 +298,7 @@ inline void calc_passed_pawns(struct t_board *board, struct t_chess_eval *eval)
 
 		t_chess_color opponent = OPPONENT(color);
 
-		t_chess_value middlegame = 0;
-		t_chess_value endgame = 0;
+		t_score score = 0;
 
 		//-- Do we have any passed pawns
 		t_bitboard b = pawn_record->passed[color];
@@ -308,13 +310,14 @@ inline void calc_passed_pawns(struct t_board *board, struct t_chess_eval *eval)
 			if (color) rank = (7 - rank);
 
 			//-- Find normal bonus
-			t_chess_value bonus = passed_pawn_bonus[color][square];
+			t_score bonus = passed_pawn_bonus[color][square];
+			t_chess_value mg_bonus = MG_SCORE(bonus);
+			t_chess_value eg_bonus = EG_SCORE(bonus);
 
 			//-- Is piece in front of passed pawn
 			if (forward_squares[color][square] & board->occupied[color]){
 
-				middlegame -= (bonus / 2);
-				endgame -= (bonus / 3);
+				score -= MAKE_SCORE(mg_bonus / 2, eg_bonus / 3);
 			}
 			else {
 
@@ -332,28 +335,25 @@ inline void calc_passed_pawns(struct t_board *board, struct t_chess_eval *eval)
 						// v2 = /2, /2
 						// v2 = /3, /3
 						// v2 = /4, /4
-						middlegame += bonus / 2;
-						endgame += bonus / 1;
+						score += MAKE_SCORE(mg_bonus / 2, eg_bonus / 1);
 
 					}
 					//-- Yes it's attacked
 					else{
-						middlegame += bonus / 3;
-						endgame += bonus / 2;
+						score += MAKE_SCORE(mg_bonus / 3, eg_bonus / 2);
 					}
 
 					//-- Add King Tropism
 					int distance = square_distance(square, board->king_square[opponent]) - square_distance(square, board->king_square[color]);
 					if (distance > 1)
-						endgame += (bonus / 5);
+						score += MAKE_SCORE(0, eg_bonus / 5);
 
 				}
 			}
 
 			//-- Is a Rook behind the passed pawn
 			if (forward_squares[opponent][square] & board->pieces[color][ROOK]){
-				middlegame += MG_ROOK_BEHIND_PASSED_PAWN;
-				endgame += EG_ROOK_BEHIND_PASSED_PAWN;
+				score += MAKE_SCORE(MG_ROOK_BEHIND_PASSED_PAWN, EG_ROOK_BEHIND_PASSED_PAWN);
 			}
 
 		}
@@ -365,15 +365,15 @@ inline void calc_king_safety(struct t_board *board, struct t_chess_eval *eval) {
 }
 
 void init_eval(struct t_chess_eval *eval) {
+    eval->evaluated = FALSE;
+    eval->attack_hash = 0;
     eval->attacks[WHITE] = eval->attacklist;
     eval->attacks[BLACK] = eval->attacklist + 8;
+    eval->pawn_table = NULL;
+    eval->pawn_table_mask = 0;
 }
 
 void init_eval_function() {
-    t_chess_piece piece;
-    t_chess_piece piece_type;
-    t_chess_square square, s;
-    t_chess_color color;
 
     piece_value[0][PAWN] = MG_PAWN_VALUE;
     piece_value[1][PAWN] = EG_PAWN_VALUE;
@@ -393,6 +393,30 @@ void init_eval_function() {
     piece_value[0][KING] = 0;
     piece_value[1][KING] = 0;
 
+    eval_terms.mg_isolated_pawn = MG_ISOLATED_PAWN;
+    eval_terms.eg_isolated_pawn = EG_ISOLATED_PAWN;
+    eval_terms.mg_bishop_pair = MG_BISHOP_PAIR;
+    eval_terms.eg_bishop_pair = EG_BISHOP_PAIR;
+    eval_terms.mg_connected_knights = MG_CONNECTED_KNIGHTS;
+    eval_terms.eg_connected_knights = EG_CONNECTED_KNIGHTS;
+    eval_terms.rook_on_7th = MG_ROOK_ON_7TH;
+    eval_terms.mg_rook_on_open_file = MG_ROOK_ON_OPEN_FILE;
+    eval_terms.mg_rook_on_semi_open_file = MG_ROOK_ON_SEMI_OPEN_FILE;
+
+    init_piece_square_tables();
+
+    //-- The material records hold the bishop pair bonus and depend on the piece values
+    if (material_record != NULL)
+        fill_material_records();
+}
+
+//-- Material + piece-square tables from the current piece values
+void init_piece_square_tables() {
+    t_chess_piece piece;
+    t_chess_piece piece_type;
+    t_chess_square square, s;
+    t_chess_color color;
+
     //-- reset
     for (color = WHITE; color <= BLACK; color++) {
         for (s = A1; s <= H8; s++) {
@@ -401,32 +425,25 @@ void init_eval_function() {
                 square = FLIP64(square);
             for (piece_type = KNIGHT; piece_type <= KING; piece_type++) {
                 piece = PIECEINDEX(color, piece_type);
-                piece_square_table[piece][MIDDLEGAME][square] = 0;
-                piece_square_table[piece][ENDGAME][square] = 0;
+                piece_square_table[piece][square] = 0;
                 switch (piece_type) {
                 case KNIGHT:
-                    piece_square_table[piece][MIDDLEGAME][square] = knight_pst[MIDDLEGAME][s] + MG_KNIGHT_VALUE;
-                    piece_square_table[piece][ENDGAME][square] = knight_pst[ENDGAME][s] + EG_KNIGHT_VALUE;
+                    piece_square_table[piece][square] = MAKE_SCORE(knight_pst[MIDDLEGAME][s] + piece_value[0][KNIGHT], knight_pst[ENDGAME][s] + piece_value[1][KNIGHT]);
                     break;
                 case BISHOP:
-                    piece_square_table[piece][MIDDLEGAME][square] = bishop_pst[MIDDLEGAME][s] + MG_BISHOP_VALUE;
-                    piece_square_table[piece][ENDGAME][square] = bishop_pst[ENDGAME][s] + EG_BISHOP_VALUE;
+                    piece_square_table[piece][square] = MAKE_SCORE(bishop_pst[MIDDLEGAME][s] + piece_value[0][BISHOP], bishop_pst[ENDGAME][s] + piece_value[1][BISHOP]);
                     break;
                 case ROOK:
-                    piece_square_table[piece][MIDDLEGAME][square] = rook_pst[MIDDLEGAME][s] + MG_ROOK_VALUE;
-                    piece_square_table[piece][ENDGAME][square] = rook_pst[ENDGAME][s] + EG_ROOK_VALUE;
+                    piece_square_table[piece][square] = MAKE_SCORE(rook_pst[MIDDLEGAME][s] + piece_value[0][ROOK], rook_pst[ENDGAME][s] + piece_value[1][ROOK]);
                     break;
                 case QUEEN:
-                    piece_square_table[piece][MIDDLEGAME][square] = queen_pst[MIDDLEGAME][s] + MG_QUEEN_VALUE;
-                    piece_square_table[piece][ENDGAME][square] = queen_pst[ENDGAME][s] + EG_QUEEN_VALUE;
+                    piece_square_table[piece][square] = MAKE_SCORE(queen_pst[MIDDLEGAME][s] + piece_value[0][QUEEN], queen_pst[ENDGAME][s] + piece_value[1][QUEEN]);
                     break;
                 case PAWN:
-                    piece_square_table[piece][MIDDLEGAME][square] = pawn_pst[MIDDLEGAME][s] + MG_PAWN_VALUE;
-                    piece_square_table[piece][ENDGAME][square] = pawn_pst[ENDGAME][s] + EG_PAWN_VALUE;
+                    piece_square_table[piece][square] = MAKE_SCORE(pawn_pst[MIDDLEGAME][s] + piece_value[0][PAWN], pawn_pst[ENDGAME][s] + piece_value[1][PAWN]);
                     break;
                 case KING:
-                    piece_square_table[piece][MIDDLEGAME][square] = king_pst[MIDDLEGAME][s];
-                    piece_square_table[piece][ENDGAME][square] = king_pst[ENDGAME][s];
+                    piece_square_table[piece][square] = MAKE_SCORE(king_pst[MIDDLEGAME][s], king_pst[ENDGAME][s]);
                     break;
                 }
             }
@@ -434,6 +451,33 @@ void init_eval_function() {
     }
 }
 
+//-- Material + piece-square value of one piece from white's point of view (kings are left to king safety)
+t_score pst_value(t_chess_piece piece, t_chess_square square) {
+    if (piece == BLANK || PIECETYPE(piece) == KING)
+        return 0;
+    return piece_square_table[piece][square] * (1 - 2 * COLOR(piece));
+}
+
+t_score calc_board_pst(struct t_board *board) {
+    t_score score = 0;
+    t_chess_square s;
+
+    for (s = A1; s <= H8; s++)
+        score += pst_value(board->square[s], s);
+    return score;
+}
+
+int calc_board_phase(struct t_board *board) {
+    int phase = 0;
+    t_chess_square s;
+
+    for (s = A1; s <= H8; s++) {
+        if (board->square[s])
+            phase += game_phase_weight[PIECETYPE(board->square[s])];
+    }
+    return phase;
+}
+
 void known_endgame_QKvk(struct t_board *board, struct t_chess_eval *eval)
 {
 	eval->static_score = lone_king[board->king_square[BLACK]] + 1200 - 10 * square_distance(board->king_square[WHITE], board->king_square[BLACK]);
@@ -627,3 +671,12 @@ void known_endgame_KBvkr(struct t_board *board, struct t_chess_eval *eval)
 	eval->static_score *= (1 - board->to_move * 2);
 }
 
+void known_endgame_KPvk(struct t_board *board, struct t_chess_eval *eval)
+{
+	eval->static_score = kpk_score(board);
+}
+
+void known_endgame_Kvkp(struct t_board *board, struct t_chess_eval *eval)
+{
+	eval->static_score = kpk_score(board);
+}
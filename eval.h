@@ -48,6 +48,13 @@
 #define MG_ROOK_ON_7TH					10
 #define EG_ROOK_ON_7TH					5
 
+//-- King + pawn vs. king wins (plus a bonus per rank so the pawn is pushed)
+#define KPK_WIN_SCORE					900
+#define KPK_PAWN_RANK_BONUS				20
+
+//-- Lazy evaluation: the most the positional terms can move the material + piece-square score
+#define LAZY_EVAL_MARGIN				300
+
 //-- Rooks on open file
 #define MG_ROOK_ON_OPEN_FILE			2
 #define MG_ROOK_ON_SEMI_OPEN_FILE		1
\ No newline at end of file
@@ -0,0 +1,64 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//-- A small, always-replace cache of static scores (side to move's point of view) keyed on the board hash
+void init_eval_hash()
+{
+    eval_hash = NULL;
+    uci.options.eval_hash_table_size = 0;
+    set_eval_hash(EVAL_HASH_DEFAULT);
+}
+
+void destroy_eval_hash()
+{
+    if (uci.engine_initialized)
+        free(eval_hash);
+}
+
+void set_eval_hash(unsigned int size)
+{
+    t_hash i;
+
+    //-- Keep to the range given in the UCI option
+    if (size < EVAL_HASH_MIN) size = EVAL_HASH_MIN;
+    if (size > EVAL_HASH_MAX) size = EVAL_HASH_MAX;
+
+    if (uci.options.eval_hash_table_size == size) return;
+
+    i = 1;
+    while ((i << 1) * sizeof(struct t_eval_hash_record) <= (t_hash)size * 1024 * 1024)
+        (i <<= 1);
+
+    free(eval_hash);
+    eval_hash = (struct t_eval_hash_record*)malloc(i * sizeof(struct t_eval_hash_record));
+    assert(eval_hash);
+    eval_hash_mask = i - 1;
+    clear_eval_hash();
+    uci.options.eval_hash_table_size = size;
+}
+
+void clear_eval_hash()
+{
+    t_hash i;
+
+    for (i = 0; i <= eval_hash_mask; i++) {
+        eval_hash[i].key = 0;
+        eval_hash[i].static_score = 0;
+    }
+}
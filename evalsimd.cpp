@@ -0,0 +1,275 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// Slider mobility kernels
+//
+// calc_piece_value() puts every rook, bishop or queen of both
+// colors into a t_slider_batch, one lane per piece, with the
+// occupancy that piece sees.  A kernel returns the mobility
+// score (white minus black) and ORs each lane's attacks into
+// attacks[color].  The AVX2 kernels run four lanes at a time;
+// the scalar kernels are the reference and the fallback.
+//===========================================================//
+
+void add_slider(struct t_slider_batch *batch, t_chess_color color, t_chess_square square, t_bitboard occupied, t_bitboard not_occupied)
+{
+    assert(batch->count < MAX_SLIDER_LANES);
+    batch->square[batch->count] = square;
+    batch->color[batch->count] = color;
+    batch->occupied[batch->count] = occupied;
+    batch->not_occupied[batch->count] = not_occupied;
+    batch->count++;
+}
+
+static t_score rook_mobility_scalar(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    t_score score = 0;
+
+    for (int i = 0; i < batch->count; i++) {
+        t_chess_square square = batch->square[i];
+        t_bitboard moves = rook_attacks(square, batch->occupied[i]);
+        attacks[batch->color[i]] |= moves;
+        moves &= batch->not_occupied[i];
+        score += (horizontal_rook_mobility[popcount(moves & square_rank_mask[square])] + vertical_rook_mobility[popcount(moves & square_column_mask[square])]) * (1 - 2 * batch->color[i]);
+    }
+    return score;
+}
+
+static t_score bishop_mobility_scalar(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    t_score score = 0;
+
+    for (int i = 0; i < batch->count; i++) {
+        t_bitboard moves = bishop_attacks(batch->square[i], batch->occupied[i]);
+        attacks[batch->color[i]] |= moves;
+        moves &= batch->not_occupied[i];
+        score += bishop_mobility[popcount(moves)] * (1 - 2 * batch->color[i]);
+    }
+    return score;
+}
+
+static t_score queen_mobility_scalar(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    t_score score = 0;
+
+    for (int i = 0; i < batch->count; i++) {
+        t_chess_square square = batch->square[i];
+        t_bitboard rook_moves = rook_attacks(square, batch->occupied[i]);
+        t_bitboard bishop_moves = bishop_attacks(square, batch->occupied[i]);
+        attacks[batch->color[i]] |= rook_moves | bishop_moves;
+        rook_moves &= batch->not_occupied[i];
+        bishop_moves &= batch->not_occupied[i];
+        score += MAKE_SCORE(popcount((rook_moves & square_column_mask[square]) | bishop_moves), 0) * (1 - 2 * batch->color[i]);
+    }
+    return score;
+}
+
+#ifdef HAVE_AVX2_KERNELS
+
+//-- Fill the unused lanes of the last group of four with empty squares (they score nothing)
+static void pad_lanes(struct t_slider_batch *batch)
+{
+    for (int i = batch->count; i & 3; i++) {
+        batch->square[i] = A1;
+        batch->color[i] = WHITE;
+        batch->occupied[i] = 0;
+        batch->not_occupied[i] = 0;
+    }
+}
+
+//-- +1 for white, -1 for black and 0 for padding lanes (used with _mm_sign_epi32)
+AVX2_TARGET static inline __m128i lane_signs(const struct t_slider_batch *batch, int first)
+{
+    int sign[4];
+
+    for (int i = 0; i < 4; i++)
+        sign[i] = (first + i < batch->count) ? 1 - 2 * batch->color[first + i] : 0;
+    return _mm_loadu_si128((const __m128i *)sign);
+}
+
+//-- Population count of each 64-bit lane (nibble lookup, then summed with psadbw)
+AVX2_TARGET static inline __m256i popcount_lanes(__m256i x)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low_nibble));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low_nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+//-- Low 64 bits of a 64 x 64 multiply in each lane (AVX2 only multiplies 32 x 32)
+AVX2_TARGET static inline __m256i multiply_lanes(__m256i a, __m256i b)
+{
+    __m256i lo = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+//-- Four lanes of a table: indices go out through memory and come back as plain loads, which is quicker than
+//-- vpgather on parts with the gather data sampling fix
+AVX2_TARGET static inline __m256i load_lanes_64(const t_bitboard *table, __m256i index)
+{
+    long long i[4];
+
+    _mm256_storeu_si256((__m256i *)i, index);
+    return _mm256_setr_epi64x(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+}
+
+AVX2_TARGET static inline __m128i load_lanes_32(const t_score *table, __m256i index)
+{
+    long long i[4];
+
+    _mm256_storeu_si256((__m256i *)i, index);
+    return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+}
+
+//-- Attack sets of four lanes: magic indices are computed in parallel, pext ones a lane at a time
+AVX2_TARGET static inline __m256i slider_lanes(const struct t_magic_structure *magic, const struct t_slider_batch *batch, int first)
+{
+    const struct t_magic_structure *m0 = &magic[batch->square[first]];
+    const struct t_magic_structure *m1 = &magic[batch->square[first + 1]];
+    const struct t_magic_structure *m2 = &magic[batch->square[first + 2]];
+    const struct t_magic_structure *m3 = &magic[batch->square[first + 3]];
+    const t_bitboard *occupied = batch->occupied + first;
+
+    if (use_pext)
+        return _mm256_setr_epi64x(slider_attacks[m0->offset + pext(occupied[0], m0->mask)], slider_attacks[m1->offset + pext(occupied[1], m1->mask)],
+                                  slider_attacks[m2->offset + pext(occupied[2], m2->mask)], slider_attacks[m3->offset + pext(occupied[3], m3->mask)]);
+
+    __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)occupied), _mm256_setr_epi64x(m0->mask, m1->mask, m2->mask, m3->mask));
+    b = multiply_lanes(b, _mm256_setr_epi64x(m0->magic, m1->magic, m2->magic, m3->magic));
+    b = _mm256_srlv_epi64(b, _mm256_setr_epi64x(m0->shift, m1->shift, m2->shift, m3->shift));
+    return load_lanes_64(slider_attacks, _mm256_add_epi64(b, _mm256_setr_epi64x(m0->offset, m1->offset, m2->offset, m3->offset)));
+}
+
+AVX2_TARGET static inline void or_lane_attacks(const struct t_slider_batch *batch, int first, __m256i moves, t_bitboard *attacks)
+{
+    t_bitboard lane[4];
+
+    _mm256_storeu_si256((__m256i *)lane, moves);
+    for (int i = 0; i < 4 && first + i < batch->count; i++)
+        attacks[batch->color[first + i]] |= lane[i];
+}
+
+//-- Sum the four packed scores in a vector
+AVX2_TARGET static inline t_score sum_lanes(__m128i score)
+{
+    score = _mm_add_epi32(score, _mm_shuffle_epi32(score, 0x4e));
+    score = _mm_add_epi32(score, _mm_shuffle_epi32(score, 0xb1));
+    return _mm_cvtsi128_si32(score);
+}
+
+AVX2_TARGET static t_score rook_mobility_avx2(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    __m128i score = _mm_setzero_si128();
+
+    pad_lanes(batch);
+    for (int i = 0; i < batch->count; i += 4) {
+        __m256i moves = slider_lanes(rook_magic, batch, i);
+        or_lane_attacks(batch, i, moves, attacks);
+        moves = _mm256_and_si256(moves, _mm256_loadu_si256((const __m256i *)(batch->not_occupied + i)));
+
+        const t_chess_square *s = batch->square + i;
+        __m256i ranks = _mm256_setr_epi64x(square_rank_mask[s[0]], square_rank_mask[s[1]], square_rank_mask[s[2]], square_rank_mask[s[3]]);
+        __m256i columns = _mm256_setr_epi64x(square_column_mask[s[0]], square_column_mask[s[1]], square_column_mask[s[2]], square_column_mask[s[3]]);
+
+        __m128i mobility = _mm_add_epi32(load_lanes_32(horizontal_rook_mobility, popcount_lanes(_mm256_and_si256(moves, ranks))),
+                                         load_lanes_32(vertical_rook_mobility, popcount_lanes(_mm256_and_si256(moves, columns))));
+        score = _mm_add_epi32(score, _mm_sign_epi32(mobility, lane_signs(batch, i)));
+    }
+    return sum_lanes(score);
+}
+
+AVX2_TARGET static t_score bishop_mobility_avx2(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    __m128i score = _mm_setzero_si128();
+
+    pad_lanes(batch);
+    for (int i = 0; i < batch->count; i += 4) {
+        __m256i moves = slider_lanes(bishop_magic, batch, i);
+        or_lane_attacks(batch, i, moves, attacks);
+        moves = _mm256_and_si256(moves, _mm256_loadu_si256((const __m256i *)(batch->not_occupied + i)));
+
+        __m128i mobility = load_lanes_32(bishop_mobility, popcount_lanes(moves));
+        score = _mm_add_epi32(score, _mm_sign_epi32(mobility, lane_signs(batch, i)));
+    }
+    return sum_lanes(score);
+}
+
+AVX2_TARGET static t_score queen_mobility_avx2(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+    __m128i score = _mm_setzero_si128();
+
+    pad_lanes(batch);
+    for (int i = 0; i < batch->count; i += 4) {
+        __m256i rook_moves = slider_lanes(rook_magic, batch, i);
+        __m256i bishop_moves = slider_lanes(bishop_magic, batch, i);
+        or_lane_attacks(batch, i, _mm256_or_si256(rook_moves, bishop_moves), attacks);
+
+        const t_chess_square *s = batch->square + i;
+        __m256i columns = _mm256_setr_epi64x(square_column_mask[s[0]], square_column_mask[s[1]], square_column_mask[s[2]], square_column_mask[s[3]]);
+        __m256i moves = _mm256_and_si256(_mm256_or_si256(_mm256_and_si256(rook_moves, columns), bishop_moves), _mm256_loadu_si256((const __m256i *)(batch->not_occupied + i)));
+
+        //-- Counts sit in the low 32 bits of each 64-bit lane; a queen's mobility is a middlegame-only score
+        __m256i count = popcount_lanes(moves);
+        __m128i mobility = _mm_unpacklo_epi64(_mm_shuffle_epi32(_mm256_castsi256_si128(count), 0x08), _mm_shuffle_epi32(_mm256_extracti128_si256(count, 1), 0x08));
+        score = _mm_add_epi32(score, _mm_sign_epi32(mobility, lane_signs(batch, i)));
+    }
+    return sum_lanes(score);
+}
+
+#endif
+
+t_score rook_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (use_avx2)
+        return rook_mobility_avx2(batch, attacks);
+#endif
+    return rook_mobility_scalar(batch, attacks);
+}
+
+t_score bishop_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (use_avx2)
+        return bishop_mobility_avx2(batch, attacks);
+#endif
+    return bishop_mobility_scalar(batch, attacks);
+}
+
+t_score queen_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (use_avx2)
+        return queen_mobility_avx2(batch, attacks);
+#endif
+    return queen_mobility_scalar(batch, attacks);
+}
+
+//-- The AVX2 kernels are only selected if this build has them
+BOOL avx2_kernels_available()
+{
+#ifdef HAVE_AVX2_KERNELS
+    return cpu.avx2;
+#else
+    return FALSE;
+#endif
+}
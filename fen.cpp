@@ -34,7 +34,7 @@ void set_fen(struct t_board *board, char *epd)
 
     board->hash = 0;
     board->pawn_hash = 0;
-	board->material_hash = 0;
+	board->material_index = 0;
 
     count = word_count(epd);
     if (count >= 0) strcpy(fen, word_index(0, epd));
@@ -207,8 +207,12 @@ void set_fen(struct t_board *board, char *epd)
     //// Reset draw variables
     board->fifty_move_count = 0;
     draw_stack_count = 0;
+    null_move_draw_stack_count = 0;
     draw_stack[0] = board->hash;
 
+    if (use_nnue)
+        nnue_refresh_all(board);
+
     //// Evaluate Position
     //board->static_value = evaluate(board);
 }
@@ -0,0 +1,274 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// Kogge-Stone slider fills
+//
+// The attacks of every rook (or bishop, or queen) of a color
+// at once, without a loop over the pieces: each direction is
+// an occluded fill in three shift steps (1, 2 and 4 squares),
+// masked so nothing wraps round the a and h files.
+//
+// The scalar fills are the reference.  The SSE2 fills run
+// white and black in the two lanes of a register, the AVX2
+// fills run four directions of one color.  Magics are still
+// used wherever a single piece's attacks are wanted; the
+// fills serve whole-side maps such as the king's escape
+// squares in generate_evade_check ("Fill Evasions").
+//===========================================================//
+
+#define FILL_ALL							0xffffffffffffffffULL
+#define FILL_NOT_A							0xfefefefefefefefeULL
+#define FILL_NOT_H							0x7f7f7f7f7f7f7f7fULL
+
+//-- Occluded fill towards higher squares; returns the attacked squares
+static inline t_bitboard fill_up(t_bitboard gen, t_bitboard pro, int s, t_bitboard wrap)
+{
+    pro &= wrap;
+    gen |= pro & (gen << s);
+    pro &= (pro << s);
+    gen |= pro & (gen << 2 * s);
+    pro &= (pro << 2 * s);
+    gen |= pro & (gen << 4 * s);
+    return (gen << s) & wrap;
+}
+
+//-- ...and towards lower squares
+static inline t_bitboard fill_down(t_bitboard gen, t_bitboard pro, int s, t_bitboard wrap)
+{
+    pro &= wrap;
+    gen |= pro & (gen >> s);
+    pro &= (pro >> s);
+    gen |= pro & (gen >> 2 * s);
+    pro &= (pro >> 2 * s);
+    gen |= pro & (gen >> 4 * s);
+    return (gen >> s) & wrap;
+}
+
+static t_bitboard rook_fill_scalar(t_bitboard rooks, t_bitboard empty)
+{
+    return fill_up(rooks, empty, 8, FILL_ALL) | fill_up(rooks, empty, 1, FILL_NOT_A)
+         | fill_down(rooks, empty, 8, FILL_ALL) | fill_down(rooks, empty, 1, FILL_NOT_H);
+}
+
+static t_bitboard bishop_fill_scalar(t_bitboard bishops, t_bitboard empty)
+{
+    return fill_up(bishops, empty, 9, FILL_NOT_A) | fill_up(bishops, empty, 7, FILL_NOT_H)
+         | fill_down(bishops, empty, 9, FILL_NOT_H) | fill_down(bishops, empty, 7, FILL_NOT_A);
+}
+
+#ifdef HAVE_AVX2_KERNELS
+
+//===========================================================//
+// SSE2: lane 0 is white, lane 1 is black
+//===========================================================//
+
+static inline __m128i fill_up_sse2(__m128i gen, __m128i pro, int s, t_bitboard wrap)
+{
+    const __m128i mask = _mm_set1_epi64x(wrap);
+    const __m128i s1 = _mm_cvtsi32_si128(s);
+    const __m128i s2 = _mm_cvtsi32_si128(2 * s);
+    const __m128i s4 = _mm_cvtsi32_si128(4 * s);
+
+    pro = _mm_and_si128(pro, mask);
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s1)));
+    pro = _mm_and_si128(pro, _mm_sll_epi64(pro, s1));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s2)));
+    pro = _mm_and_si128(pro, _mm_sll_epi64(pro, s2));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_sll_epi64(gen, s4)));
+    return _mm_and_si128(_mm_sll_epi64(gen, s1), mask);
+}
+
+static inline __m128i fill_down_sse2(__m128i gen, __m128i pro, int s, t_bitboard wrap)
+{
+    const __m128i mask = _mm_set1_epi64x(wrap);
+    const __m128i s1 = _mm_cvtsi32_si128(s);
+    const __m128i s2 = _mm_cvtsi32_si128(2 * s);
+    const __m128i s4 = _mm_cvtsi32_si128(4 * s);
+
+    pro = _mm_and_si128(pro, mask);
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s1)));
+    pro = _mm_and_si128(pro, _mm_srl_epi64(pro, s1));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s2)));
+    pro = _mm_and_si128(pro, _mm_srl_epi64(pro, s2));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srl_epi64(gen, s4)));
+    return _mm_and_si128(_mm_srl_epi64(gen, s1), mask);
+}
+
+static void rook_fill_sse2(const t_bitboard rooks[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+    __m128i gen = _mm_loadu_si128((const __m128i *)rooks);
+    __m128i pro = _mm_loadu_si128((const __m128i *)empty);
+
+    __m128i a = _mm_or_si128(_mm_or_si128(fill_up_sse2(gen, pro, 8, FILL_ALL), fill_up_sse2(gen, pro, 1, FILL_NOT_A)),
+                             _mm_or_si128(fill_down_sse2(gen, pro, 8, FILL_ALL), fill_down_sse2(gen, pro, 1, FILL_NOT_H)));
+    _mm_storeu_si128((__m128i *)attacks, a);
+}
+
+static void bishop_fill_sse2(const t_bitboard bishops[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+    __m128i gen = _mm_loadu_si128((const __m128i *)bishops);
+    __m128i pro = _mm_loadu_si128((const __m128i *)empty);
+
+    __m128i a = _mm_or_si128(_mm_or_si128(fill_up_sse2(gen, pro, 9, FILL_NOT_A), fill_up_sse2(gen, pro, 7, FILL_NOT_H)),
+                             _mm_or_si128(fill_down_sse2(gen, pro, 9, FILL_NOT_H), fill_down_sse2(gen, pro, 7, FILL_NOT_A)));
+    _mm_storeu_si128((__m128i *)attacks, a);
+}
+
+//===========================================================//
+// AVX2: one direction per lane.  Each lane shifts both ways,
+// the unwanted way by 64 or more, which vpsllvq / vpsrlvq
+// turn into zero.
+//===========================================================//
+
+AVX2_TARGET static inline __m256i shift_lanes(__m256i x, __m256i left, __m256i right)
+{
+    return _mm256_or_si256(_mm256_sllv_epi64(x, left), _mm256_srlv_epi64(x, right));
+}
+
+AVX2_TARGET static inline t_bitboard fill_lanes_avx2(t_bitboard sliders, t_bitboard empty, __m256i left, __m256i right, __m256i wrap)
+{
+    __m256i gen = _mm256_set1_epi64x(sliders);
+    __m256i pro = _mm256_and_si256(_mm256_set1_epi64x(empty), wrap);
+
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift_lanes(gen, left, right)));
+    pro = _mm256_and_si256(pro, shift_lanes(pro, left, right));
+    __m256i left2 = _mm256_add_epi64(left, left);
+    __m256i right2 = _mm256_add_epi64(right, right);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift_lanes(gen, left2, right2)));
+    pro = _mm256_and_si256(pro, shift_lanes(pro, left2, right2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shift_lanes(gen, _mm256_add_epi64(left2, left2), _mm256_add_epi64(right2, right2))));
+    __m256i a = _mm256_and_si256(shift_lanes(gen, left, right), wrap);
+
+    //-- OR the four directions together
+    __m128i x = _mm_or_si128(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+    x = _mm_or_si128(x, _mm_unpackhi_epi64(x, x));
+    return (t_bitboard)_mm_cvtsi128_si64(x);
+}
+
+//-- North, east, south, west
+AVX2_TARGET static inline t_bitboard rook_lanes_avx2(t_bitboard rooks, t_bitboard empty)
+{
+    return fill_lanes_avx2(rooks, empty, _mm256_setr_epi64x(8, 1, 64, 64), _mm256_setr_epi64x(64, 64, 8, 1),
+                           _mm256_setr_epi64x(FILL_ALL, FILL_NOT_A, FILL_ALL, FILL_NOT_H));
+}
+
+//-- North-east, north-west, south-west, south-east
+AVX2_TARGET static inline t_bitboard bishop_lanes_avx2(t_bitboard bishops, t_bitboard empty)
+{
+    return fill_lanes_avx2(bishops, empty, _mm256_setr_epi64x(9, 7, 64, 64), _mm256_setr_epi64x(64, 64, 9, 7),
+                           _mm256_setr_epi64x(FILL_NOT_A, FILL_NOT_H, FILL_NOT_H, FILL_NOT_A));
+}
+
+AVX2_TARGET static void rook_fill_avx2(const t_bitboard rooks[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+    attacks[WHITE] = rook_lanes_avx2(rooks[WHITE], empty[WHITE]);
+    attacks[BLACK] = rook_lanes_avx2(rooks[BLACK], empty[BLACK]);
+}
+
+AVX2_TARGET static void bishop_fill_avx2(const t_bitboard bishops[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+    attacks[WHITE] = bishop_lanes_avx2(bishops[WHITE], empty[WHITE]);
+    attacks[BLACK] = bishop_lanes_avx2(bishops[BLACK], empty[BLACK]);
+}
+
+#endif
+
+//-- Attacks of all the rooks of each color; "empty" is what each color's rooks can pass through
+void rook_fill(const t_bitboard rooks[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (fill_kernel == FILL_KERNEL_AVX2) {
+        rook_fill_avx2(rooks, empty, attacks);
+        return;
+    }
+    if (fill_kernel == FILL_KERNEL_SSE2) {
+        rook_fill_sse2(rooks, empty, attacks);
+        return;
+    }
+#endif
+    attacks[WHITE] = rook_fill_scalar(rooks[WHITE], empty[WHITE]);
+    attacks[BLACK] = rook_fill_scalar(rooks[BLACK], empty[BLACK]);
+}
+
+void bishop_fill(const t_bitboard bishops[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (fill_kernel == FILL_KERNEL_AVX2) {
+        bishop_fill_avx2(bishops, empty, attacks);
+        return;
+    }
+    if (fill_kernel == FILL_KERNEL_SSE2) {
+        bishop_fill_sse2(bishops, empty, attacks);
+        return;
+    }
+#endif
+    attacks[WHITE] = bishop_fill_scalar(bishops[WHITE], empty[WHITE]);
+    attacks[BLACK] = bishop_fill_scalar(bishops[BLACK], empty[BLACK]);
+}
+
+void queen_fill(const t_bitboard queens[2], const t_bitboard empty[2], t_bitboard attacks[2])
+{
+    t_bitboard diagonal[2];
+
+    rook_fill(queens, empty, attacks);
+    bishop_fill(queens, empty, diagonal);
+    attacks[WHITE] |= diagonal[WHITE];
+    attacks[BLACK] |= diagonal[BLACK];
+}
+
+//-- Every square "color" attacks with the given occupancy, sliders by the fills and pawns set-wise
+t_bitboard attack_map(struct t_board *board, t_chess_color color, t_bitboard occupied)
+{
+    t_bitboard sliders[2], empty[2], straight[2], diagonal[2];
+    t_bitboard pawns = board->pieces[color][PAWN];
+    t_bitboard attacks, b;
+
+    if (color == WHITE)
+        attacks = ((pawns << 7) & FILL_NOT_H) | ((pawns << 9) & FILL_NOT_A);
+    else
+        attacks = ((pawns >> 9) & FILL_NOT_H) | ((pawns >> 7) & FILL_NOT_A);
+
+    for (b = board->pieces[color][KNIGHT]; b;)
+        attacks |= knight_mask[bitscan_reset(&b)];
+    attacks |= king_mask[board->king_square[color]];
+
+    empty[WHITE] = empty[BLACK] = ~occupied;
+    sliders[color] = board->pieces[color][ROOK] | board->pieces[color][QUEEN];
+    sliders[OPPONENT(color)] = 0;
+    rook_fill(sliders, empty, straight);
+    sliders[color] = board->pieces[color][BISHOP] | board->pieces[color][QUEEN];
+    bishop_fill(sliders, empty, diagonal);
+
+    return attacks | straight[color] | diagonal[color];
+}
+
+//-- Best fill for this CPU: AVX2 follows the "Vector Eval" switch, SSE2 is always there on x86-64
+void select_fill_kernel()
+{
+#ifdef HAVE_AVX2_KERNELS
+    fill_kernel = (use_avx2 && avx2_kernels_available()) ? FILL_KERNEL_AVX2 : FILL_KERNEL_SSE2;
+#else
+    fill_kernel = FILL_KERNEL_SCALAR;
+#endif
+}
+
+const char *fill_kernel_name(int kernel)
+{
+    static const char *names[3] = { "scalar", "sse2", "avx2" };
+    return names[kernel];
+}
@@ -15,36 +15,59 @@
 #include "procs.h"
 #include "bittwiddle.h"
 
+//+-----------------------------------------------------------------+
+//| All the generators (apart from generate_evade_check) assume the |
+//| side to move is not in check. Every move they produce is legal, |
+//| so make_move never has to reject a move.                        |
+//+-----------------------------------------------------------------+
+
+//-- Does the move take a pinned piece off its pin ray?
+inline BOOL is_pin_broken(t_bitboard pinned, t_chess_square king_square, t_chess_square from_square, t_chess_square to_square) {
+    return ((SQUARE64(from_square) & pinned) && !(SQUARE64(to_square) & pin_ray(king_square, from_square)));
+}
+
+//-- Both the king's path squares must be safe
+inline BOOL is_castle_legal(struct t_board *board, int castle_index) {
+    t_bitboard b = castle[castle_index].not_attacked;
+    while (b) {
+        if (is_square_attacked(board, bitscan_reset(&b), OPPONENT(board->to_move)))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+//-- e.p. removes two pawns from the board at once, so test the king's lines with the new occupancy
+inline BOOL is_ep_legal(struct t_board *board, t_chess_square from_square, t_chess_square to_square) {
+
+    t_chess_color to_move = board->to_move;
+    t_chess_color opponent = OPPONENT(to_move);
+    t_chess_square king_square = board->king_square[to_move];
+    t_bitboard occupied = board->all_pieces ^ SQUARE64(from_square) ^ SQUARE64(to_square) ^ SQUARE64((to_square - 8) + (16 * to_move));
+
+    if (rook_attacks(king_square, occupied) & (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]))
+        return FALSE;
+    if (bishop_attacks(king_square, occupied) & (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]))
+        return FALSE;
+    return TRUE;
+}
+
 void generate_legal_moves(struct t_board *board, struct t_move_list *move_list)
 {
     if (board->in_check)
         generate_evade_check(board, move_list);
-    else {
-        struct t_move_list xmove_list[1];
-        struct t_undo undo[1];
-
-        generate_moves(board, xmove_list);
-        move_list->count = 0;
-        move_list->pinned_pieces = xmove_list->pinned_pieces;
-        for (int i = 0; i < xmove_list->count; i++)
-        {
-            if (make_move(board, xmove_list->pinned_pieces, xmove_list->move[i], undo)) {
-                move_list->move[move_list->count++] = xmove_list->move[i];
-                unmake_move(board, undo);
-            }
-        }
-    }
-    move_list->imove = move_list->count;
+    else
+        generate_moves(board, move_list);
 }
 
-void generate_moves(struct t_board *board, struct t_move_list *move_list) {
+//-- Compiled once per colour so the pawn directions, promotion ranks and castling records are constants
+template<t_chess_color to_move>
+inline void generate_moves(struct t_board *board, struct t_move_list *move_list) {
 
     t_bitboard _all_pieces = board->all_pieces;
 
-    struct t_move_record *move;
-    t_chess_color to_move = board->to_move;
-    t_chess_color opponent = OPPONENT(to_move);
+    const t_chess_color opponent = OPPONENT(to_move);
     t_bitboard not_occupied_to_move = ~board->occupied[to_move];
+    t_chess_square king_square = board->king_square[to_move];
 
     t_bitboard moves = 0;
     t_bitboard source_piece;
@@ -57,42 +80,24 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     t_chess_piece promote_to;
     t_chess_square from_square, to_square;
     int castle_index;
-    int forward;
-    int piece_color = (to_move * 8);
+    const int forward = 8 - 16 * to_move;					// direction of a pawn push
+    const int piece_color = (to_move * 8);
 
+    assert(board->to_move == to_move);
+    assert(!board->in_check);
     move_list->count = 0;
 
     //+---------------------------------+
     //| Find the Pinned Pieces          |
     //+---------------------------------+
-    t_bitboard pinner, pinned;
-    move_list->pinned_pieces = 0;
-    //-- Bishops & Queens
-	assert(to_move >= 0 && to_move < 2);
-	assert(board->king_square[to_move] >= 0 && board->king_square[to_move] < 64);
-	assert(board->pieces[WHITE] == board->piecelist);
-	assert(board->pieces[BLACK] == board->piecelist + 8);
-    t_bitboard b = bishop_rays[board->king_square[to_move]] & (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
-    //--Rooks & Queens
-    b = rook_rays[board->king_square[to_move]] & (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
+    t_bitboard pinned = get_check_info(board)->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //+---------------------------------+
     //| Castling Moves                  |
     //+---------------------------------+
 
-    if (board->castling && !board->in_check) {
+    if (board->castling) {
         if (board->chess960) {
 
         }
@@ -100,16 +105,14 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
             //-- Kingside O-O
             castle_index = (to_move * 2);
             if ((board->castling >> castle_index) & (uchar)1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
             //-- Queenside O-O-O
             castle_index++;
             if ((board->castling >> castle_index) & (uchar)1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
@@ -119,8 +122,6 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     //+---------------------------------+
     //| Pawn Moves                      |
     //+---------------------------------+
-    // find the direction of a pawn push
-    forward = 8 - 16 * to_move;
     piece = PAWN + piece_color;
     // All pawn pushes
     moves = (((board->piecelist[piece] << 8) >> (16 * to_move)) & ~(_all_pieces));
@@ -134,69 +135,93 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward;
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Double Moves
     double_push = (((double_push << 8) >> (16 * to_move)) & ~(_all_pieces));
     while (double_push) {
         to_square = bitscan_reset(&double_push);
         from_square = to_square - (forward * 2);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Pawn promotions
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         for (promote_to = 0; promote_to <= 3; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + promote_to;
     }
     // Pawn captures
-    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     moves ^= pawn_promotions;
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + PIECETYPE(captured);
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + PIECETYPE(captured);
     }
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 3; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
     }
     // Other direction
-    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     moves ^= pawn_promotions;
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + PIECETYPE(captured);
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + PIECETYPE(captured);
     }
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 3; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
+    }
+    // En-passant
+    if (board->ep_square) {
+        to_square = bitscan(board->ep_square);
+        source_piece = pawn_attackers[to_move][to_square] & board->piecelist[piece];
+        while (source_piece) {
+            from_square = bitscan_reset(&source_piece);
+            if (is_ep_legal(board, from_square, to_square))
+                move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
+        }
     }
 
     //+---------------------------------+
     //| Knight Moves                    |
     //+---------------------------------+
     piece = KNIGHT + piece_color;
-    source_piece = board->piecelist[piece];
+    source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
         moves = (knight_mask[from_square] & not_occupied_to_move);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -204,12 +229,14 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     //| King Moves                      |
     //+---------------------------------+
     piece = KING + piece_color;
-    from_square = board->king_square[to_move];
+    from_square = king_square;
     moves = (king_mask[from_square] & not_occupied_to_move);
     while (moves) {
         to_square = bitscan_reset(&moves);
+        if (is_square_attacked(board, to_square, opponent))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
     }
 
     //+---------------------------------+
@@ -219,12 +246,14 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -235,12 +264,14 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -251,25 +282,36 @@ void generate_moves(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
     //-- Set the move index to the count
     move_list->imove = move_list->count;
 }
 
+void generate_moves(struct t_board *board, struct t_move_list *move_list) {
+    if (board->to_move == WHITE)
+        generate_moves<WHITE>(board, move_list);
+    else
+        generate_moves<BLACK>(board, move_list);
+}
+
 //---------------------------------------------------------------------------------//
 // Generates "obvious" check - no castling, en-passant, discovered or promotions
 //---------------------------------------------------------------------------------//
@@ -278,8 +320,8 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     t_bitboard _all_pieces = board->all_pieces;
 
     t_chess_color to_move = board->to_move;
-    t_chess_color opponent = OPPONENT(to_move);
     t_bitboard not_occupied_to_move = ~board->occupied[to_move];
+    t_chess_square king_square = board->king_square[to_move];
 
     t_bitboard moves = 0;
     t_bitboard source_piece;
@@ -294,11 +336,13 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     //+------------------------------------------------------+
     //| Calculate check_rays - squares which will give check |
     //+------------------------------------------------------+
-    from_square = board->king_square[opponent];
-    t_bitboard bishop_check_rays = ~_all_pieces & bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
-    t_bitboard rook_check_rays = ~_all_pieces & rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+    struct t_check_info *info = get_check_info(board);
+    t_bitboard bishop_check_rays = ~_all_pieces & info->check_squares[BISHOP];
+    t_bitboard rook_check_rays = ~_all_pieces & info->check_squares[ROOK];
     t_bitboard queen_check_rays = rook_check_rays | bishop_check_rays;
 
+    assert(!board->in_check);
+
     //--DOES NOT ZERO THE MOVE LIST!!
     //move_list->count = 0;
 
@@ -306,7 +350,8 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     //| Find the Pinned Pieces          |
     //+---------------------------------+
 
-    //--ASSUME PINNED PIECES HAVE ALREADY BEEN CALCULATED!!
+    t_bitboard pinned = info->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //+---------------------------------+
     //| Castling Moves                  |
@@ -321,7 +366,7 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     forward = 8 - 16 * to_move;
     piece = PAWN + piece_color;
     // All pawn pushes
-    moves = ((pawn_attackers[to_move][board->king_square[opponent]] & ~_all_pieces) >> 8) << (16 * to_move);
+    moves = ((info->check_squares[PAWN] & ~_all_pieces) >> 8) << (16 * to_move);
     double_push = moves & ~_all_pieces & rank_mask[to_move][THIRD_RANK];
     double_push = ((double_push >> 8) << (16 * to_move)) & board->piecelist[piece];
     moves &= board->piecelist[piece];
@@ -330,27 +375,31 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     while (moves) {
         from_square = bitscan_reset(&moves);
         to_square = from_square + forward;
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Double Moves
     while (double_push) {
         from_square = bitscan_reset(&double_push);
         to_square = from_square + (forward * 2);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
 
     //+---------------------------------+
     //| Knight Moves                    |
     //+---------------------------------+
-    t_bitboard knight_check_rays = knight_mask[board->king_square[opponent]] & ~_all_pieces;
+    t_bitboard knight_check_rays = info->check_squares[KNIGHT] & ~_all_pieces;
     piece = KNIGHT + piece_color;
-    source_piece = board->piecelist[piece];
+    source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
         moves = (knight_mask[from_square] & not_occupied_to_move) & knight_check_rays;
         while (moves) {
             to_square = bitscan_reset(&moves);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
     }
 
@@ -367,11 +416,13 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move & rook_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
     }
 
@@ -382,11 +433,13 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move & bishop_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
     }
 
@@ -397,30 +450,34 @@ void generate_quiet_checks(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move & queen_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= not_occupied_to_move & queen_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
     }
     //-- Set the move index to the count
     move_list->imove = move_list->count;
 }
 
-void generate_captures(struct t_board *board, struct t_move_list *move_list) {
+template<t_chess_color to_move>
+inline void generate_captures(struct t_board *board, struct t_move_list *move_list) {
 
     t_bitboard _all_pieces = board->all_pieces;
 
-    t_chess_color to_move = board->to_move;
-    t_chess_color opponent = OPPONENT(to_move);
-    t_bitboard not_occupied_to_move = ~board->occupied[to_move];
+    const t_chess_color opponent = OPPONENT(to_move);
+    t_chess_square king_square = board->king_square[to_move];
 
     t_bitboard moves = 0;
     t_bitboard source_piece;
@@ -430,38 +487,22 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     t_chess_piece piece;
     t_chess_piece captured;
     t_chess_square from_square, to_square;
-    int forward;
-    int piece_color = (to_move * 8);
+    const int forward = 8 - 16 * to_move;					// direction of a pawn push
+    const int piece_color = (to_move * 8);
 
+    assert(board->to_move == to_move);
+    assert(!board->in_check);
     move_list->count = 0;
 
     //+---------------------------------+
     //| Find the Pinned Pieces          |
     //+---------------------------------+
-    t_bitboard pinner, pinned;
-    move_list->pinned_pieces = 0;
-    //-- Bishops & Queens
-    t_bitboard b = bishop_rays[board->king_square[to_move]] & (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
-    //--Rooks & Queens
-    b = rook_rays[board->king_square[to_move]] & (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
+    t_bitboard pinned = get_check_info(board)->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //+---------------------------------+
     //| Pawn Moves                      |
     //+---------------------------------+
-    // find the direction of a pawn push
-    forward = 8 - 16 * to_move;
     piece = PAWN + piece_color;
     // All pawn pushes
     moves = (((board->piecelist[piece] << 8) >> (16 * to_move)) & ~(_all_pieces));
@@ -473,53 +514,73 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward;
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + 3;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + 3;
     }
     // Pawn captures
-    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     moves ^= pawn_promotions;
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + PIECETYPE(captured);
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + PIECETYPE(captured);
     }
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + 3;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + 3;
     }
     // Other direction
-    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     moves ^= pawn_promotions;
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + PIECETYPE(captured);
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + PIECETYPE(captured);
     }
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + 3;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + 3;
+    }
+    // En-passant
+    if (board->ep_square) {
+        to_square = bitscan(board->ep_square);
+        source_piece = pawn_attackers[to_move][to_square] & board->piecelist[piece];
+        while (source_piece) {
+            from_square = bitscan_reset(&source_piece);
+            if (is_ep_legal(board, from_square, to_square))
+                move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
+        }
     }
 
     //+---------------------------------+
     //| Knight Moves                    |
     //+---------------------------------+
     piece = KNIGHT + piece_color;
-    source_piece = board->piecelist[piece];
+    source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
         moves = (knight_mask[from_square] & board->occupied[opponent]);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -527,12 +588,14 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     //| King Moves                      |
     //+---------------------------------+
     piece = KING + piece_color;
-    from_square = board->king_square[to_move];
+    from_square = king_square;
     moves = (king_mask[from_square] & board->occupied[opponent]);
     while (moves) {
         to_square = bitscan_reset(&moves);
+        if (is_square_attacked(board, to_square, opponent))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
     }
 
     //+---------------------------------+
@@ -542,12 +605,14 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= board->occupied[opponent];
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -558,12 +623,14 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= board->occupied[opponent];
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -574,28 +641,38 @@ void generate_captures(struct t_board *board, struct t_move_list *move_list) {
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= board->occupied[opponent];
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= board->occupied[opponent];
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
     //-- Set the move index to the count
     move_list->imove = move_list->count;
 }
 
+void generate_captures(struct t_board *board, struct t_move_list *move_list) {
+    if (board->to_move == WHITE)
+        generate_captures<WHITE>(board, move_list);
+    else
+        generate_captures<BLACK>(board, move_list);
+}
+
 void generate_evade_check(struct t_board *board, struct t_move_list *move_list) {
 
-    t_bitboard _all_pieces = board->all_pieces;
     t_chess_piece piece, captured, promote_to;
     t_chess_square from_square, to_square;
     t_bitboard moves;
@@ -614,15 +691,26 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
     piece = KING + piece_color;
     from_square = board->king_square[to_move];
     moves = (king_mask[from_square] & ~board->occupied[to_move]);
-    board->all_pieces ^= board->pieces[to_move][KING];
-    while (moves) {
-        to_square = bitscan_reset(&moves);
-        if (!is_square_attacked(board, to_square, opponent)) {
+    if (use_fill_evasions) {
+        //-- One map of the opponent's attacks, through the king's square
+        moves &= ~attack_map(board, opponent, board->all_pieces ^ board->pieces[to_move][KING]);
+        while (moves) {
+            to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
+        }
+    }
+    else {
+        board->all_pieces ^= board->pieces[to_move][KING];
+        while (moves) {
+            to_square = bitscan_reset(&moves);
+            if (!is_square_attacked(board, to_square, opponent)) {
+                captured = PIECETYPE(board->square[to_square]);
+                move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
+            }
         }
+        board->all_pieces ^= board->pieces[to_move][KING];
     }
-    board->all_pieces ^= board->pieces[to_move][KING];
 
     // if Double Check then exit!
     if (board->in_check > 1) {
@@ -633,25 +721,8 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
     //+---------------------------------+
     //| Find the Pinned Pieces          |
     //+---------------------------------+
-    t_bitboard pinner, pinned;
-    move_list->pinned_pieces = 0;
-    //-- Bishops & Queens
-    t_bitboard b = bishop_rays[board->king_square[to_move]] & (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
-    //--Rooks & Queens
-    b = rook_rays[board->king_square[to_move]] & (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-    while (b) {
-        pinner = bitscan_reset(&b);
-        pinned = between[board->king_square[to_move]][pinner] & _all_pieces;
-        if (popcount(pinned) == 1)
-            move_list->pinned_pieces |= (pinned & board->occupied[to_move]);
-    }
-    pinned = move_list->pinned_pieces;
+    t_bitboard pinned = get_check_info(board)->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //-- PAWN Moves
     piece = PAWN + piece_color;
@@ -666,14 +737,14 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
         assert(captured != BLANK);
         assert(COLOR(captured) == opponent);
         from_square = bitscan_reset(&moves);
-        move_list->move[move_list->count++] = move_directory[from_square][board->check_attacker][piece] + PIECETYPE(captured);
+        move_list->move[move_list->count++] = directory_move(from_square, board->check_attacker, piece) + PIECETYPE(captured);
     }
     while (pawn_promotions) {
         from_square = bitscan_reset(&pawn_promotions);
         to_square = board->check_attacker;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 3; promote_to++) {
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
         }
     }
 
@@ -687,7 +758,7 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
                 board->all_pieces ^= (SQUARE64(from_square) | SQUARE64((to_square - 8) + (16 * to_move)));
                 board->pieces[opponent][PAWN] ^= SQUARE64(board->check_attacker);
                 if (!is_square_attacked(board, board->king_square[to_move], opponent))
-                    move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+                    move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
                 board->all_pieces ^= (SQUARE64(from_square) | SQUARE64((to_square - 8) + (16 * to_move)));
                 board->pieces[opponent][PAWN] ^= SQUARE64(board->check_attacker);
             } while (moves);
@@ -713,21 +784,21 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
         while (moves) {
             to_square = bitscan_reset(&moves);
             from_square = to_square - 8 + 16 * to_move;
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
         // Double Moves
         double_push = (((double_push << 8) >> (16 * to_move)) & interpose);
         while (double_push) {
             to_square = bitscan_reset(&double_push);
             from_square = to_square - 16  + 32 * to_move;
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
         }
         // Pawn promotions
         while (pawn_promotions) {
             to_square = bitscan_reset(&pawn_promotions);
             from_square = to_square - 8  + 16 * to_move;
             for (promote_to = 0; promote_to <= 3; promote_to++) {
-                move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + promote_to;
+                move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + promote_to;
             }
         }
     }
@@ -746,7 +817,7 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
         while (moves) {
             to_square = bitscan(moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
             moves &= (moves - 1);
         }
         source_piece &= (source_piece - 1);
@@ -759,12 +830,12 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan(source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & board->all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, board->all_pieces);
         moves &= (~board->occupied[to_move] & interpose);
         while (moves) {
             to_square = bitscan(moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
             moves &= (moves - 1);
         }
         source_piece &= (source_piece - 1);
@@ -777,12 +848,12 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan(source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & board->all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, board->all_pieces);
         moves &= (~board->occupied[to_move] & interpose);
         while (moves) {
             to_square = bitscan(moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
             moves &= (moves - 1);
         }
         source_piece &= (source_piece - 1);
@@ -795,20 +866,20 @@ void generate_evade_check(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan(source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & board->all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, board->all_pieces);
         moves &= (~board->occupied[to_move] & interpose);
         while (moves) {
             to_square = bitscan(moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
             moves &= (moves - 1);
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & board->all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, board->all_pieces);
         moves &= (~board->occupied[to_move] & interpose);
         while (moves) {
             to_square = bitscan(moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
             moves &= (moves - 1);
         }
         source_piece &= (source_piece - 1);
@@ -821,10 +892,9 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
 
     t_bitboard _all_pieces = board->all_pieces;
 
-    struct t_move_record *move;
     t_chess_color to_move = board->to_move;
     t_chess_color opponent = OPPONENT(to_move);
-    t_bitboard not_occupied_to_move = ~board->occupied[to_move];
+    t_chess_square king_square = board->king_square[to_move];
 
     t_bitboard moves = 0;
     t_bitboard source_piece;
@@ -840,20 +910,23 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     int forward;
     int piece_color = (to_move * 8);
 
+    assert(!board->in_check);
+
     //+---------------------------------+
     //| Find the Pinned Pieces          |
     //+---------------------------------+
 
-    //-- ASSUME ALREADY CALCULATED
+    struct t_check_info *info = get_check_info(board);
+    t_bitboard pinned = info->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //+------------------------------------------------------+
     //| Calculate check_rays - squares which will give check |
     //+------------------------------------------------------+
-    from_square = board->king_square[opponent];
-    t_bitboard bishop_check_rays = ~_all_pieces & bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
-    t_bitboard rook_check_rays = ~_all_pieces & rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+    t_bitboard bishop_check_rays = ~_all_pieces & info->check_squares[BISHOP];
+    t_bitboard rook_check_rays = ~_all_pieces & info->check_squares[ROOK];
     t_bitboard queen_check_rays = bishop_check_rays | rook_check_rays;
-    t_bitboard knight_check_rays = knight_mask[board->king_square[opponent]] & ~_all_pieces;
+    t_bitboard knight_check_rays = info->check_squares[KNIGHT] & ~_all_pieces;
 
     bishop_check_rays = ~bishop_check_rays;
     rook_check_rays = ~rook_check_rays;
@@ -864,7 +937,7 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     //| Castling Moves                  |
     //+---------------------------------+
 
-    if (board->castling && !board->in_check) {
+    if (board->castling) {
         if (board->chess960) {
 
         }
@@ -872,16 +945,14 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
             //-- Kingside O-O
             castle_index = (to_move * 2);
             if ((board->castling >> castle_index) & (uchar)1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
             //-- Queenside O-O-O
             castle_index++;
             if ((board->castling >> castle_index) & (uchar)1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
@@ -902,60 +973,70 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     moves ^= pawn_promotions;
     // Double moves
     double_push = (moves & rank_mask[to_move][THIRD_RANK]);
-    moves &= ~pawn_attackers[to_move][board->king_square[opponent]];
+    moves &= ~info->check_squares[PAWN];
     // Spool the moves to the move list
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward;
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Double Moves
     double_push = (((double_push << 8) >> (16 * to_move)) & ~(_all_pieces));
-    double_push &= ~pawn_attackers[to_move][board->king_square[opponent]];
+    double_push &= ~info->check_squares[PAWN];
     while (double_push) {
         to_square = bitscan_reset(&double_push);
         from_square = to_square - (forward * 2);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Pawn promotions
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + promote_to;
     }
-    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
     }
     // Other direction
-    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
     }
 
     //+---------------------------------+
     //| Knight Moves                    |
     //+---------------------------------+
     piece = KNIGHT + piece_color;
-    source_piece = board->piecelist[piece];
+    source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
         moves = (knight_mask[from_square] & ~_all_pieces & knight_check_rays);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -963,12 +1044,14 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     //| King Moves                      |
     //+---------------------------------+
     piece = KING + piece_color;
-    from_square = board->king_square[to_move];
+    from_square = king_square;
     moves = (king_mask[from_square] & ~_all_pieces);
     while (moves) {
         to_square = bitscan_reset(&moves);
+        if (is_square_attacked(board, to_square, opponent))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
     }
 
     //+---------------------------------+
@@ -978,12 +1061,14 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces & rook_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -994,12 +1079,14 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces & bishop_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -1010,19 +1097,23 @@ void generate_no_capture_no_checks(struct t_board *board, struct t_move_list *mo
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces & queen_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces & queen_check_rays;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
     //-- Set the move index to the count
@@ -1033,10 +1124,9 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
 
     t_bitboard _all_pieces = board->all_pieces;
 
-    struct t_move_record *move;
     t_chess_color to_move = board->to_move;
     t_chess_color opponent = OPPONENT(to_move);
-    t_bitboard not_occupied_to_move = ~board->occupied[to_move];
+    t_chess_square king_square = board->king_square[to_move];
 
     t_bitboard moves = 0;
     t_bitboard source_piece;
@@ -1052,17 +1142,20 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     int forward;
     int piece_color = (to_move * 8);
 
+    assert(!board->in_check);
+
     //+---------------------------------+
     //| Find the Pinned Pieces          |
     //+---------------------------------+
 
-    //-- ASSUME ALREADY CALCULATED
+    t_bitboard pinned = get_check_info(board)->pinned[to_move];
+    move_list->pinned_pieces = pinned;
 
     //+---------------------------------+
     //| Castling Moves                  |
     //+---------------------------------+
 
-    if (board->castling && !board->in_check) {
+    if (board->castling) {
         if (board->chess960) {
 
         }
@@ -1070,16 +1163,14 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
             //-- Kingside O-O
             castle_index = (to_move * 2);
             if ((board->castling >> castle_index) & (uchar) 1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
             //-- Queenside O-O-O
             castle_index++;
             if ((board->castling >> castle_index) & (uchar) 1) {
-                move = &xmove_list[castle_index];
-                if (!(_all_pieces & castle[castle_index].possible)) {
+                if (!(_all_pieces & castle[castle_index].possible) && is_castle_legal(board, castle_index)) {
                     move_list->move[move_list->count++] = &xmove_list[castle_index];
                 }
             }
@@ -1104,54 +1195,64 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     while (moves) {
         to_square = bitscan_reset(&moves);
         from_square = to_square - forward;
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Double Moves
     double_push = (((double_push << 8) >> (16 * to_move)) & ~(_all_pieces));
     while (double_push) {
         to_square = bitscan_reset(&double_push);
         from_square = to_square - (forward * 2);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece];
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece);
     }
     // Pawn promotions
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + promote_to;
     }
-    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & B8H1) << 7) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward + 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
     }
     // Other direction
-    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & (board->occupied[opponent] | board->ep_square);
+    moves = (((board->piecelist[piece] & A8G1) << 9) >> (16 * to_move)) & board->occupied[opponent];
     pawn_promotions = (moves & rank_mask[to_move][EIGHTH_RANK]);
     while (pawn_promotions) {
         to_square = bitscan_reset(&pawn_promotions);
         from_square = to_square - forward - 1;
+        if (is_pin_broken(pinned, king_square, from_square, to_square))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
         for (promote_to = 0; promote_to <= 2; promote_to++)
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + (4 * captured) + promote_to;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + (4 * captured) + promote_to;
     }
 
     //+---------------------------------+
     //| Knight Moves                    |
     //+---------------------------------+
     piece = KNIGHT + piece_color;
-    source_piece = board->piecelist[piece];
+    source_piece = board->piecelist[piece] & ~pinned;
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
         moves = (knight_mask[from_square] & ~_all_pieces);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -1159,12 +1260,14 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     //| King Moves                      |
     //+---------------------------------+
     piece = KING + piece_color;
-    from_square = board->king_square[to_move];
+    from_square = king_square;
     moves = (king_mask[from_square] & ~_all_pieces);
     while (moves) {
         to_square = bitscan_reset(&moves);
+        if (is_square_attacked(board, to_square, opponent))
+            continue;
         captured = PIECETYPE(board->square[to_square]);
-        move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+        move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
     }
 
     //+---------------------------------+
@@ -1174,12 +1277,14 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -1190,12 +1295,14 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
 
@@ -1206,19 +1313,23 @@ void generate_quiet_moves(struct t_board *board, struct t_move_list *move_list)
     source_piece = board->piecelist[piece];
     while (source_piece) {
         from_square = bitscan_reset(&source_piece);
-        moves = rook_magic_moves[from_square][((rook_magic[from_square].mask & _all_pieces) * rook_magic[from_square].magic) >> 52];
+        moves = rook_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
-        moves = bishop_magic_moves[from_square][((bishop_magic[from_square].mask & _all_pieces) * bishop_magic[from_square].magic) >> 55];
+        moves = bishop_attacks(from_square, _all_pieces);
         moves &= ~_all_pieces;
+        if (SQUARE64(from_square) & pinned)
+            moves &= pin_ray(king_square, from_square);
         while (moves) {
             to_square = bitscan_reset(&moves);
             captured = PIECETYPE(board->square[to_square]);
-            move_list->move[move_list->count++] = move_directory[from_square][to_square][piece] + captured;
+            move_list->move[move_list->count++] = directory_move(from_square, to_square, piece) + captured;
         }
     }
     //-- Set the move index to the count
@@ -0,0 +1,165 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//-- Position states during generation; a position's value is the "or" of its successors
+#define KPK_INVALID					0
+#define KPK_UNKNOWN					1
+#define KPK_DRAW					2
+#define KPK_WIN						4
+
+//-- White has the pawn, which is on files a-d
+static inline int kpk_index(t_chess_color to_move, t_chess_square wk, t_chess_square bk, t_chess_square pawn)
+{
+	return to_move + (bk << 1) + (wk << 7) + (COLUMN(pawn) << 13) + ((6 - RANK(pawn)) << 15);
+}
+
+static inline t_bitboard white_pawn_attacks(t_chess_square pawn)
+{
+	t_bitboard p = SQUARE64(pawn);
+	return ((p & B8H1) << 7) | ((p & A8G1) << 9);
+}
+
+//-- The state of a position before any moves are looked at
+static uchar kpk_initial(int index)
+{
+	t_chess_color to_move = index & 1;
+	t_chess_square bk = (index >> 1) & 63;
+	t_chess_square wk = (index >> 7) & 63;
+	t_chess_square pawn = ((6 - (index >> 15)) << 3) + ((index >> 13) & 3);
+	t_chess_square promotion = pawn + 8;
+
+	//-- Kings touching, a king on the pawn, or black in check with white to move
+	if ((king_mask[wk] & SQUARE64(bk)) || wk == bk || wk == pawn || bk == pawn)
+		return KPK_INVALID;
+	if (to_move == WHITE && (white_pawn_attacks(pawn) & SQUARE64(bk)))
+		return KPK_INVALID;
+
+	//-- White promotes and the queen can't be taken straight away
+	if (to_move == WHITE && RANK(pawn) == 6 && wk != promotion && bk != promotion
+		&& (!(king_mask[bk] & SQUARE64(promotion)) || (king_mask[wk] & SQUARE64(promotion))))
+		return KPK_WIN;
+
+	if (to_move == BLACK) {
+		//-- Stalemate
+		if (!(king_mask[bk] & ~(king_mask[wk] | white_pawn_attacks(pawn))))
+			return KPK_DRAW;
+
+		//-- Black takes an undefended pawn
+		if ((king_mask[bk] & SQUARE64(pawn)) && !(king_mask[wk] & SQUARE64(pawn)))
+			return KPK_DRAW;
+	}
+
+	return KPK_UNKNOWN;
+}
+
+//-- Look one move ahead: white wants any winning move, black any drawing one
+static uchar kpk_classify(uchar *db, int index)
+{
+	t_chess_color to_move = index & 1;
+	t_chess_square bk = (index >> 1) & 63;
+	t_chess_square wk = (index >> 7) & 63;
+	t_chess_square pawn = ((6 - (index >> 15)) << 3) + ((index >> 13) & 3);
+	uchar good = (to_move == WHITE ? KPK_WIN : KPK_DRAW);
+	uchar bad = (to_move == WHITE ? KPK_DRAW : KPK_WIN);
+	uchar r = KPK_INVALID;
+	t_bitboard b;
+
+	if (to_move == WHITE) {
+		b = king_mask[wk];
+		while (b)
+			r |= db[kpk_index(BLACK, bitscan_reset(&b), bk, pawn)];
+
+		if (RANK(pawn) < 6)
+			r |= db[kpk_index(BLACK, wk, bk, pawn + 8)];
+
+		if (RANK(pawn) == 1 && pawn + 8 != wk && pawn + 8 != bk)
+			r |= db[kpk_index(BLACK, wk, bk, pawn + 16)];
+	}
+	else {
+		b = king_mask[bk];
+		while (b)
+			r |= db[kpk_index(WHITE, wk, bitscan_reset(&b), pawn)];
+	}
+
+	if (r & good)
+		return good;
+	if (r & KPK_UNKNOWN)
+		return KPK_UNKNOWN;
+	return bad;
+}
+
+//-- Retrograde generation: repeat until no unknown position can be settled, the rest are draws
+void init_kpk()
+{
+	uchar *db = (uchar *)malloc(KPK_SIZE);
+	assert(db);
+	BOOL changed;
+	int i;
+
+	for (i = 0; i < KPK_SIZE; i++)
+		db[i] = kpk_initial(i);
+
+	do {
+		changed = FALSE;
+		for (i = 0; i < KPK_SIZE; i++) {
+			if (db[i] == KPK_UNKNOWN && (db[i] = kpk_classify(db, i)) != KPK_UNKNOWN)
+				changed = TRUE;
+		}
+	} while (changed);
+
+	memset(kpk_bitbase, 0, sizeof(kpk_bitbase));
+	for (i = 0; i < KPK_SIZE; i++) {
+		if (db[i] == KPK_WIN)
+			kpk_bitbase[i >> 5] |= (1u << (i & 31));
+	}
+
+	free(db);
+}
+
+//-- Does the side with the pawn win?  Squares are given as if white had the pawn
+BOOL kpk_win(t_chess_color to_move, t_chess_square wk, t_chess_square bk, t_chess_square pawn)
+{
+	if (COLUMN(pawn) > 3) {
+		wk ^= 7;
+		bk ^= 7;
+		pawn ^= 7;
+	}
+	int index = kpk_index(to_move, wk, bk, pawn);
+	return (kpk_bitbase[index >> 5] >> (index & 31)) & 1;
+}
+
+//-- Exact score of a king + pawn vs. king position for the side to move
+t_chess_value kpk_score(struct t_board *board)
+{
+	t_chess_color strong = (board->piecelist[WHITEPAWN] ? WHITE : BLACK);
+	t_chess_square pawn = bitscan(board->pieces[strong][PAWN]);
+	t_chess_square wk = board->king_square[strong];
+	t_chess_square bk = board->king_square[OPPONENT(strong)];
+
+	if (strong == BLACK) {
+		pawn = FLIP64(pawn);
+		wk = FLIP64(wk);
+		bk = FLIP64(bk);
+	}
+
+	if (!kpk_win(board->to_move == strong ? WHITE : BLACK, wk, bk, pawn))
+		return 0;
+
+	t_chess_value score = KPK_WIN_SCORE + KPK_PAWN_RANK_BONUS * RANK(pawn);
+	return (board->to_move == strong ? score : -score);
+}
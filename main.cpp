@@ -36,7 +36,9 @@ int main(int argc, char *argv[])
     listen_for_uci_input();
 
     destroy_pawn_hash();
-	destroy_material_hash();
+    destroy_eval_hash();
+    nnue_unload();
+	destroy_material_index();
 	destroy_hash();
 
     close_book();
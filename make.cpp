@@ -38,53 +38,11 @@ inline BOOL is_in_check_after_move(struct t_board *board, struct t_move_record *
             return is_square_attacked(board, move->to_square, opponent);
     }
     else {
-        b = xray[king_square][move->from_square];
-        if (b) {
-            t_bitboard attacker;
-            board->all_pieces ^= move->from_to_bitboard ^ move->capture_mask;
-            //-- Bishop
-            attacker = (b & bishop_rays[king_square] & ~move->capture_mask);
-            if (attacker) {
-                attacker &= (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-                while (attacker) {
-                    s = bitscan_reset(&attacker);
-                    if ((between[king_square][s] & board->all_pieces) == 0) {
-                        board->all_pieces ^= move->from_to_bitboard ^ move->capture_mask;
-                        return TRUE;
-                    }
-                }
-            }
-            //-- Rooks
-            attacker = (b & rook_rays[king_square] & ~move->capture_mask);
-            if (attacker) {
-                attacker &= (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-                while (attacker) {
-                    s = bitscan_reset(&attacker);
-                    if ((between[king_square][s] & board->all_pieces) == 0) {
-                        board->all_pieces ^= move->from_to_bitboard ^ move->capture_mask;
-                        return TRUE;
-                    }
-                }
-            }
-            //-- e.p. (rare case)
-            if (move->move_type == MOVE_PxP_EP) {
-                board->all_pieces ^= ((SQUARE64(move->to_square) >> 8) << (16 * to_move));
-                attacker = (b & rook_rays[king_square]);
-                if (attacker) {
-                    attacker &= (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-                    while (attacker) {
-                        s = bitscan_reset(&attacker);
-                        if ((between[king_square][s] & board->all_pieces) == 0) {
-                            board->all_pieces ^= ((SQUARE64(move->to_square) >> 8) << (16 * to_move));
-                            board->all_pieces ^= move->from_to_bitboard ^ move->capture_mask;
-                            return TRUE;
-                        }
-                    }
-                }
-                board->all_pieces ^= ((SQUARE64(move->to_square) >> 8) << (16 * to_move));
-            }
-            board->all_pieces ^= move->from_to_bitboard ^ move->capture_mask;
-        }
+        //-- Occupancy after the move; the captured piece can no longer attack
+        b = board->all_pieces ^ move->from_to_bitboard ^ move->capture_mask;
+        if (move->move_type == MOVE_PxP_EP)
+            b ^= ((SQUARE64(move->to_square) >> 8) << (16 * to_move));
+        return (attackers_to(board, king_square, b) & board->occupied[opponent] & b & ~SQUARE64(move->to_square)) != 0;
     }
     return FALSE;
 }
@@ -96,6 +54,7 @@ void make_null_move(struct t_board *board, struct t_undo *undo){
 	undo->fifty_move_count = board->fifty_move_count;
 	undo->hash = board->hash;
 	undo->pawn_hash = board->pawn_hash;
+	undo->null_move_draw_stack_count = null_move_draw_stack_count;
 
 	//-- Make the necessary changes
 	board->to_move = OPPONENT(board->to_move);
@@ -107,6 +66,7 @@ void make_null_move(struct t_board *board, struct t_undo *undo){
 	}
 	board->fifty_move_count++;
 	draw_stack[++draw_stack_count] = board->hash;
+	null_move_draw_stack_count = draw_stack_count;
 }
 
 void unmake_null_move(struct t_board *board, struct t_undo *undo){
@@ -118,54 +78,52 @@ void unmake_null_move(struct t_board *board, struct t_undo *undo){
 	board->pawn_hash = undo->pawn_hash;
 	board->to_move = OPPONENT(board->to_move);
 	draw_stack_count--;
+	null_move_draw_stack_count = undo->null_move_draw_stack_count;
 }
 
-BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *move, struct t_undo *undo) {
+//-- Check flag for an ordinary move, from the check info of the position before it.
+//-- Castling, e.p. and promotions change more than one line so they use update_in_check.
+inline void set_in_check(struct t_board *board, struct t_check_info *info, t_chess_piece piece, t_chess_square from, t_chess_square to, t_chess_color color) {
+
+    t_chess_square king_square = board->king_square[color];
+
+    board->in_check = 0;
+
+    //-- Direct check
+    if (info->check_squares[PIECETYPE(piece)] & SQUARE64(to)) {
+        board->in_check = 1;
+        board->check_attacker = to;
+    }
+
+    //-- Discovered check, unless the piece stays on the line
+    if ((info->discovered & SQUARE64(from)) && !(pin_ray(king_square, from) & SQUARE64(to))) {
+        board->in_check++;
+        board->check_attacker = bitscan(xray[king_square][from] & info->pinners[color]);
+    }
+}
 
-    t_chess_color			color				= board->to_move;
-    t_chess_color			opponent			= OPPONENT(color);
+//-- Compiled once per colour (see the dispatchers below)
+template<t_chess_color color>
+inline void make_move(struct t_board *board, struct t_move_record *move, struct t_undo *undo) {
+
+    const t_chess_color		opponent			= OPPONENT(color);
     t_chess_square			from				= move->from_square;
     t_chess_square			to					= move->to_square;
     t_chess_piece			piece				= move->piece;
     t_chess_piece			captured			= move->captured;
     t_chess_square			ep_capture;
-    struct t_castle_record	*castle_move;
+    const struct t_castle_record	*castle_move;
 
     assert(move->captured != WHITEKING && move->captured != BLACKKING);
+    assert(board->to_move == color);
 	assert(integrity(board));
 
-    if (!board->in_check) {
-        switch (move->move_type) {
-        case MOVE_CASTLE:
-            if (is_in_check_after_move(board, move))
-                return FALSE;
-            break;
-        case MOVE_PxP_EP:
-            if (is_in_check_after_move(board, move))
-                return FALSE;
-            break;
-        case MOVE_KING_MOVE:
-            if (is_in_check_after_move(board, move))
-                return FALSE;
-            break;
-        case MOVE_KINGxPIECE:
-            if (is_in_check_after_move(board, move))
-                return FALSE;
-            break;
-        case MOVE_KINGxPAWN:
-            if (is_in_check_after_move(board, move))
-                return FALSE;
-            break;
-        default:
-            if (SQUARE64(move->from_square) & pinned) {
-                if (is_in_check_after_move(board, move))
-                    return FALSE;
-            }
-            else
-                assert(!is_in_check_after_move(board, move));
-            break;
-        }
-    }
+    //-- The move generators only produce legal moves
+    assert(board->in_check || !is_in_check_after_move(board, move));
+
+    //-- Pins and check squares of the position before the move
+    struct t_check_info *info = get_check_info(board);
+
     //-- Write whole tree to file
     //write_tree(board, move, TRUE, "tree.txt");
 
@@ -178,7 +136,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
     undo->move						= move;
     undo->hash						= board->hash;
     undo->pawn_hash					= board->pawn_hash;
-	undo->material_hash				= board->material_hash;
+	undo->material_index			= board->material_index;
 
     // Move on board
     board->square[from] = BLANK;
@@ -193,6 +151,10 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
     if (board->ep_square)
         board->hash ^= ep_hash[COLUMN(bitscan(board->ep_square))];
 
+    // Update material + piece-square score and game phase
+    board->material_pst += move->pst_delta;
+    board->game_phase += move->phase_delta;
+
     switch (move->move_type)
     {
     case MOVE_CASTLE:
@@ -217,7 +179,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PAWN_PUSH1:
         // Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
@@ -228,13 +190,13 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PAWN_PUSH2:
         // Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
@@ -245,7 +207,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // e.p flag
         if (pawn_attackers[opponent][(from + to) >> 1] & board->pieces[opponent][PAWN]) {
             board->ep_square = SQUARE64((from + to) >> 1);
@@ -256,12 +218,12 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PxPAWN:
         // Move on board
         board->square[to] = piece;
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -271,18 +233,18 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // e.p flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PxPIECE:
         // Move on board
         board->square[to] = piece;
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
 		board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -292,20 +254,20 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // e.p flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PxP_EP:
         // Move on board
         board->square[to] = piece;
         ep_capture	= ((to - 8) + 16 * color);
         board->square[ep_capture] = BLANK;
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -322,13 +284,13 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PROMOTION:
         // Move on board
         board->square[to] = move->promote_to;
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece])];
-		board->material_hash ^= material_hash_values[move->promote_to][popcount(board->piecelist[move->promote_to]) + 1];
+		// Update Material Index
+		board->material_index -= material_index_value[piece][popcount(board->piecelist[piece])];
+		board->material_index += material_index_value[move->promote_to][popcount(board->piecelist[move->promote_to]) + 1];
 		// Update bitboards
         board->piecelist[piece] ^= SQUARE64(from);
         board->piecelist[move->promote_to] ^= SQUARE64(to);
@@ -343,14 +305,14 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_CAPTUREPROMOTE:
         // Move on board
         board->square[to] = move->promote_to;
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[piece][popcount(board->piecelist[piece])];
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
-		board->material_hash ^= material_hash_values[move->promote_to][popcount(board->piecelist[move->promote_to]) + 1];
+		// Update Material Index
+		board->material_index -= material_index_value[piece][popcount(board->piecelist[piece])];
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
+		board->material_index += material_index_value[move->promote_to][popcount(board->piecelist[move->promote_to]) + 1];
 		// Update bitboards
         board->all_pieces ^= SQUARE64(from);
         board->piecelist[piece] ^= SQUARE64(from);
@@ -367,7 +329,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PIECE_MOVE:
         // Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
@@ -378,16 +340,16 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count++;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PIECExPIECE:
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];        
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];        
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -399,16 +361,16 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
 		assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_PIECExPAWN:
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -420,12 +382,12 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
-        return TRUE;
+        return;
     case MOVE_KING_MOVE:
         // Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
@@ -436,7 +398,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count++;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update King Position
@@ -444,10 +406,10 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_KINGxPIECE:
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -459,7 +421,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update King Position
@@ -467,10 +429,10 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     case MOVE_KINGxPAWN:
-		// Update Material Hash
-		board->material_hash ^= material_hash_values[captured][popcount(board->piecelist[captured])];
+		// Update Material Index
+		board->material_index -= material_index_value[captured][popcount(board->piecelist[captured])];
 		// Update bitboards
         board->piecelist[piece] ^= move->from_to_bitboard;
         board->occupied[color] ^= move->from_to_bitboard;
@@ -482,7 +444,7 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update flags
         board->fifty_move_count = 0;
         // Update Check flag
-        update_in_check(board, from, to, opponent);
+        set_in_check(board, info, piece, from, to, opponent);
         // Update ep flag
         board->ep_square = 0;
         // Update King Position
@@ -490,25 +452,25 @@ BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *m
         // Update draw stack with new hash value
         draw_stack[++draw_stack_count] = board->hash;
         assert(integrity(board));
-        return TRUE;
+        return;
     }
     assert(FALSE);
-    return FALSE;
 }
 
-void unmake_move(struct t_board *board, struct t_undo *undo) {
+template<t_chess_color color>
+inline void unmake_move(struct t_board *board, struct t_undo *undo) {
 
     struct t_move_record *move		= undo->move;
     t_chess_square from				= move->from_square;
     t_chess_square to				= move->to_square;
     t_chess_piece piece				= move->piece;
-    t_chess_color color				= OPPONENT(board->to_move);
     t_chess_piece captured;
     t_chess_piece promote;
-    t_chess_color opponent;
+    const t_chess_color opponent	= OPPONENT(color);
     t_chess_square ep_capture;
-    struct t_castle_record *castle_move;
+    const struct t_castle_record *castle_move;
 
+    assert(board->to_move == OPPONENT(color));
     assert(integrity(board));
 
     //-- copy back to the board
@@ -519,7 +481,9 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
     board->castling					= undo->castling;
     board->hash						= undo->hash;
     board->pawn_hash				= undo->pawn_hash;
-	board->material_hash			= undo->material_hash;
+	board->material_index			= undo->material_index;
+    board->material_pst -= move->pst_delta;
+    board->game_phase				-= move->phase_delta;
 
     board->square[from] = piece;
     board->to_move = color;
@@ -560,7 +524,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_PxPAWN:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -573,7 +536,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_PxPIECE:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -585,7 +547,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_PxP_EP:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = BLANK;
         ep_capture	= ((to - 8) + 16 * color);
@@ -608,7 +569,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         board->piecelist[promote] ^= SQUARE64(to);
         return;
     case MOVE_CAPTUREPROMOTE:
-        opponent = OPPONENT(color);
         promote = move->promote_to;
         captured = move->captured;
         //-- Squares
@@ -631,7 +591,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_PIECExPIECE:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -643,7 +602,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_PIECExPAWN:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -666,7 +624,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_KINGxPIECE:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -680,7 +637,6 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
         return;
     case MOVE_KINGxPAWN:
         captured = move->captured;
-        opponent = OPPONENT(color);
         //-- Squares
         board->square[to] = captured;
         //-- Bitboards
@@ -696,59 +652,60 @@ void unmake_move(struct t_board *board, struct t_undo *undo) {
     assert(FALSE);
 }
 
+void make_move(struct t_board *board, struct t_move_record *move, struct t_undo *undo) {
+    if (board->to_move == WHITE)
+        make_move<WHITE>(board, move, undo);
+    else
+        make_move<BLACK>(board, move, undo);
+    if (use_nnue)
+        nnue_make_move(board, move);
+}
 
-int legal_move_count(struct t_board *board, struct t_move_list *move_list) {
-    int i;
-    int n = 0;
-    for (i = move_list->count - 1; i >= 0; i--) {
-
-        switch (move_list->move[i]->move_type) {
-        case MOVE_CASTLE:
-            if (!is_in_check_after_move(board, move_list->move[i]))
-                n++;
-            break;
-        case MOVE_PxP_EP:
-            if (!is_in_check_after_move(board, move_list->move[i]))
-                n++;
-            break;
-        case MOVE_KING_MOVE:
-            if (!is_in_check_after_move(board, move_list->move[i]))
-                n++;
-            break;
-        case MOVE_KINGxPIECE:
-            if (!is_in_check_after_move(board, move_list->move[i]))
-                n++;
-            break;
-        case MOVE_KINGxPAWN:
-            if (!is_in_check_after_move(board, move_list->move[i]))
-                n++;
-            break;
-        default:
-            if (move_list->move[i]->from_to_bitboard & move_list->pinned_pieces) {
-                if (!is_in_check_after_move(board, move_list->move[i]))
-                    n++;
-            }
-            else
-                n++;
-            break;
-        }
+void unmake_move(struct t_board *board, struct t_undo *undo) {
+    if (board->to_move == BLACK)
+        unmake_move<WHITE>(board, undo);
+    else
+        unmake_move<BLACK>(board, undo);
+    if (use_nnue)
+        nnue_unmake_move(board, undo->move);
+}
 
-    }
-    return n;
+//-- Copy-make: the move is made on "child", a copy of the position, and "board" is left as it was.
+//-- The NNUE accumulator is only copied while it's being kept up to date.
+void copy_make_move(struct t_board *board, struct t_move_record *move, struct t_board *child, struct t_undo *undo) {
+    memcpy(child, board, use_nnue ? sizeof(struct t_board) : COMPACT_BOARD_SIZE);
+    child->pieces[WHITE] = child->piecelist;
+    child->pieces[BLACK] = child->piecelist + 8;
+    make_move(child, move, undo);
 }
 
+
 void make_game_move(struct t_board *board, char *s)
 {
     struct t_move_record	*move;
     struct t_undo			undo[1];
 
     move = lookup_move(board, s);
-    make_move(board, 0, move, undo);
+    make_move(board, move, undo);
 
     assert(integrity(board));
 }
 
 
+//-- Nothing in the evaluation's attack maps can take back on the target square, and no enemy
+//-- slider stands behind the moving piece, so the exchange ends with the capture
+static inline BOOL is_free_capture(struct t_board *board, struct t_move_list *move_list, struct t_move_record *move) {
+
+    struct t_chess_eval *eval = move_list->attack_eval;
+    if (eval == NULL || move->move_type == MOVE_PxP_EP)
+        return FALSE;
+
+    t_chess_color opponent = OPPONENT(COLOR(move->piece));
+    t_bitboard sliders = board->pieces[opponent][BISHOP] | board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN];
+
+    return !(eval->attacks[opponent][BLANK] & SQUARE64(move->to_square)) && !(xray[move->to_square][move->from_square] & sliders);
+}
+
 BOOL make_next_see_positive_move(struct t_board *board, struct t_move_list *move_list, t_chess_value see_margin, struct t_undo *undo) {
 
     struct t_move_record *move;
@@ -781,13 +738,12 @@ BOOL make_next_see_positive_move(struct t_board *board, struct t_move_list *move
         move_list->value[ibest] = move_list->value[move_list->imove];
 
         //-- Test to ensure if move is SEE positive
-        if (see(board, move, see_margin)) {
+        if (is_free_capture(board, move_list, move) ? see_piece_value[move->captured] >= see_margin : see(board, move, see_margin)) {
 
             //-- Make move on board
-            if (make_move(board, move_list->pinned_pieces, move, undo)) {
-                move_list->current_move = move;
-                return TRUE;
-            }
+            search_make_move(board, move, undo);
+            move_list->current_move = move;
+            return TRUE;
         }
     }
 
@@ -801,7 +757,7 @@ BOOL make_next_best_move(struct t_board *board, struct t_move_list *move_list, s
     t_chess_value best_value;
 
     //-- Test for no more moves
-    while (move_list->imove > 0) {
+    if (move_list->imove > 0) {
 
         //-- Decrement the move-played index
         move_list->imove--;
@@ -826,9 +782,8 @@ BOOL make_next_best_move(struct t_board *board, struct t_move_list *move_list, s
         move_list->value[ibest] = move_list->value[move_list->imove];
 
         //-- Make move on board
-        if (make_move(board, move_list->pinned_pieces, move_list->current_move, undo)) {
-            return TRUE;
-        }
+        search_make_move(board, move_list->current_move, undo);
+        return TRUE;
     }
 
     //-- No more moves!
@@ -867,14 +822,14 @@ BOOL make_next_move(struct t_board *board, struct t_move_list *move_list, struct
 		move_list->value[ibest] = move_list->value[move_list->imove];
 		
 		//-- Is the move a SEE positive capture or a hash move
-		if (!move->captured || move == move_list->hash_move || see(board, move, 0)){
+		if (!move->captured || move == move_list->hash_move || is_free_capture(board, move_list, move) || see(board, move, 0)){
 
 			//-- Store the move
 			move_list->current_move = move;
 
 			//-- Make move on board
-			if (make_move(board, move_list->pinned_pieces, move, undo))
-				return TRUE;
+			search_make_move(board, move, undo);
+			return TRUE;
 		}
 		else{
 			//-- Transfer the move over the other "bad" move list
@@ -886,7 +841,7 @@ BOOL make_next_move(struct t_board *board, struct t_move_list *move_list, struct
 	}
 
 	//-- Now see if there are any moves in the "bad" move list
-	while (bad_move_list->imove > 0){
+	if (bad_move_list->imove > 0){
 
 		//-- Decrement the move-played index
 		bad_move_list->imove--;
@@ -914,8 +869,8 @@ BOOL make_next_move(struct t_board *board, struct t_move_list *move_list, struct
 		move_list->current_move = move;
 
 		//-- Make move on board
-		if (make_move(board, move_list->pinned_pieces, move, undo))
-			return TRUE;
+		search_make_move(board, move, undo);
+		return TRUE;
 	}
 
 	//-- No more moves!
@@ -927,7 +882,7 @@ BOOL simple_make_next_move(struct t_board *board, struct t_move_list *move_list,
 	struct t_move_record *move;
 
 	//-- Now see if there are any moves in move list
-	while (move_list->imove > 0){
+	if (move_list->imove > 0){
 
 		//-- Decrement the move-played index
 		move_list->imove--;
@@ -936,8 +891,8 @@ BOOL simple_make_next_move(struct t_board *board, struct t_move_list *move_list,
 		move_list->current_move = move;
 
 		//-- Make move on board
-		if (make_move(board, move_list->pinned_pieces, move, undo))
-			return TRUE;
+		search_make_move(board, move, undo);
+		return TRUE;
 	}
 
 	//-- No more moves!
@@ -947,22 +902,12 @@ BOOL simple_make_next_move(struct t_board *board, struct t_move_list *move_list,
 BOOL is_move_legal(struct t_board *board, struct t_move_record *move)
 {
 	struct t_move_list move_list[1];
-	struct t_undo undo[1];
-	
-	if (board->in_check)
-		generate_evade_check(board, move_list);
-	else
-		generate_moves(board, move_list);
+
+	generate_legal_moves(board, move_list);
 
 	for (int i = move_list->count - 1; i >= 0; i--){
-		if (move_list->move[i] == move){
-			if (make_move(board, move_list->pinned_pieces, move, undo)){
-				unmake_move(board, undo);
-				return TRUE;
-			}
-			else
-				return FALSE;
-		}
+		if (move_list->move[i] == move)
+			return TRUE;
 	}
 	return FALSE;
 }
\ No newline at end of file
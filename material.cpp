@@ -0,0 +1,362 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// Material Index
+//
+// Each side's piece counts are a mixed-radix number: pawns 0-8,
+// knights, bishops and rooks 0-2, queen 0-1 (486 combinations),
+// and the index is white's number plus 486 times black's.  It's
+// kept up to date by make_move with material_index_value[][], so
+// the record for a position is a single array load.  A piece
+// beyond those counts (a third knight, a second queen) adds
+// MATERIAL_OVERFLOW instead, and such positions are worked out
+// on the spot by lookup_material.
+//===========================================================//
+
+static const int material_radix[8] = { 0, 3, 3, 3, 2, 9, 0, 0 };
+static const t_material_index material_weight[8] = { 0, 9, 27, 81, 243, 1, 0, 0 };
+
+void init_material_index()
+{
+	for (t_chess_piece piece = 0; piece < 16; piece++){
+		t_chess_piece piece_type = PIECETYPE(piece);
+		material_index_value[piece][0] = 0;
+		for (int count = 1; count < MATERIAL_MAX_COUNT; count++){
+			if (!material_radix[piece_type])
+				material_index_value[piece][count] = 0;
+			else if (count < material_radix[piece_type])
+				material_index_value[piece][count] = material_weight[piece_type] * (COLOR(piece) == WHITE ? 1 : MATERIAL_SIDE_SIZE);
+			else
+				material_index_value[piece][count] = MATERIAL_OVERFLOW;
+		}
+	}
+
+	material_record = (struct t_material_record *)malloc(MATERIAL_INDEX_SIZE * sizeof(struct t_material_record));
+	assert(material_record);
+	fill_material_records();
+}
+
+t_material_index get_material_index(const int material [])
+{
+	t_material_index index = 0;
+	for (int i = WHITEKNIGHT; i <= BLACKPAWN; i++){
+		for (int j = 1; j <= material[i]; j++){
+			index += material_index_value[i][j];
+		}
+	}
+	return index;
+}
+
+void clear_array(int a [])
+{
+	for (int i = 15; i >= 0; i--){
+		a[i] = 0;
+	}
+}
+
+static void board_material(struct t_board *board, int material[])
+{
+	clear_array(material);
+	for (t_chess_color color = WHITE; color <= BLACK; color++){
+		for (int piece = KNIGHT; piece <= PAWN; piece++){
+			material[PIECEINDEX(color, piece)] = popcount(board->pieces[color][piece]);
+		}
+	}
+}
+
+t_material_index calc_material_index(struct t_board *board)
+{
+	int material[16];
+	board_material(board, material);
+	return get_material_index(material);
+}
+
+//-- Everything about a set of material which doesn't depend on where the pieces are
+void calc_material_record(const int material[], struct t_material_record *record)
+{
+	t_chess_value non_pawn[2];
+
+	record->eval_endgame = NULL;
+	record->recognizer = RECOGNIZE_NONE;
+	record->imbalance = 0;
+
+	for (t_chess_color color = WHITE; color <= BLACK; color++){
+		non_pawn[color] = 0;
+		for (int piece = KNIGHT; piece <= QUEEN; piece++)
+			non_pawn[color] += material[PIECEINDEX(color, piece)] * piece_value[1][piece];
+
+		//-- Bishop pair bonus
+		if (material[PIECEINDEX(color, BISHOP)] >= 2)
+			record->imbalance += (1 - 2 * color) * MAKE_SCORE(eval_terms.mg_bishop_pair, eval_terms.eg_bishop_pair);
+	}
+
+	//-- Without pawns, being no more than a minor piece up is rarely enough to win
+	for (t_chess_color color = WHITE; color <= BLACK; color++){
+		record->scale[color] = MATERIAL_SCALE_NORMAL;
+		if (material[PIECEINDEX(color, PAWN)] == 0 && non_pawn[color] - non_pawn[OPPONENT(color)] <= piece_value[1][BISHOP])
+			record->scale[color] = (non_pawn[color] < piece_value[1][ROOK] ? 0 : MATERIAL_SCALE_NORMAL / 4);
+	}
+}
+
+//-- The record for the board's material (filled in "spare" if the counts don't fit the index)
+struct t_material_record *lookup_material(struct t_board *board, struct t_material_record *spare)
+{
+	int material[16];
+
+	if (board->material_index < MATERIAL_INDEX_SIZE)
+		return &material_record[board->material_index];
+
+	board_material(board, material);
+	calc_material_record(material, spare);
+	return spare;
+}
+
+static void set_known_ending(const int material[], void(*eval_endgame)(struct t_board *board, struct t_chess_eval *eval), uchar recognizer)
+{
+	t_material_index index = get_material_index(material);
+	assert(index < MATERIAL_INDEX_SIZE);
+	assert(material_record[index].eval_endgame == NULL);
+	material_record[index].eval_endgame = eval_endgame;
+	material_record[index].recognizer = recognizer;
+}
+
+//-- Rebuilt whenever the piece values or bishop pair bonus change
+void fill_material_records()
+{
+	int material[16];
+
+	for (t_material_index index = 0; index < MATERIAL_INDEX_SIZE; index++){
+		t_material_index side[2] = { index % MATERIAL_SIDE_SIZE, index / MATERIAL_SIDE_SIZE };
+		clear_array(material);
+		for (t_chess_color color = WHITE; color <= BLACK; color++){
+			for (int piece = KNIGHT; piece <= PAWN; piece++)
+				material[PIECEINDEX(color, piece)] = (side[color] / material_weight[piece]) % material_radix[piece];
+		}
+		calc_material_record(material, &material_record[index]);
+	}
+
+	//-- K vs. k
+	clear_array(material);
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_DRAW);
+
+	//-- Q + K vs. k
+	clear_array(material);
+	material[WHITEQUEEN] = 1;
+	set_known_ending(material, &known_endgame_QKvk, RECOGNIZE_WON);
+
+	//-- K vs. q + k
+	clear_array(material);
+	material[BLACKQUEEN] = 1;
+	set_known_ending(material, &known_endgame_Kvqk, RECOGNIZE_WON);
+
+	//-- R + K vs. k
+	clear_array(material);
+	material[WHITEROOK] = 1;
+	set_known_ending(material, &known_endgame_RKvk, RECOGNIZE_WON);
+
+	//-- K vs. r + k
+	clear_array(material);
+	material[BLACKROOK] = 1;
+	set_known_ending(material, &known_endgame_Kvrk, RECOGNIZE_WON);
+
+	//-- B + B + K vs. k
+	clear_array(material);
+	material[WHITEBISHOP] = 2;
+	set_known_ending(material, &known_endgame_BBKvk, RECOGNIZE_NONE);
+
+	//-- K vs. b + b + k
+	clear_array(material);
+	material[BLACKBISHOP] = 2;
+	set_known_ending(material, &known_endgame_Kvbbk, RECOGNIZE_NONE);
+
+	//-- B + N + K vs. k
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[WHITEKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_BNKvk, RECOGNIZE_NONE);
+
+	//-- K vs. b + n + k
+	clear_array(material);
+	material[BLACKBISHOP] = 1;
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_Kvbnk, RECOGNIZE_NONE);
+
+	//-- K + N vs. k
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_DRAW);
+
+	//-- K vs. k + n
+	clear_array(material);
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_DRAW);
+
+	//-- K + N + N vs. k
+	clear_array(material);
+	material[WHITEKNIGHT] = 2;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K vs. k + n + n
+	clear_array(material);
+	material[BLACKKNIGHT] = 2;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + B vs. k
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_DRAW);
+
+	//-- K vs. k + b
+	clear_array(material);
+	material[BLACKBISHOP] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_DRAW);
+
+	//-- K + B vs. k + n
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + N vs. k + b
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	material[BLACKBISHOP] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + R + N vs. k
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	material[WHITEROOK] = 1;
+	set_known_ending(material, &known_endgame_KRNvk, RECOGNIZE_NONE);
+
+	//-- K vs. k + r + n
+	clear_array(material);
+	material[BLACKKNIGHT] = 1;
+	material[BLACKROOK] = 1;
+	set_known_ending(material, &known_endgame_Kvkrn, RECOGNIZE_NONE);
+
+	//-- K + R + B vs. k
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[WHITEROOK] = 1;
+	set_known_ending(material, &known_endgame_KRBvk, RECOGNIZE_NONE);
+
+	//-- K vs. k + r + b
+	clear_array(material);
+	material[BLACKBISHOP] = 1;
+	material[BLACKROOK] = 1;
+	set_known_ending(material, &known_endgame_Kvkrb, RECOGNIZE_NONE);
+
+	//-- K + N vs. k  + p
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	material[BLACKPAWN] = 1;
+	set_known_ending(material, &known_endgame_KNvkp, RECOGNIZE_NONE);
+
+	//-- K + P vs. k + n
+	clear_array(material);
+	material[WHITEPAWN] = 1;
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_KPvkn, RECOGNIZE_NONE);
+
+	//-- K + B vs. k  + p
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[BLACKPAWN] = 1;
+	set_known_ending(material, &known_endgame_KBvkp, RECOGNIZE_NONE);
+
+	//-- K + P vs. k + b
+	clear_array(material);
+	material[WHITEPAWN] = 1;
+	material[BLACKBISHOP] = 1;
+	set_known_ending(material, &known_endgame_KPvkb, RECOGNIZE_NONE);
+
+	//-- K + B vs. k  + r
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[BLACKROOK] = 1;
+	set_known_ending(material, &known_endgame_KBvkr, RECOGNIZE_NONE);
+
+	//-- K + R vs. k + b
+	clear_array(material);
+	material[WHITEROOK] = 1;
+	material[BLACKBISHOP] = 1;
+	set_known_ending(material, &known_endgame_KRvkb, RECOGNIZE_NONE);
+	
+	//-- K + N vs. k  + r
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	material[BLACKROOK] = 1;
+	set_known_ending(material, &known_endgame_KNvkr, RECOGNIZE_NONE);
+
+	//-- K + R vs. k + n
+	clear_array(material);
+	material[WHITEROOK] = 1;
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_KRvkn, RECOGNIZE_NONE);
+
+	//-- K + N + N vs. k + n
+	clear_array(material);
+	material[WHITEKNIGHT] = 2;
+	material[BLACKKNIGHT] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + N vs. k + n + n
+	clear_array(material);
+	material[WHITEKNIGHT] = 1;
+	material[BLACKKNIGHT] = 2;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + N + N vs. k + n + n
+	clear_array(material);
+	material[WHITEKNIGHT] = 2;
+	material[BLACKKNIGHT] = 2;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + N + N vs. k + b
+	clear_array(material);
+	material[WHITEKNIGHT] = 2;
+	material[BLACKBISHOP] = 1;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + B vs. k + n + n
+	clear_array(material);
+	material[WHITEBISHOP] = 1;
+	material[BLACKKNIGHT] = 2;
+	set_known_ending(material, &known_endgame_insufficient_material, RECOGNIZE_NONE);
+
+	//-- K + P vs. k
+	clear_array(material);
+	material[WHITEPAWN] = 1;
+	set_known_ending(material, &known_endgame_KPvk, RECOGNIZE_KPK);
+
+	//-- K vs. k + p
+	clear_array(material);
+	material[BLACKPAWN] = 1;
+	set_known_ending(material, &known_endgame_Kvkp, RECOGNIZE_KPK);
+}
+
+void destroy_material_index()
+{
+	if (uci.engine_initialized){
+		free(material_record);
+		material_record = NULL;
+	}
+}
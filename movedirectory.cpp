@@ -19,6 +19,12 @@
 #include "procs.h"
 #include "bittwiddle.h"
 
+//-- Directory entries are indexes into xmove_list (a quarter of the size of pointers)
+static inline t_move_index directory_index(struct t_move_record *move) {
+    assert(move >= xmove_list && move < xmove_list + GLOBAL_MOVE_COUNT);
+    return (t_move_index)(move - xmove_list);
+}
+
 t_move_record *lookup_move(struct t_board *board, char *move_string) {
 
     t_chess_square from_square = name_to_index(move_string);
@@ -38,11 +44,11 @@ t_move_record *lookup_move(struct t_board *board, char *move_string) {
         else if (move_string[4] == 'n')
             promote_to = KNIGHT;
 
-        return move_directory[from_square][to_square][piece] + (4 * captured) + promote_to - 1;
+        return directory_move(from_square, to_square, piece) + (4 * captured) + promote_to - 1;
 
     }
     else
-        return move_directory[from_square][to_square][piece] + captured;
+        return directory_move(from_square, to_square, piece) + captured;
 }
 
 void configure_castling(int *i)
@@ -57,8 +63,8 @@ void configure_castling(int *i)
     move->piece = WHITEKING;
     move->promote_to = BLANK;
     move->castling_delta = (BLACK_CASTLE_OO | BLACK_CASTLE_OOO);
-    move_directory[move->from_square][move->to_square][move->piece] = move;
-    move_directory[move->from_square][H1][move->piece] = move;
+    move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
+    move_directory[move->from_square][H1][move->piece] = directory_index(move);
     (*i)++;
     move++;
 
@@ -70,8 +76,8 @@ void configure_castling(int *i)
     move->piece = WHITEKING;
     move->promote_to = BLANK;
     move->castling_delta = (BLACK_CASTLE_OO | BLACK_CASTLE_OOO);
-    move_directory[move->from_square][move->to_square][move->piece] = move;
-    move_directory[move->from_square][A1][move->piece] = move;
+    move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
+    move_directory[move->from_square][A1][move->piece] = directory_index(move);
     (*i)++;
     move++;
 
@@ -83,8 +89,8 @@ void configure_castling(int *i)
     move->piece = BLACKKING;
     move->promote_to = BLANK;
     move->castling_delta = (WHITE_CASTLE_OO | WHITE_CASTLE_OOO);
-    move_directory[move->from_square][move->to_square][move->piece] = move;
-    move_directory[move->from_square][H8][move->piece] = move;
+    move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
+    move_directory[move->from_square][H8][move->piece] = directory_index(move);
     (*i)++;
     move++;
 
@@ -96,8 +102,8 @@ void configure_castling(int *i)
     move->piece = BLACKKING;
     move->promote_to = BLANK;
     move->castling_delta = (WHITE_CASTLE_OO | WHITE_CASTLE_OOO);
-    move_directory[move->from_square][move->to_square][move->piece] = move;
-    move_directory[move->from_square][A8][move->piece] = move;
+    move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
+    move_directory[move->from_square][A8][move->piece] = directory_index(move);
     (*i)++;
     move++;
 
@@ -117,7 +123,7 @@ void configure_pawn_push(int *i)
         move->move_type = MOVE_PAWN_PUSH2;
         move->piece = WHITEPAWN;
         move->promote_to = BLANK;
-        move_directory[move->from_square][move->to_square][move->piece] = move;
+        move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
         (*i)++;
         move++;
     }
@@ -130,14 +136,14 @@ void configure_pawn_push(int *i)
         move->move_type = MOVE_PAWN_PUSH1;
         move->piece = WHITEPAWN;
         move->promote_to = BLANK;
-        move_directory[move->from_square][move->to_square][move->piece] = move;
+        move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
         (*i)++;
         move++;
     }
 
     // White promotions
     for (s = A7; s <= H7; s++) {
-        move_directory[s][s + 8][WHITEPAWN] = move;
+        move_directory[s][s + 8][WHITEPAWN] = directory_index(move);
         for (promote = WHITEKNIGHT; promote <= WHITEQUEEN; promote++) {
             move->captured = BLANK;
             move->from_square = s;
@@ -158,7 +164,7 @@ void configure_pawn_push(int *i)
         move->move_type = MOVE_PAWN_PUSH2;
         move->piece = BLACKPAWN;
         move->promote_to = BLANK;
-        move_directory[move->from_square][move->to_square][move->piece] = move;
+        move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
         (*i)++;
         move++;
     }
@@ -171,14 +177,14 @@ void configure_pawn_push(int *i)
         move->move_type = MOVE_PAWN_PUSH1;
         move->piece = BLACKPAWN;
         move->promote_to = BLANK;
-        move_directory[move->from_square][move->to_square][move->piece] = move;
+        move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
         (*i)++;
         move++;
     }
 
     // Black pawn promotions
     for (s = A2; s <= H2; s++) {
-        move_directory[s][s - 8][BLACKPAWN] = move;
+        move_directory[s][s - 8][BLACKPAWN] = directory_index(move);
         for (promote = BLACKKNIGHT; promote <= BLACKQUEEN; promote++) {
             move->captured = BLANK;
             move->from_square = s;
@@ -212,7 +218,7 @@ void configure_pawn_capture(int *i)
                 move->move_type = MOVE_PxP_EP;
                 move->piece = WHITEPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move;
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                 (*i)++;
                 move++;
             }
@@ -228,7 +234,7 @@ void configure_pawn_capture(int *i)
                 }
                 move->piece = WHITEPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move - PIECETYPE(capture);
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move - PIECETYPE(capture));
                 (*i)++;
                 move++;
             }
@@ -245,7 +251,7 @@ void configure_pawn_capture(int *i)
                 move->move_type = MOVE_PxP_EP;
                 move->piece = WHITEPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move;
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                 (*i)++;
                 move++;
             }
@@ -261,7 +267,7 @@ void configure_pawn_capture(int *i)
                 }
                 move->piece = WHITEPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move - PIECETYPE(capture);
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move - PIECETYPE(capture));
                 (*i)++;
                 move++;
             }
@@ -272,7 +278,7 @@ void configure_pawn_capture(int *i)
     for (s = A7; s <= H7; s++) {
         if (COLUMN(s) < 7) {
             for (capture = BLACKKNIGHT; capture <= BLACKQUEEN; capture++) {
-                move_directory[s][s + 9][WHITEPAWN] = move - (4 * PIECETYPE(capture));
+                move_directory[s][s + 9][WHITEPAWN] = directory_index(move - (4 * PIECETYPE(capture)));
                 for (promote = WHITEKNIGHT; promote <= WHITEQUEEN; promote++) {
                     move->captured = capture;
                     move->from_square = s;
@@ -287,7 +293,7 @@ void configure_pawn_capture(int *i)
         }
         if (COLUMN(s) > 0) {
             for (capture = BLACKKNIGHT; capture <= BLACKQUEEN; capture++) {
-                move_directory[s][s + 7][WHITEPAWN] = move - (4 * PIECETYPE(capture));
+                move_directory[s][s + 7][WHITEPAWN] = directory_index(move - (4 * PIECETYPE(capture)));
                 for (promote = WHITEKNIGHT; promote <= WHITEQUEEN; promote++) {
                     move->captured = capture;
                     move->from_square = s;
@@ -315,7 +321,7 @@ void configure_pawn_capture(int *i)
                 move->move_type = MOVE_PxP_EP;
                 move->piece = BLACKPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move;
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                 (*i)++;
                 move++;
             }
@@ -331,7 +337,7 @@ void configure_pawn_capture(int *i)
                 }
                 move->piece = BLACKPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move - PIECETYPE(capture);
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move - PIECETYPE(capture));
                 (*i)++;
                 move++;
             }
@@ -347,7 +353,7 @@ void configure_pawn_capture(int *i)
                 move->move_type = MOVE_PxP_EP;
                 move->piece = BLACKPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move;
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                 (*i)++;
                 move++;
             }
@@ -363,7 +369,7 @@ void configure_pawn_capture(int *i)
                 }
                 move->piece = BLACKPAWN;
                 move->promote_to = BLANK;
-                move_directory[move->from_square][move->to_square][move->piece] = move - PIECETYPE(capture);
+                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move - PIECETYPE(capture));
                 (*i)++;
                 move++;
             }
@@ -375,7 +381,7 @@ void configure_pawn_capture(int *i)
     for (s = A2; s <= H2; s++) {
         if (COLUMN(s) < 7) {
             for (capture = WHITEKNIGHT; capture <= WHITEQUEEN; capture++) {
-                move_directory[s][s - 7][BLACKPAWN] = move - (4 * PIECETYPE(capture));
+                move_directory[s][s - 7][BLACKPAWN] = directory_index(move - (4 * PIECETYPE(capture)));
                 for (promote = BLACKKNIGHT; promote <= BLACKQUEEN; promote++) {
                     move->captured = capture;
                     move->from_square = s;
@@ -390,7 +396,7 @@ void configure_pawn_capture(int *i)
         }
         if (COLUMN(s) > 0) {
             for (capture = WHITEKNIGHT; capture <= WHITEQUEEN; capture++) {
-                move_directory[s][s - 9][BLACKPAWN] = move - (4 * PIECETYPE(capture));
+                move_directory[s][s - 9][BLACKPAWN] = directory_index(move - (4 * PIECETYPE(capture)));
                 for (promote = BLACKKNIGHT; promote <= BLACKQUEEN; promote++) {
                     move->captured = capture;
                     move->from_square = s;
@@ -432,7 +438,7 @@ void configure_piece_moves(int *i)
                                 move->move_type = MOVE_PIECE_MOVE;
                                 move->piece = move_piece;
                                 move->promote_to = BLANK;
-                                move_directory[move->from_square][move->to_square][move->piece] = move;
+                                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                                 (*i)++;
                                 move++;
                                 for (capture = KNIGHT; capture <= QUEEN; capture++) {
@@ -474,7 +480,7 @@ void configure_piece_moves(int *i)
                                     move->move_type = MOVE_PIECE_MOVE;
                                 move->piece = move_piece;
                                 move->promote_to = BLANK;
-                                move_directory[move->from_square][move->to_square][move->piece] = move;
+                                move_directory[move->from_square][move->to_square][move->piece] = directory_index(move);
                                 (*i)++;
                                 move++;
                                 for (capture = KNIGHT; capture <= QUEEN; capture++) {
@@ -526,7 +532,7 @@ void init_move_directory()
     for (f = A1; f <= H8; f++) {
         for (t = A1; t <= H8; t++) {
             for (p = BLANK; p <= BLACKKING; p++) {
-                move_directory[f][t][p] = NULL;
+                move_directory[f][t][p] = 0;
             }
         }
     }
@@ -561,6 +567,18 @@ void init_move_directory()
         move->hash_delta = white_to_move_hash;
         move->pawn_hash_delta = white_to_move_hash;
 
+        //-- Material + piece-square and game phase deltas
+        move->pst_delta = pst_value((move->promote_to ? move->promote_to : move->piece), move->to_square) - pst_value(move->piece, move->from_square);
+        if (move->move_type == MOVE_PxP_EP)
+            move->pst_delta -= pst_value(move->captured, (move->to_square - 8) + 16 * color);
+        else
+            move->pst_delta -= pst_value(move->captured, move->to_square);
+        if (move->move_type == MOVE_CASTLE)
+            move->pst_delta += pst_value(castle[move->index].rook_piece, castle[move->index].rook_to) - pst_value(castle[move->index].rook_piece, castle[move->index].rook_from);
+        move->phase_delta = -game_phase_weight[PIECETYPE(move->captured)];
+        if (move->promote_to)
+            move->phase_delta += game_phase_weight[PIECETYPE(move->promote_to)] - game_phase_weight[PAWN];
+
         if (move->captured)
 		{
 			assert(move->piece >= 0 && move->piece < 15);
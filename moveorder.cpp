@@ -13,21 +13,40 @@
 #include "defs.h"
 #include "data.h"
 #include "procs.h"
+#include "bittwiddle.h"
+
+//-- The evaluation's attack maps, if it built them for this position (never under the network)
+static inline struct t_chess_eval *attack_maps(struct t_board *board, int ply) {
+	struct t_chess_eval *eval = search_stack->ply[ply].eval;
+	return (eval->attack_hash == board->hash) ? eval : NULL;
+}
 
 void order_moves(struct t_board *board, struct t_move_list *move_list, int ply) {
 
 	struct t_move_record *hash_move = move_list->hash_move;
     struct t_move_record *move;
-    struct t_move_record *killer1 = board->pv_data[ply].killer1;
-    struct t_move_record *killer2 = board->pv_data[ply].killer2;
+    struct t_move_record *killer1 = search_stack->ply[ply].killer1;
+    struct t_move_record *killer2 = search_stack->ply[ply].killer2;
     struct t_move_record *killer3 = NULL;
     struct t_move_record *killer4 = NULL;
 
     if (ply > 1) {
-        killer3 = board->pv_data[ply - 2].killer1;
-        killer4 = board->pv_data[ply - 2].killer2;
+        killer3 = search_stack->ply[ply - 2].killer1;
+        killer4 = search_stack->ply[ply - 2].killer2;
     }
 
+	//-- Pieces attacked by a pawn or left hanging should move first, and not onto squares like that
+	struct t_chess_eval *eval = attack_maps(board, ply);
+	t_bitboard threatened = 0;
+	t_bitboard unsafe = 0;
+	move_list->attack_eval = eval;
+	if (eval) {
+		t_chess_color color = board->to_move;
+		t_chess_color opponent = OPPONENT(color);
+		unsafe = eval->attacks[opponent][PAWN] | (eval->attacks[opponent][BLANK] & ~eval->attacks[color][BLANK]);
+		threatened = board->occupied[color] & ~board->pieces[color][PAWN] & ~board->pieces[color][KING] & unsafe;
+	}
+
     for (int i = move_list->count - 1; i >= 0; i--)
     {
         move = move_list->move[i];
@@ -45,25 +64,35 @@ void order_moves(struct t_board *board, struct t_move_list *move_list, int ply)
             move_list->value[i] = MOVE_ORDER_KILLER3;
         else if (move == killer4)
             move_list->value[i] = MOVE_ORDER_KILLER4;
-        else
+        else {
             move_list->value[i] = move->history;
+			if (SQUARE64(move->to_square) & unsafe) {
+				if (PIECETYPE(move->piece) != PAWN)
+					move_list->value[i] -= MOVE_ORDER_ESCAPE;
+			}
+			else if (SQUARE64(move->from_square) & threatened)
+				move_list->value[i] += MOVE_ORDER_ESCAPE;
+		}
     }
 }
 
 void order_evade_check(struct t_board *board, struct t_move_list *move_list, int ply) {
+	(void)board;
 
 	struct t_move_record *hash_move = move_list->hash_move;
     struct t_move_record *move;
-    struct t_move_record *killer1 = board->pv_data[ply].check_killer1;
-    struct t_move_record *killer2 = board->pv_data[ply].check_killer2;
+    struct t_move_record *killer1 = search_stack->ply[ply].check_killer1;
+    struct t_move_record *killer2 = search_stack->ply[ply].check_killer2;
     struct t_move_record *killer3 = NULL;
     struct t_move_record *killer4 = NULL;
 
     if (ply > 1) {
-        killer3 = board->pv_data[ply - 2].check_killer1;
-        killer4 = board->pv_data[ply - 2].check_killer2;
+        killer3 = search_stack->ply[ply - 2].check_killer1;
+        killer4 = search_stack->ply[ply - 2].check_killer2;
     }
 
+	move_list->attack_eval = NULL;
+
     for (int i = move_list->count - 1; i >= 0; i--)
     {
         move = move_list->move[i];
@@ -86,7 +115,9 @@ void order_evade_check(struct t_board *board, struct t_move_list *move_list, int
     }
 }
 
-void order_captures(struct t_board *board, struct t_move_list *move_list) {
+void order_captures(struct t_board *board, struct t_move_list *move_list, int ply) {
+
+	move_list->attack_eval = attack_maps(board, ply);
 
     for (int i = move_list->count - 1; i >= 0; i--)
         move_list->value[i] = move_list->move[i]->mvvlva;
@@ -0,0 +1,451 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <Windows.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "defs.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// NNUE Evaluation
+//
+// An efficiently updatable network selected with the EvalFile
+// option.  The handcrafted evaluation is used when no network
+// is loaded.
+//
+// Features (HalfKP): for each perspective, the square of that
+// side's king x each non-king piece (5 types x own/enemy) x its
+// square.  Black's perspective is mirrored vertically so both
+// sides see the board from their own first rank.
+//
+//   feature = king * 640 + ((type - 1) * 2 + (color != perspective)) * 64 + square
+//
+// The first layer (an accumulator of NNUE_HIDDEN int16 values
+// per perspective) lives in the board and is updated by
+// make_move / unmake_move.  A king move refreshes its own side.
+// The side to move's accumulator and then the opponent's are
+// clipped to 0..127 and run through two int8 hidden layers
+// (clipped, >> NNUE_WEIGHT_SHIFT) and an int8 output neuron.
+//
+// Weights file (little-endian, no padding):
+//
+//   offset  type      count                       field
+//   0       char      8                           "MAVNNUE1"
+//   8       uint32    1                           version (1)
+//   12      uint32    1                           NNUE_HIDDEN (256)
+//   16      int16     NNUE_HIDDEN                 feature biases
+//           int16     NNUE_FEATURES * NNUE_HIDDEN feature weights, one row per feature
+//           int32     NNUE_L1                     layer 1 biases
+//           int8      NNUE_L1 * 2 * NNUE_HIDDEN   layer 1 weights, one row per output
+//           int32     NNUE_L2                     layer 2 biases
+//           int8      NNUE_L2 * NNUE_L1           layer 2 weights, one row per output
+//           int32     1                           output bias
+//           int8      NNUE_L2                     output weights
+//
+// The score is output / NNUE_OUTPUT_SCALE centipawns for the
+// side to move.  The file is memory mapped and used in place.
+//===========================================================//
+
+static inline int nnue_feature(t_chess_color perspective, t_chess_square king, t_chess_piece piece, t_chess_square square)
+{
+    if (perspective == BLACK) {
+        king = FLIP64(king);
+        square = FLIP64(square);
+    }
+    return king * 640 + ((PIECETYPE(piece) - 1) * 2 + (COLOR(piece) != perspective)) * 64 + square;
+}
+
+//===========================================================//
+// Accumulator rows
+//===========================================================//
+#ifdef HAVE_AVX2_KERNELS
+
+AVX2_TARGET static void add_row_avx2(short *acc, const short *row, int sign)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(row + i));
+        a = (sign > 0) ? _mm256_add_epi16(a, w) : _mm256_sub_epi16(a, w);
+        _mm256_storeu_si256((__m256i *)(acc + i), a);
+    }
+}
+
+static void add_row_sse2(short *acc, const short *row, int sign)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(row + i));
+        a = (sign > 0) ? _mm_add_epi16(a, w) : _mm_sub_epi16(a, w);
+        _mm_storeu_si128((__m128i *)(acc + i), a);
+    }
+}
+
+#endif
+
+//-- acc += row (sign = 1) or acc -= row (sign = -1)
+static inline void add_row(short *acc, const short *row, int sign)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (cpu.avx2)
+        add_row_avx2(acc, row, sign);
+    else
+        add_row_sse2(acc, row, sign);
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        acc[i] += sign * row[i];
+#endif
+}
+
+static inline void add_feature(struct t_board *board, t_chess_color perspective, t_chess_piece piece, t_chess_square square, int sign)
+{
+    add_row(board->nnue.v[perspective], nnue_network.feature_weights + (size_t)nnue_feature(perspective, board->king_square[perspective], piece, square) * NNUE_HIDDEN, sign);
+}
+
+//-- Rebuild one perspective's accumulator from the pieces on the board
+void nnue_refresh(struct t_board *board, t_chess_color perspective)
+{
+    memcpy(board->nnue.v[perspective], nnue_network.feature_bias, sizeof(board->nnue.v[perspective]));
+    for (t_chess_color color = WHITE; color <= BLACK; color++) {
+        for (t_chess_piece piece_type = KNIGHT; piece_type <= PAWN; piece_type++) {
+            t_chess_piece piece = PIECEINDEX(color, piece_type);
+            t_bitboard b = board->piecelist[piece];
+            while (b)
+                add_feature(board, perspective, piece, bitscan_reset(&b), 1);
+        }
+    }
+}
+
+void nnue_refresh_all(struct t_board *board)
+{
+    nnue_refresh(board, WHITE);
+    nnue_refresh(board, BLACK);
+}
+
+//-- Apply (sign = 1) or take back (sign = -1) the feature changes of a move.  The board must show the position after the move
+//-- when making it and before it when taking it back, so a king move can simply refresh its own side.
+static void nnue_update(struct t_board *board, struct t_move_record *move, int sign)
+{
+    t_chess_color mover = COLOR(move->piece);
+    t_chess_square capture_square = (move->move_type == MOVE_PxP_EP) ? (move->to_square - 8) + 16 * mover : move->to_square;
+
+    for (t_chess_color perspective = WHITE; perspective <= BLACK; perspective++) {
+
+        if (PIECETYPE(move->piece) == KING && perspective == mover) {
+            nnue_refresh(board, perspective);
+            continue;
+        }
+
+        if (PIECETYPE(move->piece) != KING) {
+            add_feature(board, perspective, move->piece, move->from_square, -sign);
+            add_feature(board, perspective, move->promote_to ? move->promote_to : move->piece, move->to_square, sign);
+        }
+        if (move->captured)
+            add_feature(board, perspective, move->captured, capture_square, -sign);
+        if (move->move_type == MOVE_CASTLE) {
+            add_feature(board, perspective, castle[move->index].rook_piece, castle[move->index].rook_from, -sign);
+            add_feature(board, perspective, castle[move->index].rook_piece, castle[move->index].rook_to, sign);
+        }
+    }
+}
+
+void nnue_make_move(struct t_board *board, struct t_move_record *move)
+{
+    nnue_update(board, move, 1);
+}
+
+void nnue_unmake_move(struct t_board *board, struct t_move_record *move)
+{
+    nnue_update(board, move, -1);
+}
+
+//===========================================================//
+// Inference
+//===========================================================//
+#ifdef HAVE_AVX2_KERNELS
+
+AVX2_TARGET static void clip_accumulator_avx2(const short *acc, unsigned char *out)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(127);
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *)(acc + i)), zero), max);
+        __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *)(acc + i + 16)), zero), max);
+        //-- packus works within 128-bit halves, so put the quadwords back in order
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8));
+    }
+}
+
+//-- out[j] = bias[j] + sum(in[i] * weights[j][i]); inputs are 0..127 so maddubs can't saturate
+AVX2_TARGET static void affine_avx2(const unsigned char *in, int n, const signed char *weights, const int *bias, int m, int *out)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (int j = 0; j < m; j++) {
+        __m256i sum = _mm256_setzero_si256();
+        const signed char *row = weights + j * n;
+        for (int i = 0; i < n; i += 32) {
+            __m256i p = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(in + i)), _mm256_loadu_si256((const __m256i *)(row + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(p, ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+        out[j] = bias[j] + _mm_cvtsi128_si32(s);
+    }
+}
+
+static void clip_accumulator_sse2(const short *acc, unsigned char *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(127);
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i *)(acc + i)), zero), max);
+        __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i *)(acc + i + 8)), zero), max);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(a, b));
+    }
+}
+
+//-- SSE2 has no maddubs: widen both sides to int16 and use madd
+static void affine_sse2(const unsigned char *in, int n, const signed char *weights, const int *bias, int m, int *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int j = 0; j < m; j++) {
+        __m128i sum = _mm_setzero_si128();
+        const signed char *row = weights + j * n;
+        for (int i = 0; i < n; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+            __m128i w = _mm_loadu_si128((const __m128i *)(row + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(x, zero), _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(x, zero), _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8)));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+        out[j] = bias[j] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+#else
+
+static void clip_accumulator_scalar(const short *acc, unsigned char *out)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        out[i] = (unsigned char)(acc[i] < 0 ? 0 : (acc[i] > 127 ? 127 : acc[i]));
+}
+
+static void affine_scalar(const unsigned char *in, int n, const signed char *weights, const int *bias, int m, int *out)
+{
+    for (int j = 0; j < m; j++) {
+        int sum = bias[j];
+        for (int i = 0; i < n; i++)
+            sum += in[i] * weights[j * n + i];
+        out[j] = sum;
+    }
+}
+
+#endif
+
+static inline void clip_accumulator(const short *acc, unsigned char *out)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (cpu.avx2)
+        clip_accumulator_avx2(acc, out);
+    else
+        clip_accumulator_sse2(acc, out);
+#else
+    clip_accumulator_scalar(acc, out);
+#endif
+}
+
+static inline void affine(const unsigned char *in, int n, const signed char *weights, const int *bias, int m, int *out)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (cpu.avx2)
+        affine_avx2(in, n, weights, bias, m, out);
+    else
+        affine_sse2(in, n, weights, bias, m, out);
+#else
+    affine_scalar(in, n, weights, bias, m, out);
+#endif
+}
+
+static inline void clip_layer(const int *in, int n, unsigned char *out)
+{
+    for (int i = 0; i < n; i++) {
+        int x = in[i] >> NNUE_WEIGHT_SHIFT;
+        out[i] = (unsigned char)(x < 0 ? 0 : (x > 127 ? 127 : x));
+    }
+}
+
+//-- Score for the side to move, in place of calc_evaluation()
+t_chess_value nnue_evaluate(struct t_board *board, struct t_chess_eval *eval)
+{
+    unsigned char input[2 * NNUE_HIDDEN];
+    unsigned char hidden1[NNUE_L1];
+    unsigned char hidden2[NNUE_L2];
+    int layer[NNUE_L1];
+
+    clip_accumulator(board->nnue.v[board->to_move], input);
+    clip_accumulator(board->nnue.v[OPPONENT(board->to_move)], input + NNUE_HIDDEN);
+
+    affine(input, 2 * NNUE_HIDDEN, nnue_network.l1_weights, nnue_network.l1_bias, NNUE_L1, layer);
+    clip_layer(layer, NNUE_L1, hidden1);
+
+    affine(hidden1, NNUE_L1, nnue_network.l2_weights, nnue_network.l2_bias, NNUE_L2, layer);
+    clip_layer(layer, NNUE_L2, hidden2);
+
+    int output = nnue_network.output_bias[0];
+    for (int i = 0; i < NNUE_L2; i++)
+        output += hidden2[i] * nnue_network.output_weights[i];
+
+    t_chess_value score = output / NNUE_OUTPUT_SCALE;
+    if (score > NNUE_MAX_SCORE)
+        score = NNUE_MAX_SCORE;
+    else if (score < -NNUE_MAX_SCORE)
+        score = -NNUE_MAX_SCORE;
+
+    eval->static_score = score;
+    return score;
+}
+
+//===========================================================//
+// Loading
+//===========================================================//
+
+//-- Point the network at weights in the documented format; the caller keeps the buffer alive
+BOOL nnue_set_weights(const void *data, size_t size)
+{
+    const char *p = (const char *)data;
+    unsigned int header[2];
+
+    if (size != NNUE_FILE_SIZE || memcmp(p, NNUE_MAGIC, 8))
+        return FALSE;
+    memcpy(header, p + 8, sizeof(header));
+    if (header[0] != NNUE_VERSION || header[1] != NNUE_HIDDEN)
+        return FALSE;
+
+    p += NNUE_HEADER_SIZE;
+    nnue_network.feature_bias = (const short *)p;		p += 2 * NNUE_HIDDEN;
+    nnue_network.feature_weights = (const short *)p;	p += 2 * (size_t)NNUE_FEATURES * NNUE_HIDDEN;
+    nnue_network.l1_bias = (const int *)p;				p += 4 * NNUE_L1;
+    nnue_network.l1_weights = (const signed char *)p;	p += NNUE_L1 * 2 * NNUE_HIDDEN;
+    nnue_network.l2_bias = (const int *)p;				p += 4 * NNUE_L2;
+    nnue_network.l2_weights = (const signed char *)p;	p += NNUE_L2 * NNUE_L1;
+    nnue_network.output_bias = (const int *)p;			p += 4;
+    nnue_network.output_weights = (const signed char *)p;	p += NNUE_L2;
+    assert(p == (const char *)data + NNUE_FILE_SIZE);
+
+    nnue_network.size = size;
+    return TRUE;
+}
+
+void nnue_unload()
+{
+    if (nnue_network.view != NULL) {
+#if defined(_WIN32)
+        UnmapViewOfFile(nnue_network.view);
+#else
+        munmap(nnue_network.view, nnue_network.size);
+#endif
+    }
+    nnue_network.view = NULL;
+    use_nnue = FALSE;
+}
+
+//-- Map the weights file and switch to the network; falls back to the handcrafted evaluation if it can't be used
+BOOL nnue_load(char *filename)
+{
+    void *view = NULL;
+    size_t size = 0;
+
+    nnue_unload();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart == NNUE_FILE_SIZE) {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping != NULL) {
+                view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                size = (size_t)file_size.QuadPart;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size == NNUE_FILE_SIZE) {
+            view = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (view == MAP_FAILED)
+                view = NULL;
+            size = st.st_size;
+        }
+        close(fd);
+    }
+#endif
+
+    if (view == NULL || !nnue_set_weights(view, size)) {
+        if (view != NULL) {
+#if defined(_WIN32)
+            UnmapViewOfFile(view);
+#else
+            munmap(view, size);
+#endif
+        }
+        return FALSE;
+    }
+
+    nnue_network.view = view;
+    use_nnue = TRUE;
+    return TRUE;
+}
+
+//-- Handle the EvalFile option: an empty name goes back to the handcrafted evaluation
+void set_eval_file(char *filename)
+{
+    char name[FILENAME_MAX];
+    char s[FILENAME_MAX + 64];
+
+    strncpy(name, filename, sizeof(name) - 1);
+    name[sizeof(name) - 1] = 0;
+    char *p = strchr(name, '\n');
+    if (p) *p = 0;
+
+    if (name[0] == 0 || !strcmp(name, "<empty>"))
+        nnue_unload();
+    else if (nnue_load(name)) {
+        snprintf(s, sizeof(s), "NNUE evaluation using %s", name);
+        send_info(s);
+    }
+    else {
+        snprintf(s, sizeof(s), "Unable to load NNUE weights from %s - using the handcrafted evaluation", name);
+        send_info(s);
+    }
+
+    //-- Scores from the other evaluation must not be reused
+    clear_eval_hash();
+    if (use_nnue)
+        nnue_refresh_all(position);
+}
@@ -15,6 +15,7 @@
 #include "defs.h"
 #include "data.h"
 #include "procs.h"
+#include "bittwiddle.h"
 
 void close_book()
 {
@@ -169,9 +170,9 @@ struct t_move_record *decode_move(struct t_board *board, unsigned int move)
         captured = PIECETYPE(board->square[to_square]);
 
     if (promote)
-        return move_directory[from_square][to_square][piece] + (4 * captured) + promote - 1;
+        return directory_move(from_square, to_square, piece) + (4 * captured) + promote - 1;
     else
-        return move_directory[from_square][to_square][piece] + captured;
+        return directory_move(from_square, to_square, piece) + captured;
 }
 
 t_move_record *probe_book(struct t_board *board)
@@ -21,8 +21,12 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
 {
     t_chess_color color;
 
-    // Look-up in pawn hash table
-    struct t_pawn_hash_record *pawn_record = &pawn_hash[board->pawn_hash & pawn_hash_mask];
+    // Look-up in pawn hash table (tuning threads each bring their own)
+    struct t_pawn_hash_record *pawn_record;
+    if (eval->pawn_table)
+        pawn_record = &eval->pawn_table[board->pawn_hash & eval->pawn_table_mask];
+    else
+        pawn_record = &pawn_hash[board->pawn_hash & pawn_hash_mask];
     // See if already exists
     if (pawn_record->key == board->pawn_hash) {
         for (color = WHITE; color <= BLACK; color++) {
@@ -35,9 +39,8 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
     t_chess_color opponent;
     t_chess_square s;
     t_bitboard b, w, p;
-    t_chess_value middlegame = 0;
-    t_chess_value endgame = 0;
-	t_chess_value bonus;
+    t_score score = 0;
+	t_score bonus;
     t_bitboard fwd_attacks[2];
     t_bitboard bkw_attacks[2];
     int c;
@@ -81,8 +84,7 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
 		while (b){
 			s = bitscan_reset(&b);
 			bonus = passed_pawn_bonus[color][s];
-			middlegame += bonus;
-			endgame += bonus;
+			score += bonus;
 
 			//-- Connected passed pawn bonus
 			if (connected_pawn_mask[s] & pawn_record->passed[color]){
@@ -103,8 +105,7 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
 				// New2 = /5, /2
 				// New3 = /4, /2
 				// New4 = /5, 2/3
-				middlegame += bonus / 5;
-				endgame += (2 * bonus) / 3;
+				score += MAKE_SCORE(MG_SCORE(bonus) / 5, (2 * EG_SCORE(bonus)) / 3);
 			}
 		}
     }
@@ -117,8 +118,7 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
 
 		while (b){
 			s = bitscan_reset(&b);
-			middlegame += double_pawn_penalty[MIDDLEGAME][COLUMN(s)] * (1 - 2 * color);
-			endgame += double_pawn_penalty[ENDGAME][COLUMN(s)] * (1 - 2 * color);
+			score += double_pawn_penalty[COLUMN(s)] * (1 - 2 * color);
 		}
     }
 
@@ -135,23 +135,12 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
     }
     int count = popcount(pawn_record->isolated[WHITE]) - popcount(pawn_record->isolated[BLACK]);
 
-    middlegame += count * MG_ISOLATED_PAWN;
-    endgame += count * EG_ISOLATED_PAWN;
+    score += count * MAKE_SCORE(eval_terms.mg_isolated_pawn, eval_terms.eg_isolated_pawn);
 
     // Backward
 
     //--TO DO!!
 
-    //- Piece Square values
-    for (color = WHITE; color <= BLACK; color++) {
-        b = board->pieces[color][PAWN];
-        while (b) {
-            s = bitscan_reset(&b);
-            middlegame += piece_square_table[PIECEINDEX(color, PAWN)][MIDDLEGAME][s] * (1 - color * 2);
-            endgame += piece_square_table[PIECEINDEX(color, PAWN)][ENDGAME][s] * (1 - color * 2);
-        }
-    }
-
 	//-- Open file
 	t_bitboard pawn_file[2];
 	for (color = WHITE; color <= BLACK; color++) {
@@ -165,8 +154,7 @@ struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_ches
 	}
 
     //-- Transfer to Pawn Record
-    pawn_record->middlegame = middlegame;
-    pawn_record->endgame = endgame;
+    pawn_record->score = score;
 
     //-- Transfer key Bitboard to the Board structure
     for (color = WHITE; color <= BLACK; color++) {
@@ -205,8 +193,7 @@ void set_pawn_hash(unsigned int size)
     pawn_hash_mask = i - 1;
     for (i = 0; i <= pawn_hash_mask; i++) {
         pawn_hash[i].key = 0;
-        pawn_hash[i].endgame = 0;
-        pawn_hash[i].middlegame = 0;
+        pawn_hash[i].score = 0;
 		pawn_hash[i].open_file = 0;
         for (t_chess_color c = WHITE; c <= BLACK; c++) {
             pawn_hash[i].backward[c] = 0;
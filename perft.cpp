@@ -27,21 +27,17 @@ t_nodes perft(struct t_board *board, int depth) {
 
     int i;
 
-    if (board->in_check)
-        generate_evade_check(board, move_list);
-    else
-        generate_moves(board, move_list);
+    generate_legal_moves(board, move_list);
 
     for (i = move_list->count - 1; i >= 0; i--) {
-        if (make_move(board, move_list->pinned_pieces, move_list->move[i], undo)) {
-            move_nodes = 0;
-            if (depth > 1)
-                move_nodes += do_perft(board, depth - 1);
-            printf(move_as_str(move_list->move[i]));
-            printf(" = %u\n", move_nodes);
-            unmake_move(board, undo);
-            total_nodes += move_nodes;
-        }
+        make_move(board, move_list->move[i], undo);
+        move_nodes = 1;
+        if (depth > 1)
+            move_nodes = do_perft(board, depth - 1);
+        printf(move_as_str(move_list->move[i]));
+        printf(" = %u\n", move_nodes);
+        unmake_move(board, undo);
+        total_nodes += move_nodes;
     }
 
     unsigned long finish = time_now();
@@ -57,50 +53,49 @@ t_nodes perft(struct t_board *board, int depth) {
 t_nodes do_perft(struct t_board *board, int depth)
 {
     struct t_move_list move_list[1];
-	struct t_move_list bad_move_list[1];
-	bad_move_list->count = 0;
-	bad_move_list->imove = 0;
     struct t_undo undo[1];
 
     t_nodes nodes = 0;
     int i;
 
     assert(integrity(board));
-    if (board->in_check) {
-        generate_evade_check(board, move_list);
-        if (depth == 1) return move_list->count;
-    }
-    else {
-
-        //generate_captures(board, move_list);
-        //generate_quiet_moves(board, move_list);
-        generate_moves(board, move_list);
-        //if (!equal_move_lists(move_list, xmove_list)){
-        //	write_board(board, "board.txt");
-        //	write_move_list(xmove_list, "all.txt");
-        //	write_move_list(move_list, "inc.txt");
-        //}
-        if (depth == 1) return legal_move_count(board, move_list);
-    }
+
+    //-- Every generated move is legal so the leaves are just a count
+    generate_legal_moves(board, move_list);
+    if (depth == 1) return move_list->count;
 
     for (i = move_list->count - 1; i >= 0; i--) {
         assert(lookup_move(board, move_as_str(move_list->move[i])) == move_list->move[i]);
-        if (make_next_move(board, move_list, bad_move_list, undo)) {
-            assert(integrity(board));
-
-            //nodes++;
-            if (depth > 1)
-                nodes += do_perft(board, depth - 1);
-            else
-                nodes++;
-            unmake_move(board, undo);
-            assert(integrity(board));
-        }
-        else
-            assert(integrity(board));
+        make_move(board, move_list->move[i], undo);
+        assert(integrity(board));
+        nodes += do_perft(board, depth - 1);
+        unmake_move(board, undo);
+        assert(integrity(board));
     }
 
     return nodes;
 
 }
 
+//-- The same count by copy-make: each move is made on a copy of the position so nothing is taken back
+t_nodes do_perft_copy(struct t_board *board, int depth)
+{
+    struct t_move_list move_list[1];
+    struct t_board child[1];
+    struct t_undo undo[1];
+
+    t_nodes nodes = 0;
+    int i;
+
+    generate_legal_moves(board, move_list);
+    if (depth == 1) return move_list->count;
+
+    for (i = move_list->count - 1; i >= 0; i--) {
+        copy_make_move(board, move_list->move[i], child, undo);
+        assert(integrity(child));
+        nodes += do_perft_copy(child, depth - 1);
+        draw_stack_count--;
+    }
+
+    return nodes;
+}
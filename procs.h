@@ -49,9 +49,13 @@ int word_count(char *s);
 t_hash rand64();
 void qsort_moves(struct t_move_list *move_list, int first, int last);
 char *leftstr(char *s, int index);
+void detect_cpu();
+char *cpu_kernel_string();
+int processor_count();
 
 // board.c
 void update_in_check(struct t_board *board, t_chess_square from_square, t_chess_square to_square, t_chess_color color);
+void calc_check_info(struct t_board *board, struct t_check_info *info);
 BOOL is_pinned(struct t_board *board, t_chess_square square, t_chess_square pinned_to);
 t_chess_square who_is_attacking_square(struct t_board *board, t_chess_square square, t_chess_color color);
 int attack_count(struct t_board *board, t_chess_square square, t_chess_color color);
@@ -59,6 +63,8 @@ BOOL is_in_check(struct t_board *board, t_chess_color color);
 //BOOL is_in_check_after_move(struct t_board *board, struct t_move_record *move);
 BOOL is_square_attacked(struct t_board *board, t_chess_square square, t_chess_color color);
 void init_board(struct t_board *board);
+void copy_board(struct t_board *to, struct t_board *from);
+void init_search_stack(struct t_search_stack *stack);
 void add_piece(struct t_board *board, t_chess_piece piece, t_chess_square target_square);
 void clear_board(struct t_board *board);
 void new_game(struct t_board *board);
@@ -82,14 +88,8 @@ void set_fen(struct t_board *board, char *epd);
 char *get_fen(struct t_board *board);
 
 //--bitboard.c
-void init_bitboards();
 void init_magic();
 
-t_bitboard index_to_bitboard(t_bitboard mask, int index);
-t_bitboard create_rook_mask(t_chess_square s);
-t_bitboard create_rook_attacks(t_chess_square s, t_bitboard mask);
-t_bitboard create_bishop_mask(t_chess_square s);
-t_bitboard create_bishop_attacks(t_chess_square s, t_bitboard mask);
 void flip_board(struct t_board *board);
 
 //--Hash Table
@@ -110,6 +110,38 @@ void destroy_pawn_hash();
 struct t_pawn_hash_record *lookup_pawn_hash(struct t_board *board, struct t_chess_eval *eval);
 t_hash calc_pawn_hash(struct t_board *board);
 
+//--Eval Hash Table Routines (evalhash.cpp)
+void set_eval_hash(unsigned int size);
+void init_eval_hash();
+void destroy_eval_hash();
+void clear_eval_hash();
+
+//-- NNUE Evaluation (nnue.cpp)
+BOOL nnue_load(char *filename);
+BOOL nnue_set_weights(const void *data, size_t size);
+void nnue_unload();
+void set_eval_file(char *filename);
+void nnue_refresh(struct t_board *board, t_chess_color perspective);
+void nnue_refresh_all(struct t_board *board);
+void nnue_make_move(struct t_board *board, struct t_move_record *move);
+void nnue_unmake_move(struct t_board *board, struct t_move_record *move);
+t_chess_value nnue_evaluate(struct t_board *board, struct t_chess_eval *eval);
+
+//-- Slider Mobility Kernels (evalsimd.cpp)
+void add_slider(struct t_slider_batch *batch, t_chess_color color, t_chess_square square, t_bitboard occupied, t_bitboard not_occupied);
+t_score rook_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks);
+t_score bishop_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks);
+t_score queen_mobility_kernel(struct t_slider_batch *batch, t_bitboard *attacks);
+BOOL avx2_kernels_available();
+
+//-- Set-wise Slider Fills (fill.cpp)
+void rook_fill(const t_bitboard rooks[2], const t_bitboard empty[2], t_bitboard attacks[2]);
+void bishop_fill(const t_bitboard bishops[2], const t_bitboard empty[2], t_bitboard attacks[2]);
+void queen_fill(const t_bitboard queens[2], const t_bitboard empty[2], t_bitboard attacks[2]);
+void select_fill_kernel();
+const char *fill_kernel_name(int kernel);
+t_bitboard attack_map(struct t_board *board, t_chess_color color, t_bitboard occupied);
+
 //-- Static Exchange Evaluation (see.cpp)
 t_chess_value see(struct t_board *board, struct t_move_record *move, t_chess_value threshold);
 
@@ -138,7 +170,7 @@ void update_move_value(struct t_move_record *move, struct t_move_list *move_list
 
 //-- Order Moves (moveorder.cpp)
 void order_moves(struct t_board *board, struct t_move_list *move_list, int ply);
-void order_captures(struct t_board *board, struct t_move_list *move_list);
+void order_captures(struct t_board *board, struct t_move_list *move_list, int ply);
 void order_evade_check(struct t_board *board, struct t_move_list *move_list, int ply);
 void age_history_scores();
 void update_killers(struct t_pv_data *pv, int depth);
@@ -151,13 +183,13 @@ void update_best_line_from_hash(struct t_board *board, int ply);
 
 //-- Move List Manipulation
 BOOL move_list_integrity(struct t_board *board, struct t_move_list *move_list);
-int legal_move_count(struct t_board *board, struct t_move_list *move_list);
 BOOL equal_move_lists(struct t_move_list *move_list1, struct t_move_list *move_list2);
 BOOL is_move_in_list(struct t_move_record *move, struct t_move_list *move_list);
 
 //--Make Moves (make.c)
-BOOL make_move(struct t_board *board, t_bitboard pinned, struct t_move_record *move, struct t_undo *undo);
+void make_move(struct t_board *board, struct t_move_record *move, struct t_undo *undo);
 void unmake_move(struct t_board *board, struct t_undo *undo);
+void copy_make_move(struct t_board *board, struct t_move_record *move, struct t_board *child, struct t_undo *undo);
 void make_game_move(struct t_board *board, char *s);
 BOOL make_next_see_positive_move(struct t_board *board, struct t_move_list *move_list, t_chess_value see_margin, struct t_undo *undo);
 BOOL make_next_best_move(struct t_board *board, struct t_move_list *move_list, struct t_undo *undo);
@@ -169,7 +201,9 @@ BOOL is_move_legal(struct t_board *board, struct t_move_record *move);
 
 //--Evaluate the Board (eval.cpp)
 t_chess_value evaluate(struct t_board *board, struct t_chess_eval *eval);
-inline t_chess_value calc_evaluation(struct t_board *board, struct t_chess_eval *eval);
+t_chess_value get_static_score(struct t_board *board, struct t_chess_eval *eval);
+t_chess_value get_lazy_score(struct t_board *board, struct t_chess_eval *eval, t_chess_value alpha, t_chess_value beta);
+t_chess_value calc_evaluation(struct t_board *board, struct t_chess_eval *eval);
 inline void calc_game_phase(struct t_board *board, struct t_chess_eval *eval);
 inline void calc_pawn_value(struct t_board *board, struct t_chess_eval *eval);
 inline void calc_piece_value(struct t_board *board, struct t_chess_eval *eval);
@@ -177,6 +211,10 @@ inline void calc_passed_pawns(struct t_board *board, struct t_chess_eval *eval);
 inline void calc_king_safety(struct t_board *board, struct t_chess_eval *eval);
 inline BOOL known_ending(struct t_board *board, t_chess_value *score);
 void init_eval_function();
+void init_piece_square_tables();
+t_score pst_value(t_chess_piece piece, t_chess_square square);
+t_score calc_board_pst(struct t_board *board);
+int calc_board_phase(struct t_board *board);
 void init_eval(struct t_chess_eval *eval);
 
 //-- Know Endgames
@@ -201,12 +239,41 @@ void known_endgame_KRvkn(struct t_board *board, struct t_chess_eval *eval);
 void known_endgame_KNvkr(struct t_board *board, struct t_chess_eval *eval);
 void known_endgame_KRvkb(struct t_board *board, struct t_chess_eval *eval);
 void known_endgame_KBvkr(struct t_board *board, struct t_chess_eval *eval);
+void known_endgame_KPvk(struct t_board *board, struct t_chess_eval *eval);
+void known_endgame_Kvkp(struct t_board *board, struct t_chess_eval *eval);
+
+//-- King + Pawn vs. King Bitbase (kpk.cpp)
+void init_kpk();
+BOOL kpk_win(t_chess_color to_move, t_chess_square wk, t_chess_square bk, t_chess_square pawn);
+t_chess_value kpk_score(struct t_board *board);
 
-//-- Material Hash Routines (materialhash.cpp)
-BOOL fill_material_hash();
-void init_material_hash();
-void destroy_material_hash();
-t_hash calc_material_hash(struct t_board *board);
+//-- Endgame Tablebases (tablebase.cpp)
+void init_tablebases();
+unsigned int tb_index(struct t_tablebase *tb, struct t_tb_position *p);
+void tb_decode(struct t_tablebase *tb, unsigned int index, struct t_tb_position *p);
+void tablebase_file_name(char *filename, char *path, const char *name, const char *extension);
+BOOL load_tablebase(struct t_tablebase *tb, char *path);
+void set_tablebase_memory(struct t_tablebase *tb, uchar *wdl, uchar *dtz);
+void unload_tablebase(struct t_tablebase *tb);
+void unload_tablebases();
+void set_tablebase_path(char *path);
+int tb_probe_position(struct t_tb_position *p, int *dtz);
+BOOL probe_wdl(struct t_board *board, int *wdl);
+t_chess_value tablebase_score(int wdl, int ply);
+struct t_move_record *probe_root_tablebase(struct t_board *board, t_chess_value *score);
+
+//-- Tablebase Generator (tbgen.cpp)
+BOOL generate_tablebase(struct t_tablebase *tb, char *path, int threads);
+void generate_tablebases(char *s);
+
+//-- Material Index Routines (material.cpp)
+void fill_material_records();
+void init_material_index();
+void destroy_material_index();
+t_material_index calc_material_index(struct t_board *board);
+t_material_index get_material_index(const int material[]);
+void calc_material_record(const int material[], struct t_material_record *record);
+struct t_material_record *lookup_material(struct t_board *board, struct t_material_record *spare);
 
 //--Write to Disc
 void write_board(struct t_board *board, char filename[1024]);
@@ -224,6 +291,16 @@ BOOL test_make_unmake();
 BOOL test_perft();
 BOOL test_hash();
 BOOL test_eval();
+BOOL test_attack_maps();
+BOOL test_eval_kernels();
+BOOL test_slider_fills();
+BOOL test_nnue();
+BOOL test_tuning();
+BOOL test_material();
+BOOL test_kpk();
+BOOL test_recognizer();
+BOOL test_tablebase();
+BOOL test_check_info();
 BOOL test_capture_gen();
 BOOL test_check_gen();
 BOOL test_alt_move_gen();
@@ -231,12 +308,30 @@ BOOL test_see();
 BOOL test_position();
 BOOL test_search();
 BOOL test_book();
+BOOL test_repetition();
+BOOL test_copy_board();
+BOOL test_copy_make();
 BOOL test_hash_table();
 BOOL test_ep_capture();
 
 //--Perft
 t_nodes perft(struct t_board *board, int depth);
 t_nodes do_perft(struct t_board *board, int depth);
+t_nodes do_perft_copy(struct t_board *board, int depth);
+
+//--Benchmarks (bench.cpp)
+void eval_bench(char *filename);
+void fill_bench(char *filename);
+void make_bench(char *filename);
+void footprint_report();
+
+//--Tuning (tune.cpp)
+void pack_position(struct t_board *board, struct t_tune_position *p);
+void unpack_position(struct t_board *board, struct t_tune_position *p);
+int load_tuning_positions(char *filename, struct t_tune_position **positions, BOOL quiesce);
+double tuning_loss(struct t_tune_position *positions, int count, double k, int threads, t_chess_value *scores);
+unsigned __stdcall tuning_thread(void *arguments);
+void tune_eval(char *s);
 
 //-- Opening Book (openingbook.c)
 int book_count();
@@ -250,5 +345,7 @@ void fill_opening_move_list(struct t_board *board, struct t_move_list *move_list
 
 //-- Draw Routines (draw.cpp)
 BOOL repetition_draw(struct t_board *board);
+void init_cuckoo();
+BOOL upcoming_repetition(struct t_board *board);
 BOOL is_checkmate(struct t_board *board);
 BOOL is_stalemate(struct t_board *board);
@@ -16,9 +16,10 @@
 
 void update_best_line(struct t_board *board, int ply)
 {
+    (void)board;
 
-    struct t_pv_data *pv = &(board->pv_data[ply]);
-    struct t_pv_data *pvn = &(board->pv_data[ply + 1]);
+    struct t_pv_data *pv = &(search_stack->ply[ply]);
+    struct t_pv_data *pvn = &(search_stack->ply[ply + 1]);
     int i;
 
     pv->best_line[ply] = pv->current_move;
@@ -29,7 +30,7 @@ void update_best_line(struct t_board *board, int ply)
 
 void update_best_line_from_hash(struct t_board *board, int ply)
 {
-	struct t_pv_data *pv = &(board->pv_data[ply]);
+	struct t_pv_data *pv = &(search_stack->ply[ply]);
 	t_move_record *move;
 	t_hash_record *hash_record;
 	t_undo undo[1];
@@ -39,7 +40,7 @@ void update_best_line_from_hash(struct t_board *board, int ply)
 		move = hash_record->move;
 		hash_record->age = hash_age;
 		if (is_move_legal(board, move))
-			make_move(board, 0, move, undo);
+			make_move(board, move, undo);
 		else
 			return;
 		pv->best_line[pv->best_line_length++] = move;
@@ -76,8 +77,8 @@ BOOL research_required(struct t_board *board, struct t_multi_pv *mpv, int index,
 	}
 
 	//-- Exact PV found (i.e. alpha < score < beta)
-	struct t_pv_data *pv = &(board->pv_data[0]);
-	struct t_pv_data *pvn = &(board->pv_data[1]);
+	struct t_pv_data *pv = &(search_stack->ply[0]);
+	struct t_pv_data *pvn = &(search_stack->ply[1]);
 
 	mpv->pv[index].score = score;
 	mpv->pv[index].pv_length = pvn->best_line_length;
@@ -15,12 +15,38 @@
 #include "data.h"
 #include "procs.h"
 
+//-- Play the best tablebase move without searching, reporting its tablebase score
+static BOOL play_tablebase_move(struct t_board *board)
+{
+	t_chess_value tb_score;
+	struct t_move_record *move;
+	char s[256];
+
+	if (!tablebase_pieces || uci.level.infinite)
+		return FALSE;
+
+	move = probe_root_tablebase(board, &tb_score);
+	if (move == NULL)
+		return FALSE;
+
+	search_stack->ply[0].best_line[0] = move;
+	search_stack->ply[0].best_line_length = 1;
+	send_info("Maverick Tablebase Move!");
+	sprintf(s, "info depth 1 score cp %d time %ld nodes 0 tbhits 1 pv %s", tb_score, time_now() - search_start_time, move_as_str(move));
+	send_command(s);
+
+	while (uci.level.ponder && !uci.stop)
+		Sleep(1);
+	do_uci_bestmove(board);
+	return TRUE;
+}
+
 void root_search(struct t_board *board)
 {
 
 	//-- Declare local variables
 	struct t_undo undo[1];
-	struct t_pv_data *pv = board->pv_data;
+	struct t_pv_data *pv = search_stack->ply;
 	t_chess_value e;
 
 	//-- Generate moves
@@ -28,8 +54,8 @@ void root_search(struct t_board *board)
 	generate_legal_moves(board, move_list);
 
 	//-- Dummy move for PV (in case there is no search)
-	board->pv_data[0].best_line[0] = move_list->move[0];
-	board->pv_data[0].best_line_length = 1;
+	search_stack->ply[0].best_line[0] = move_list->move[0];
+	search_stack->ply[0].best_line_length = 1;
 
 	//-- Reset Move Scores
 	reset_move_list_scores(move_list);
@@ -43,6 +69,9 @@ void root_search(struct t_board *board)
 	hash_full = 0;
 	hash_probes = 0;
 
+	eval_hash_hits = 0;
+	eval_hash_probes = 0;
+
 	cutoffs = 0;
 	first_move_cutoffs = 0;
 
@@ -72,8 +101,8 @@ void root_search(struct t_board *board)
 			if (move_list->count == 1){
 				move = move_list->move[0];
 				if (move != NULL) {
-					board->pv_data[0].best_line[0] = move;
-					board->pv_data[0].best_line_length = 1;
+					search_stack->ply[0].best_line[0] = move;
+					search_stack->ply[0].best_line_length = 1;
 					send_info("Maverick Smart Book Move!");
 					while (uci.level.ponder && !uci.stop)
 						Sleep(1);
@@ -93,8 +122,8 @@ void root_search(struct t_board *board)
 		else{
 			move = probe_book(board);
 			if (move != NULL) {
-				board->pv_data[0].best_line[0] = move;
-				board->pv_data[0].best_line_length = 1;
+				search_stack->ply[0].best_line[0] = move;
+				search_stack->ply[0].best_line_length = 1;
 				send_info("Maverick Book Move!");
 				while (uci.level.ponder && !uci.stop)
 					Sleep(1);
@@ -104,6 +133,10 @@ void root_search(struct t_board *board)
 		}
 	}
 
+	//-- Play the tablebase move if the position is in the tables
+	if (play_tablebase_move(board))
+		return;
+
 	//-- Age the history scores
 	age_history_scores();
 
@@ -127,13 +160,13 @@ void root_search(struct t_board *board)
 			//-- Make the move on the board
 			pv->current_move = move_list->move[i];
 			pv->legal_moves_played++;
-			make_move(board, move_list->pinned_pieces, pv->current_move, undo);
+			make_move(board, pv->current_move, undo);
 
 			//-- Tell the GUI
 			do_uci_consider_move(board, search_ply);
 
-			//-- Evaluate the new position
-			evaluate(board, board->pv_data[1].eval);
+			//-- The new position is only evaluated if the search needs it
+			search_stack->ply[1].eval->evaluated = FALSE;
 
 			//-- Call alpha-beta recursively
 			e = -alphabeta(board, 1, search_ply - 1, -beta, -alpha);
@@ -208,7 +241,7 @@ void root_search_aspiration(struct t_board *board)
 
     //-- Declare local variables
     struct t_undo undo[1];
-    struct t_pv_data *pv = board->pv_data;
+    struct t_pv_data *pv = search_stack->ply;
     t_chess_value e;
 
     //-- Generate moves
@@ -216,8 +249,8 @@ void root_search_aspiration(struct t_board *board)
     generate_legal_moves(board, move_list);
 
 	//-- Dummy move for PV (in case there is no search)
-	board->pv_data[0].best_line[0] = move_list->move[0];
-	board->pv_data[0].best_line_length = 1;
+	search_stack->ply[0].best_line[0] = move_list->move[0];
+	search_stack->ply[0].best_line_length = 1;
 
     //-- Reset Move Scores
     reset_move_list_scores(move_list);
@@ -231,6 +264,9 @@ void root_search_aspiration(struct t_board *board)
 	hash_full = 0;
 	hash_probes = 0;
 
+	eval_hash_hits = 0;
+	eval_hash_probes = 0;
+
 	cutoffs = 0;
 	first_move_cutoffs = 0;
 
@@ -252,8 +288,8 @@ void root_search_aspiration(struct t_board *board)
         struct t_move_record *move;
         move = probe_book(board);
         if (move != NULL) {
-            board->pv_data[0].best_line[0] = move;
-            board->pv_data[0].best_line_length = 1;
+            search_stack->ply[0].best_line[0] = move;
+            search_stack->ply[0].best_line_length = 1;
             send_info("Maverick Book Move!");
             while (uci.level.ponder && !uci.stop)
                 Sleep(1);
@@ -262,12 +298,16 @@ void root_search_aspiration(struct t_board *board)
         }
     }
 
+    //-- Play the tablebase move if the position is in the tables
+    if (play_tablebase_move(board))
+        return;
+
     //-- Age the history scores
     age_history_scores();
 
 	//-- Evaluate the initial position
-	evaluate(board, board->pv_data[0].eval);
-	best_score = board->pv_data[0].eval->static_score;
+	evaluate(board, search_stack->ply[0].eval);
+	best_score = search_stack->ply[0].eval->static_score;
 
 	//-- Flaf to see if the search was volatile?
 	BOOL volatile_last_ply = FALSE;
@@ -300,13 +340,13 @@ void root_search_aspiration(struct t_board *board)
             //-- Make the move on the board
             pv->current_move = move_list->move[i];
             pv->legal_moves_played++;
-            make_move(board, move_list->pinned_pieces, pv->current_move, undo);
+            make_move(board, pv->current_move, undo);
 
             //-- Tell the GUI
             do_uci_consider_move(board, search_ply);
 
-            //-- Evaluate the new position
-            evaluate(board, board->pv_data[1].eval);
+            //-- The new position is only evaluated if the search needs it
+            search_stack->ply[1].eval->evaluated = FALSE;
 
 			//-- Start of Aspuiration search loop
 			do{
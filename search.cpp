@@ -21,7 +21,60 @@ inline BOOL can_do_null_move(struct t_board *board, struct t_pv_data *pv, int pl
 	t_chess_color color = board->to_move;
 	int piece_count = popcount(board->occupied[color] ^ board->pieces[color][PAWN]);
 
-	return !board->in_check && pv->eval->static_score >= beta && piece_count > 3;
+	return !board->in_check && piece_count > 3 && get_lazy_score(board, pv->eval, beta - 1, beta) >= beta;
+}
+
+//-- Endings flagged in the material record are settled before any moves are generated.
+//-- Dead draws and KPK are exact; a queen or rook against a bare king only gives a bound,
+//-- the known ending score, and only when the lone king can neither take the piece nor be stalemated.
+static inline BOOL recognize_ending(struct t_board *board, struct t_pv_data *pv, t_chess_value alpha, t_chess_value beta, t_chess_value *score, t_hash_bound *bound){
+
+	if (board->material_index >= MATERIAL_INDEX_SIZE)
+		return FALSE;
+
+	switch (material_record[board->material_index].recognizer){
+
+	case RECOGNIZE_DRAW:
+		*score = 0;
+		*bound = HASH_EXACT;
+		return TRUE;
+
+	case RECOGNIZE_KPK:
+		*score = kpk_score(board);
+		*bound = HASH_EXACT;
+		return TRUE;
+
+	case RECOGNIZE_WON:
+		{
+			t_chess_color strong = (board->occupied[WHITE] ^ board->pieces[WHITE][KING]) ? WHITE : BLACK;
+			t_chess_color weak = OPPONENT(strong);
+
+			if (board->to_move == strong){
+				*score = get_static_score(board, pv->eval);
+				*bound = HASH_LOWER;
+				return *score >= beta;
+			}
+
+			t_chess_square s = bitscan(board->occupied[strong] ^ board->pieces[strong][KING]);
+			t_bitboard guarded = king_mask[board->king_square[strong]];
+			t_bitboard occupied = board->all_pieces ^ board->pieces[weak][KING];
+
+			if (board->pieces[strong][QUEEN])
+				guarded |= rook_attacks(s, occupied) | bishop_attacks(s, occupied);
+			else
+				guarded |= rook_attacks(s, occupied);
+
+			//-- Hanging piece, stalemate or mate, let the search see it
+			t_bitboard escape = king_mask[board->king_square[weak]] & ~guarded;
+			if (!escape || (escape & SQUARE64(s)))
+				return FALSE;
+
+			*score = get_static_score(board, pv->eval);
+			*bound = HASH_UPPER;
+			return *score <= alpha;
+		}
+	}
+	return FALSE;
 }
 
 t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value alpha, t_chess_value beta) {
@@ -43,13 +96,14 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
 		uci_check_status(board, ply);
 
 	//-- Local Principle Variation variable
-    struct t_pv_data *pv = &(board->pv_data[ply]);
+    struct t_pv_data *pv = &(search_stack->ply[ply]);
 
     //-- Has the maximum depth been reached
     if (ply > MAXPLY) {
         pv->best_line_length = ply;
-		assert(pv->eval->static_score > -CHECKMATE && pv->eval->static_score < CHECKMATE);
-        return pv->eval->static_score;
+		e = get_static_score(board, pv->eval);
+		assert(e > -CHECKMATE && e < CHECKMATE);
+        return e;
     }
 
     /* check to see if this is a repeated position or draw by 50 moves */
@@ -58,6 +112,15 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
         return 0;
     }
 
+	//-- An earlier position is one move away, so the side to move can get at least a draw
+	if (alpha < 0 && upcoming_repetition(board)) {
+		alpha = 0;
+		if (alpha >= beta) {
+			pv->best_line_length = ply;
+			return alpha;
+		}
+	}
+
 	//-- Mate Distance Pruning
 	if (CHECKMATE - ply <= alpha){
 		assert(alpha > -CHECKMATE && alpha < CHECKMATE);
@@ -68,8 +131,26 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
 		return beta;
 	}
 
+	//-- Recognized endings need no search
+	t_hash_bound bound;
+	if (recognize_ending(board, pv, alpha, beta, &e, &bound)) {
+		pv->best_line_length = ply;
+		if (e == 0)
+			poke_draw(board->hash);
+		else
+			poke(board->hash, e, ply, bound == HASH_EXACT ? MAXPLY : depth, bound, NULL);
+		return e;
+	}
+
+	//-- Endgame tablebases
+	int wdl;
+	if (tablebase_pieces && probe_wdl(board, &wdl)) {
+		pv->best_line_length = ply;
+		return tablebase_score(wdl, ply);
+	}
+
 	//-- Declare local variables
-    struct t_pv_data *next_pv = &(board->pv_data[ply + 1]);
+    struct t_pv_data *next_pv = &(search_stack->ply[ply + 1]);
     int reduction;
 
     t_chess_value					best_score = -CHESS_INFINITY;
@@ -127,8 +208,8 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
 		//-- Store the move in the PV data
 		pv->current_move = NULL;
 
-		//-- Evaluate the new board position
-		evaluate(board, next_pv->eval);
+		//-- The new position is only evaluated if the child needs it
+		next_pv->eval->evaluated = FALSE;
 
 		//-- Find the new score
 		e = -alphabeta(board, ply + 1, depth - NULL_REDUCTION - 1, -beta, -beta + 1);
@@ -187,17 +268,20 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
 		BOOL fail_low;
 		while (simple_make_next_move(board, moves, undo)){
 
+			//-- The position after the move
+			struct t_board *child = search_board(board, undo);
+
 			//-- Is the opponent in check?
-			if (board->in_check)
+			if (child->in_check)
 				reduction = 0;
 			else
 				reduction = 1;
 
 			//-- Simple version of alpha_beta for tips of search
-			e = -alphabeta_tip(board, ply + 1, depth - reduction, -beta, &fail_low);
+			e = -alphabeta_tip(child, ply + 1, depth - reduction, -beta, &fail_low);
 
 			//-- Take the move back
-			unmake_move(board, undo);
+			search_unmake_move(board, undo);
 
 			//-- Is it good enough for a cutoff?
 			if (e >= beta){
@@ -230,27 +314,30 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
     //-- Play moves
     while (!uci.stop && make_next_move(board, moves, bad_moves, undo)) {
 
+        //-- The position after the move
+        struct t_board *child = search_board(board, undo);
+
         //-- Increment the "legal_moves_played" counter
         pv->legal_moves_played++;
         pv->current_move = moves->current_move;
 
-        //-- Evaluate the new board position
-        evaluate(board, next_pv->eval);
+        //-- The new position is only evaluated if the child needs it
+        next_pv->eval->evaluated = FALSE;
 
         //-- Calculate reduction
-        if (board->in_check)
+        if (child->in_check)
             reduction = 0;
         else
             reduction = 1;
 
         //-- Search the next ply at reduced depth
-        e = -alphabeta(board, ply + 1, depth - reduction, -b, -a);
+        e = -alphabeta(child, ply + 1, depth - reduction, -b, -a);
 
         //-- Is a research required?
 		if (alpha + 1 != beta && e > a && a + 1 == b)
-            e = -alphabeta(board, ply + 1, depth - reduction, -beta, -a);
+            e = -alphabeta(child, ply + 1, depth - reduction, -beta, -a);
 
-        unmake_move(board, undo);
+        search_unmake_move(board, undo);
 
         //-- Is it good enough to cut-off?
         if (e >= beta) {
@@ -312,11 +399,11 @@ t_chess_value alphabeta(struct t_board *board, int ply, int depth, t_chess_value
 t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_value alpha, t_chess_value beta) {
 
 	//-- Principle Variation
-	struct t_pv_data *pv = &(board->pv_data[ply]);
+	struct t_pv_data *pv = &(search_stack->ply[ply]);
 
 	//-- Has the maximum depth been reached
 	if (ply > MAXPLY || uci.stop)
-		return pv->eval->static_score;
+		return get_static_score(board, pv->eval);
 
 	//-- Increment the node count
 	qnodes++;
@@ -335,8 +422,16 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 		return beta;
 	}
 
+	//-- Recognized endings need no search
+	t_chess_value recognized;
+	t_hash_bound bound;
+	if (recognize_ending(board, pv, alpha, beta, &recognized, &bound)) {
+		pv->best_line_length = ply;
+		return recognized;
+	}
+
 	//-- Next Principle Variation
-	struct t_pv_data *next_pv = &(board->pv_data[ply + 1]);
+	struct t_pv_data *next_pv = &(search_stack->ply[ply + 1]);
 
 	//-- Define the local variables
 	pv->legal_moves_played = 0;
@@ -383,21 +478,24 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 		//-- Play moves
 		while (make_next_best_move(board, moves, undo)) {
 
+			//-- The position after the move
+			struct t_board *child = search_board(board, undo);
+
 			//-- Increment the "legal_moves_played" counter
 			pv->legal_moves_played++;
 			pv->current_move = moves->current_move;
 
-			//-- Evaluate the new board position
-			evaluate(board, next_pv->eval);
+			//-- The new position is only evaluated if the child needs it
+			next_pv->eval->evaluated = FALSE;
 
 			//-- More than one move out of check so just use "vanilla" qsearch
-			e = -q_search(board, ply + 1, depth - 1, -b, -a);
+			e = -q_search(child, ply + 1, depth - 1, -b, -a);
 
 			//-- Is a research required?
 			if (alpha + 1 != beta && e > a && a + 1 == b)
-				e = -q_search(board, ply + 1, depth - 1, -beta, -a);
+				e = -q_search(child, ply + 1, depth - 1, -beta, -a);
 
-			unmake_move(board, undo);
+			search_unmake_move(board, undo);
 
 			//-- Is it good enough to cut-off?
 			if (e >= beta){
@@ -431,7 +529,7 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 		//--------------------------------------------------------
 
 		//-- Does stand-pat cause a cut-off?
-		e = pv->eval->static_score;
+		e = get_lazy_score(board, pv->eval, alpha, beta);
 		if (e >= beta)
 			return e;
 
@@ -446,26 +544,29 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 		generate_captures(board, moves);
 
 		//-- Order the moves
-		order_captures(board, moves);
+		order_captures(board, moves, ply);
 
 		//-- Play *ALL* captures
 		while (make_next_best_move(board, moves, undo)) {
 
+			//-- The position after the move
+			struct t_board *child = search_board(board, undo);
+
 			//-- Increment the "legal_moves_played" counter
 			pv->legal_moves_played++;
 			pv->current_move = moves->current_move;
 
-			//-- Evaluate the new board position
-			evaluate(board, next_pv->eval);
+			//-- The new position is only evaluated if the child needs it
+			next_pv->eval->evaluated = FALSE;
 
 			//-- Search the next ply at reduced depth
-			e = -qsearch(board, ply + 1, depth - 1, -b, -a);
+			e = -qsearch(child, ply + 1, depth - 1, -b, -a);
 
 			//-- Is a research required?
 			if (alpha + 1 != beta && e > a && a + 1 == b)
-				e = -qsearch(board, ply + 1, depth - 1, -beta, -a);
+				e = -qsearch(child, ply + 1, depth - 1, -beta, -a);
 
-			unmake_move(board, undo);
+			search_unmake_move(board, undo);
 
 			//-- Is it good enough to cut-off?
 			if (e >= beta){
@@ -497,21 +598,24 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 		//-- Play moves
 		while (make_next_best_move(board, moves, undo)) {
 
+			//-- The position after the move
+			struct t_board *child = search_board(board, undo);
+
 			//-- Increment the "legal_moves_played" counter
 			pv->legal_moves_played++;
 			pv->current_move = moves->current_move;
 
-			//-- Evaluate the new board position
-			evaluate(board, next_pv->eval);
+			//-- The new position is only evaluated if the child needs it
+			next_pv->eval->evaluated = FALSE;
 
 			//-- Search the next ply at reduced depth
-			e = -qsearch_plus(board, ply + 1, depth - 1, -b, -a);
+			e = -qsearch_plus(child, ply + 1, depth - 1, -b, -a);
 
 			//-- Is a research required?
 			if (alpha + 1 != beta && e > a && a + 1 == b)
-				e = -qsearch_plus(board, ply + 1, depth - 1, -beta, -a);
+				e = -qsearch_plus(child, ply + 1, depth - 1, -beta, -a);
 
-			unmake_move(board, undo);
+			search_unmake_move(board, undo);
 
 			//-- Is it good enough to cut-off?
 			if (e >= beta){
@@ -548,11 +652,11 @@ t_chess_value qsearch_plus(struct t_board *board, int ply, int depth, t_chess_va
 t_chess_value qsearch(struct t_board *board, int ply, int depth, t_chess_value alpha, t_chess_value beta) {
 
 	//-- Principle Variation
-	struct t_pv_data *pv = &(board->pv_data[ply]);
+	struct t_pv_data *pv = &(search_stack->ply[ply]);
 
 	//-- Has the maximum depth been reached
     if (ply > MAXPLY || uci.stop)
-        return pv->eval->static_score;
+        return get_static_score(board, pv->eval);
 
     //-- Increment the node count
     qnodes++;
@@ -572,8 +676,16 @@ t_chess_value qsearch(struct t_board *board, int ply, int depth, t_chess_value a
 		return beta;
 	}
 
+	//-- Recognized endings need no search
+	t_chess_value recognized;
+	t_hash_bound bound;
+	if (recognize_ending(board, pv, alpha, beta, &recognized, &bound)) {
+		pv->best_line_length = ply;
+		return recognized;
+	}
+
 	//-- PV of Next Ply
-    struct t_pv_data *next_pv = &(board->pv_data[ply + 1]);
+    struct t_pv_data *next_pv = &(search_stack->ply[ply + 1]);
 
     //-- Define the local variables
 	pv->legal_moves_played = 0;
@@ -612,21 +724,24 @@ t_chess_value qsearch(struct t_board *board, int ply, int depth, t_chess_value a
         //-- Play moves
         while (make_next_best_move(board, moves, undo) && !uci.stop) {
 
+            //-- The position after the move
+            struct t_board *child = search_board(board, undo);
+
             //-- Increment the "legal_moves_played" counter
             pv->legal_moves_played++;
             pv->current_move = moves->current_move;
 
-            //-- Evaluate the new board position
-            evaluate(board, next_pv->eval);
+            //-- The new position is only evaluated if the child needs it
+            next_pv->eval->evaluated = FALSE;
 
             //-- Search the next ply at reduced depth
-            e = -qsearch(board, ply + 1, depth - 1, -b - 1, -a);
+            e = -qsearch(child, ply + 1, depth - 1, -b - 1, -a);
 
             //-- Is a research required?
 			if (alpha + 1 != beta && e > a && a + 1 == b)
-				e = -qsearch(board, ply + 1, depth - 1, -beta, -a);
+				e = -qsearch(child, ply + 1, depth - 1, -beta, -a);
 
-            unmake_move(board, undo);
+            search_unmake_move(board, undo);
 
             //-- Is it good enough to cut-off?
 			if (e >= beta){
@@ -659,7 +774,7 @@ t_chess_value qsearch(struct t_board *board, int ply, int depth, t_chess_value a
         //--------------------------------------------------------
 
         //-- Does stand-pat cause a cutoff?
-        e = pv->eval->static_score;
+        e = get_lazy_score(board, pv->eval, alpha, beta);
         if (e >= beta)
             return e;
 
@@ -674,26 +789,29 @@ t_chess_value qsearch(struct t_board *board, int ply, int depth, t_chess_value a
         generate_captures(board, moves);
 
         //-- Order the moves
-        order_captures(board, moves);
+        order_captures(board, moves, ply);
 
         //-- Play moves
         while (make_next_see_positive_move(board, moves, 0, undo)) {
 
+            //-- The position after the move
+            struct t_board *child = search_board(board, undo);
+
             //-- Increment the "legal_moves_played" counter
             pv->legal_moves_played++;
             pv->current_move = moves->current_move;
 
-            //-- Evaluate the new board position
-            evaluate(board, next_pv->eval);
+            //-- The new position is only evaluated if the child needs it
+            next_pv->eval->evaluated = FALSE;
 
             //-- Search the next ply at reduced depth
-            e = -qsearch(board, ply + 1, depth - 1, -b, -a);
+            e = -qsearch(child, ply + 1, depth - 1, -b, -a);
 
             //-- Is a research required?
 			if (alpha + 1 != beta && e > a && a + 1 == b)
-				e = -qsearch(board, ply + 1, depth - 1, -beta, -a);
+				e = -qsearch(child, ply + 1, depth - 1, -beta, -a);
 
-            unmake_move(board, undo);
+            search_unmake_move(board, undo);
 
             //-- Is it good enough to cut-off?
             if (e >= beta)
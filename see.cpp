@@ -16,6 +16,21 @@
 #include "bittwiddle.h"
 
 
+//-- Least valuable attacker in attackers; leaves its square in *b
+static inline t_chess_piece least_valuable_attacker(struct t_board *board, t_bitboard attackers, t_chess_color color, t_bitboard *b) {
+
+    static const t_chess_piece order[6] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        if (*b = (board->pieces[color][order[i]] & attackers)) {
+            *b &= -*b;
+            return order[i];
+        }
+    }
+    return BLANK;
+}
+
 BOOL see(struct t_board *board, struct t_move_record *move, t_chess_value threshold) {
 
     t_chess_value see_value = see_piece_value[move->captured];
@@ -29,122 +44,42 @@ BOOL see(struct t_board *board, struct t_move_record *move, t_chess_value thresh
     if (see_value < threshold)
         return FALSE;
 
-    t_bitboard attacks[2];
     t_chess_color to_move = COLOR(move->piece);
     t_chess_color opponent = OPPONENT(to_move);
     t_chess_square to_square = move->to_square;
-    t_chess_square s;
+    t_chess_piece piece;
     t_bitboard b;
 
-    //-- Generate Opponent's Pawn Moves
-    attacks[opponent] = pawn_attackers[opponent][to_square] & board->pieces[opponent][PAWN];
-
     //-- See if an opponent's pawn can take and cause a cut-off
-    if (attacks[opponent] && see_value - trophy_value + see_piece_value[PAWN] < threshold)
+    if ((pawn_attackers[opponent][to_square] & board->pieces[opponent][PAWN]) && see_value - trophy_value + see_piece_value[PAWN] < threshold)
         return FALSE;
 
-    //-- Generate Attacks - pawns first
-    attacks[to_move] = pawn_attackers[to_move][to_square] & board->pieces[to_move][PAWN];
-
-    //-- Knights
-    attacks[to_move] |= knight_mask[to_square] & board->pieces[to_move][KNIGHT];
-    attacks[opponent] |= knight_mask[to_square] & board->pieces[opponent][KNIGHT];
+    //-- Sliders which can be uncovered as pieces are exchanged
+    t_bitboard diagonal = board->pieces[WHITE][BISHOP] | board->pieces[BLACK][BISHOP] | board->pieces[WHITE][QUEEN] | board->pieces[BLACK][QUEEN];
+    t_bitboard straight = board->pieces[WHITE][ROOK] | board->pieces[BLACK][ROOK] | board->pieces[WHITE][QUEEN] | board->pieces[BLACK][QUEEN];
 
-    //-- Kings
-    attacks[to_move] |= king_mask[to_square] & board->pieces[to_move][KING];
-    attacks[opponent] |= king_mask[to_square] & board->pieces[opponent][KING];
+    t_bitboard _all_pieces = board->all_pieces ^ SQUARE64(move->from_square);
+    t_bitboard attackers = attackers_to(board, to_square, _all_pieces) & _all_pieces;
 
-    //-- Bishops
-    attacks[to_move] |= bishop_rays[to_square] & (board->pieces[to_move][BISHOP] | board->pieces[to_move][QUEEN]);
-    attacks[opponent] |= bishop_rays[to_square] & (board->pieces[opponent][BISHOP] | board->pieces[opponent][QUEEN]);
-
-    //-- Rooks
-    attacks[to_move] |= rook_rays[to_square] & (board->pieces[to_move][ROOK] | board->pieces[to_move][QUEEN]);
-    attacks[opponent] |= rook_rays[to_square] & (board->pieces[opponent][ROOK] | board->pieces[opponent][QUEEN]);
-
-    t_bitboard _all_pieces = board->all_pieces;
-
-    b = SQUARE64(move->from_square);
-    attacks[to_move] ^= b;
-    _all_pieces ^= b;
+    //-- Pinned pieces can't join in while their pinner is still on the board
+    struct t_check_info *info = get_check_info(board);
 
     do {
 
-        if (!attacks[opponent]) {
-            trophy_value = 0;
-            goto opponent_cut_test;
-        }
-
-        if (b = (board->pieces[opponent][PAWN] & attacks[opponent])) {
+        //-- Opponent captures with the least valuable piece
+        b = attackers & board->occupied[opponent];
+        if (info->pinners[opponent] & _all_pieces)
+            b &= ~info->pinned[opponent];
+        if (piece = least_valuable_attacker(board, b, opponent, &b)) {
             see_value -= trophy_value;
-            trophy_value = see_piece_value[PAWN];
-            b &= -b;
-            attacks[opponent] ^= b;
+            trophy_value = see_piece_value[piece];
             _all_pieces ^= b;
-            goto opponent_cut_test;
-        }
-
-        if (b = (board->pieces[opponent][KNIGHT] & attacks[opponent])) {
-            see_value -= trophy_value;
-            trophy_value = see_piece_value[KNIGHT];
-            b &= -b;
-            attacks[opponent] ^= b;
-            goto opponent_cut_test;
-        }
-
-        if (b = (board->pieces[opponent][BISHOP] & attacks[opponent])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[opponent] ^= b;
-                    _all_pieces ^= b;
-                    see_value -= trophy_value;
-                    trophy_value = see_piece_value[BISHOP];
-                    goto opponent_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[opponent][ROOK] & attacks[opponent])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[opponent] ^= b;
-                    _all_pieces ^= b;
-                    see_value -= trophy_value;
-                    trophy_value = see_piece_value[ROOK];
-                    goto opponent_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[opponent][QUEEN] & attacks[opponent])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[opponent] ^= b;
-                    _all_pieces ^= b;
-                    see_value -= trophy_value;
-                    trophy_value = see_piece_value[QUEEN];
-                    goto opponent_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[opponent][KING] & attacks[opponent])) {
-            see_value -= trophy_value;
-            trophy_value = see_piece_value[KING];
-            b &= -b;
-            attacks[opponent] ^= b;
+            attackers |= (bishop_attacks(to_square, _all_pieces) & diagonal) | (rook_attacks(to_square, _all_pieces) & straight);
+            attackers &= _all_pieces;
         }
         else
             trophy_value = 0;
 
-opponent_cut_test:
-
         //-- Test Upper Bound
         if (see_value >= threshold)
             return TRUE;
@@ -154,81 +89,19 @@ opponent_cut_test:
             return FALSE;
 
         //-- Now try to recapture!
-        if (!attacks[to_move]) {
-            trophy_value = 0;
-            goto to_move_cut_test;
-        }
-
-        if (b = (board->pieces[to_move][PAWN] & attacks[to_move])) {
+        b = attackers & board->occupied[to_move];
+        if (info->pinners[to_move] & _all_pieces)
+            b &= ~info->pinned[to_move];
+        if (piece = least_valuable_attacker(board, b, to_move, &b)) {
             see_value += trophy_value;
-            trophy_value = see_piece_value[PAWN];
-            b &= -b;
-            attacks[to_move] ^= b;
+            trophy_value = see_piece_value[piece];
             _all_pieces ^= b;
-            goto to_move_cut_test;
-        }
-
-        if (b = (board->pieces[to_move][KNIGHT] & attacks[to_move])) {
-            see_value += trophy_value;
-            trophy_value = see_piece_value[KNIGHT];
-            b &= -b;
-            attacks[to_move] ^= b;
-            goto to_move_cut_test;
-        }
-
-        if (b = (board->pieces[to_move][BISHOP] & attacks[to_move])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[to_move] ^= b;
-                    _all_pieces ^= b;
-                    see_value += trophy_value;
-                    trophy_value = see_piece_value[BISHOP];
-                    goto to_move_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[to_move][ROOK] & attacks[to_move])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[to_move] ^= b;
-                    _all_pieces ^= b;
-                    see_value += trophy_value;
-                    trophy_value = see_piece_value[ROOK];
-                    goto to_move_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[to_move][QUEEN] & attacks[to_move])) {
-            do {
-                s = bitscan_reset(&b);
-                if (!(between[s][to_square] & _all_pieces)) {
-                    b = SQUARE64(s);
-                    attacks[to_move] ^= b;
-                    _all_pieces ^= b;
-                    see_value += trophy_value;
-                    trophy_value = see_piece_value[QUEEN];
-                    goto to_move_cut_test;
-                }
-            } while (b);
-        }
-
-        if (b = (board->pieces[to_move][KING] & attacks[to_move])) {
-            see_value += trophy_value;
-            trophy_value = see_piece_value[KING];
-            b &= -b;
-            attacks[to_move] ^= b;
+            attackers |= (bishop_attacks(to_square, _all_pieces) & diagonal) | (rook_attacks(to_square, _all_pieces) & straight);
+            attackers &= _all_pieces;
         }
         else
             trophy_value = 0;
 
-to_move_cut_test:
-
         if (see_value - trophy_value >= threshold)
             return TRUE;
 
@@ -240,4 +113,4 @@ to_move_cut_test:
 
     return TRUE;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,550 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <Windows.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "defs.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// Endgame Tablebases
+//
+// Every 3 and 4 man ending is built by "tbgen" (tbgen.cpp) and
+// read from the "TablebasePath" directory.  Each table has two
+// files, <name>.mtw and <name>.mtz, e.g. KRvKN.mtw:
+//
+//   8 bytes   magic, "MAVTBW1" (WDL) or "MAVTBZ1" (DTZ)
+//   8 bytes   number of positions (unsigned, little endian)
+//   WDL       2 bits per position: TB_DRAW, TB_WIN, TB_LOSS or
+//             TB_ILLEGAL, four positions to a byte, first in
+//             the low bits
+//   DTZ       1 byte per position: plies to the next capture or
+//             pawn move for wins and losses, 0 otherwise
+//
+// Results are from the side to move's point of view.  White is
+// always the side named first; positions where black has that
+// material are looked up with the board flipped.  The index is
+//
+//   side to move, white king, black king, then each other piece
+//
+// where the white king is kept on files a-d (tables with pawns)
+// or in the a1-d1-d4 triangle (no pawns) by mirroring the board,
+// pawns only use ranks 2-7, and two identical pieces are stored
+// lowest square first.  Castling and en-passant rights are not
+// stored, so such positions are never probed.  The 50 move rule
+// is ignored.
+//===========================================================//
+
+//-- a1-d1-d4 triangle
+static const int triangle[64] = {
+	 0,  1,  2,  3, -1, -1, -1, -1,
+	-1,  4,  5,  6, -1, -1, -1, -1,
+	-1, -1,  7,  8, -1, -1, -1, -1,
+	-1, -1, -1,  9, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1
+};
+static const t_chess_square triangle_square[10] = { A1, B1, C1, D1, B2, C2, D2, C3, D3, D4 };
+
+static inline t_chess_square transpose(t_chess_square s)
+{
+	return ((s & 7) << 3) | (s >> 3);
+}
+
+static inline int piece_range(struct t_tablebase *tb, int slot)
+{
+	if (slot == 0)
+		return (tb->pawns ? 32 : 10);
+	if (slot > 1 && PIECETYPE(tb->piece[slot]) == PAWN)
+		return 48;
+	return 64;
+}
+
+//-- Mixed radix index of squares already in canonical orientation
+static unsigned int encode(struct t_tablebase *tb, t_chess_color to_move, t_chess_square *square)
+{
+	t_chess_square s[TB_MAX_PIECES];
+	unsigned int index;
+
+	memcpy(s, square, sizeof(s));
+
+	//-- Identical pieces are stored lowest square first
+	for (int i = 2; i < tb->count - 1; i++) {
+		if (tb->piece[i] == tb->piece[i + 1] && s[i] > s[i + 1]) {
+			t_chess_square t = s[i];
+			s[i] = s[i + 1];
+			s[i + 1] = t;
+		}
+	}
+
+	index = (tb->pawns ? RANK(s[0]) * 4 + COLUMN(s[0]) : triangle[s[0]]);
+	index = index * 64 + s[1];
+	for (int i = 2; i < tb->count; i++)
+		index = index * piece_range(tb, i) + (PIECETYPE(tb->piece[i]) == PAWN ? s[i] - 8 : s[i]);
+
+	return to_move * (tb->size / 2) + index;
+}
+
+//-- Index of a position whose pieces are in the table's order
+unsigned int tb_index(struct t_tablebase *tb, struct t_tb_position *p)
+{
+	t_chess_square s[TB_MAX_PIECES];
+	int i;
+
+	if (tb->pawns) {
+		int mirror = (COLUMN(p->square[0]) > 3 ? 7 : 0);
+		for (i = 0; i < tb->count; i++)
+			s[i] = p->square[i] ^ mirror;
+		return encode(tb, p->to_move, s);
+	}
+
+	int flip = (COLUMN(p->square[0]) > 3 ? 7 : 0) ^ (RANK(p->square[0]) > 3 ? 56 : 0);
+	for (i = 0; i < tb->count; i++)
+		s[i] = p->square[i] ^ flip;
+
+	if (RANK(s[0]) > COLUMN(s[0])) {
+		for (i = 0; i < tb->count; i++)
+			s[i] = transpose(s[i]);
+	}
+
+	unsigned int index = encode(tb, p->to_move, s);
+
+	//-- A king on the diagonal leaves two ways of writing the position, take the lower
+	if (RANK(s[0]) == COLUMN(s[0])) {
+		for (i = 0; i < tb->count; i++)
+			s[i] = transpose(s[i]);
+		unsigned int other = encode(tb, p->to_move, s);
+		if (other < index)
+			index = other;
+	}
+
+	return index;
+}
+
+//-- The position an index stands for (which may be illegal or not canonical)
+void tb_decode(struct t_tablebase *tb, unsigned int index, struct t_tb_position *p)
+{
+	p->count = tb->count;
+	p->to_move = (index >= tb->size / 2 ? BLACK : WHITE);
+	index %= tb->size / 2;
+
+	for (int i = tb->count - 1; i >= 0; i--) {
+		int range = piece_range(tb, i);
+		int s = index % range;
+		index /= range;
+
+		p->piece[i] = tb->piece[i];
+		if (i == 0)
+			p->square[i] = (tb->pawns ? (s / 4) * 8 + (s % 4) : triangle_square[s]);
+		else
+			p->square[i] = (range == 48 ? s + 8 : s);
+	}
+}
+
+//-- Four bits for each piece count, so every set of material has its own key
+static t_hash material_key(const int material[16])
+{
+	t_hash key = 0;
+	for (int i = 0; i < 16; i++)
+		key |= (t_hash)material[i] << (4 * i);
+	return key;
+}
+
+//-- Fill in a table's pieces, keys and size from its name
+static void init_tablebase(struct t_tablebase *tb, const char *name)
+{
+	int material[16];
+	int flipped[16];
+	t_chess_color color = WHITE;
+
+	memset(tb, 0, sizeof(struct t_tablebase));
+	strcpy(tb->name, name);
+	memset(material, 0, sizeof(material));
+	memset(flipped, 0, sizeof(flipped));
+
+	tb->piece[0] = WHITEKING;
+	tb->piece[1] = BLACKKING;
+	tb->count = 2;
+
+	for (const char *c = name; *c; c++) {
+		t_chess_piece piece_type = 0;
+		switch (*c) {
+		case 'v': color = BLACK; break;
+		case 'Q': piece_type = QUEEN; break;
+		case 'R': piece_type = ROOK; break;
+		case 'B': piece_type = BISHOP; break;
+		case 'N': piece_type = KNIGHT; break;
+		case 'P': piece_type = PAWN; break;
+		}
+		if (piece_type) {
+			tb->piece[tb->count++] = PIECEINDEX(color, piece_type);
+			material[PIECEINDEX(color, piece_type)]++;
+			flipped[PIECEINDEX(OPPONENT(color), piece_type)]++;
+			if (piece_type == PAWN)
+				tb->pawns = TRUE;
+		}
+	}
+
+	tb->key = material_key(material);
+	tb->flipped_key = material_key(flipped);
+
+	tb->size = 2;
+	for (int i = 0; i < tb->count; i++)
+		tb->size *= piece_range(tb, i);
+}
+
+//-- Table descriptions for every ending (nothing is loaded)
+void init_tablebases()
+{
+	for (int i = 0; i < TB_TABLE_COUNT; i++)
+		init_tablebase(&tablebase[i], tablebase_names[i]);
+	tablebase_count = 0;
+	tablebase_pieces = 0;
+}
+
+static void *map_file(char *filename, size_t expected_size)
+{
+	void *view = NULL;
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file, &file_size) && (size_t)file_size.QuadPart == expected_size) {
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping != NULL) {
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd, &st) == 0 && (size_t)st.st_size == expected_size) {
+			view = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (view == MAP_FAILED)
+				view = NULL;
+		}
+		close(fd);
+	}
+#endif
+
+	return view;
+}
+
+static void unmap_file(void *view, size_t size)
+{
+#if defined(_WIN32)
+	UnmapViewOfFile(view);
+#else
+	munmap(view, size);
+#endif
+}
+
+static BOOL valid_header(const uchar *view, const char *magic, unsigned int size)
+{
+	unsigned long long count;
+
+	memcpy(&count, view + 8, sizeof(count));
+	return memcmp(view, magic, 8) == 0 && count == size;
+}
+
+void tablebase_file_name(char *filename, char *path, const char *name, const char *extension)
+{
+	size_t l = strlen(path);
+
+	if (l && (path[l - 1] == '/' || path[l - 1] == '\\'))
+		sprintf(filename, "%s%s.%s", path, name, extension);
+	else
+		sprintf(filename, "%s/%s.%s", path, name, extension);
+}
+
+void unload_tablebase(struct t_tablebase *tb)
+{
+	if (tb->mapped) {
+		if (tb->wdl_view) unmap_file(tb->wdl_view, tb->wdl_size);
+		if (tb->dtz_view) unmap_file(tb->dtz_view, tb->dtz_size);
+	}
+	else {
+		free(tb->wdl_view);
+		free(tb->dtz_view);
+	}
+	tb->wdl = tb->dtz = NULL;
+	tb->wdl_view = tb->dtz_view = NULL;
+	tb->mapped = FALSE;
+}
+
+void unload_tablebases()
+{
+	for (int i = 0; i < TB_TABLE_COUNT; i++)
+		unload_tablebase(&tablebase[i]);
+	tablebase_count = 0;
+	tablebase_pieces = 0;
+}
+
+//-- Tables are only used once everything they lead to is there too
+static void update_tablebase_pieces()
+{
+	tablebase_count = 0;
+	tablebase_pieces = 0;
+	for (int i = 0; i < TB_TABLE_COUNT; i++) {
+		if (tablebase[i].wdl) {
+			tablebase_count++;
+			if (tablebase[i].count > tablebase_pieces)
+				tablebase_pieces = tablebase[i].count;
+		}
+	}
+	for (int i = 0; i < TB_TABLE_COUNT; i++) {
+		if (tablebase[i].wdl == NULL && tablebase[i].count <= tablebase_pieces)
+			tablebase_pieces = tablebase[i].count - 1;
+	}
+	if (tablebase_pieces < 3)
+		tablebase_pieces = 0;
+}
+
+//-- Map one table's files (the DTZ file is optional)
+BOOL load_tablebase(struct t_tablebase *tb, char *path)
+{
+	char filename[FILENAME_MAX];
+
+	unload_tablebase(tb);
+
+	tb->wdl_size = TB_HEADER_SIZE + (tb->size + 3) / 4;
+	tablebase_file_name(filename, path, tb->name, "mtw");
+	tb->wdl_view = map_file(filename, tb->wdl_size);
+	if (tb->wdl_view == NULL)
+		return FALSE;
+	tb->mapped = TRUE;
+	if (!valid_header((uchar *)tb->wdl_view, TB_WDL_MAGIC, tb->size)) {
+		unload_tablebase(tb);
+		return FALSE;
+	}
+	tb->wdl = (uchar *)tb->wdl_view + TB_HEADER_SIZE;
+
+	tb->dtz_size = TB_HEADER_SIZE + tb->size;
+	tablebase_file_name(filename, path, tb->name, "mtz");
+	tb->dtz_view = map_file(filename, tb->dtz_size);
+	if (tb->dtz_view != NULL) {
+		if (valid_header((uchar *)tb->dtz_view, TB_DTZ_MAGIC, tb->size))
+			tb->dtz = (uchar *)tb->dtz_view + TB_HEADER_SIZE;
+		else {
+			unmap_file(tb->dtz_view, tb->dtz_size);
+			tb->dtz_view = NULL;
+		}
+	}
+
+	update_tablebase_pieces();
+	return TRUE;
+}
+
+//-- Use tables built in memory by the generator
+void set_tablebase_memory(struct t_tablebase *tb, uchar *wdl, uchar *dtz)
+{
+	unload_tablebase(tb);
+	tb->wdl_view = wdl;
+	tb->dtz_view = dtz;
+	tb->wdl = wdl;
+	tb->dtz = dtz;
+	update_tablebase_pieces();
+}
+
+//-- "TablebasePath"
+void set_tablebase_path(char *path)
+{
+	char name[FILENAME_MAX];
+	char s[FILENAME_MAX + 64];
+
+	strncpy(name, path, sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+	char *p = strchr(name, '\n');
+	if (p) *p = 0;
+
+	unload_tablebases();
+	if (name[0] == 0 || !strcmp(name, "<empty>"))
+		return;
+
+	for (int i = 0; i < TB_TABLE_COUNT; i++)
+		load_tablebase(&tablebase[i], name);
+
+	sprintf(s, "%d tablebases found in %s (complete up to %d pieces)", tablebase_count, name, tablebase_pieces);
+	send_info(s);
+}
+
+//-- The table for a set of pieces and whether it has to be read with the colours swapped
+static struct t_tablebase *find_tablebase(t_hash key, BOOL *flipped)
+{
+	for (int i = 0; i < TB_TABLE_COUNT; i++) {
+		if (tablebase[i].key == key) {
+			*flipped = FALSE;
+			return &tablebase[i];
+		}
+		if (tablebase[i].flipped_key == key) {
+			*flipped = TRUE;
+			return &tablebase[i];
+		}
+	}
+	return NULL;
+}
+
+static inline int read_wdl(struct t_tablebase *tb, unsigned int index)
+{
+	return (tb->wdl[index >> 2] >> (2 * (index & 3))) & 3;
+}
+
+//-- Result of any position of up to TB_MAX_PIECES, the pieces in any order; -1 if the table is missing.
+//-- dtz is set to -1 when the table has no DTZ file
+int tb_probe_position(struct t_tb_position *p, int *dtz)
+{
+	struct t_tb_position q;
+	int material[16];
+	BOOL flipped;
+	BOOL used[TB_MAX_PIECES];
+	int i, j;
+
+	if (dtz) *dtz = 0;
+
+	//-- Bare kings
+	if (p->count == 2)
+		return TB_DRAW;
+
+	memset(material, 0, sizeof(material));
+	for (i = 0; i < p->count; i++) {
+		if (PIECETYPE(p->piece[i]) != KING)
+			material[p->piece[i]]++;
+	}
+
+	struct t_tablebase *tb = find_tablebase(material_key(material), &flipped);
+	if (tb == NULL || tb->wdl == NULL)
+		return -1;
+
+	//-- Put the pieces in the table's order, as seen from the table's side
+	q.count = p->count;
+	q.to_move = (flipped ? OPPONENT(p->to_move) : p->to_move);
+	memset(used, 0, sizeof(used));
+	for (i = 0; i < tb->count; i++) {
+		for (j = 0; j < p->count; j++) {
+			t_chess_piece piece = (flipped ? FLIPPIECECOLOR(p->piece[j]) : p->piece[j]);
+			if (!used[j] && piece == tb->piece[i]) {
+				used[j] = TRUE;
+				q.piece[i] = piece;
+				q.square[i] = (flipped ? FLIP64(p->square[j]) : p->square[j]);
+				break;
+			}
+		}
+	}
+
+	unsigned int index = tb_index(tb, &q);
+	if (dtz)
+		*dtz = (tb->dtz ? tb->dtz[index] : -1);
+	return read_wdl(tb, index);
+}
+
+static void board_to_tb_position(struct t_board *board, struct t_tb_position *p)
+{
+	p->count = 0;
+	p->to_move = board->to_move;
+	for (t_chess_piece piece = WHITEKNIGHT; piece <= BLACKKING; piece++) {
+		t_bitboard b = board->piecelist[piece];
+		while (b && p->count < TB_MAX_PIECES) {
+			p->piece[p->count] = piece;
+			p->square[p->count++] = bitscan_reset(&b);
+		}
+	}
+}
+
+//-- Win / draw / loss for the side to move; FALSE if the position can't be probed
+BOOL probe_wdl(struct t_board *board, int *wdl)
+{
+	struct t_tb_position p;
+
+	if (board->castling || board->ep_square || popcount(board->all_pieces) > tablebase_pieces)
+		return FALSE;
+
+	board_to_tb_position(board, &p);
+	*wdl = tb_probe_position(&p, NULL);
+	return (*wdl >= 0 && *wdl != TB_ILLEGAL);
+}
+
+//-- Score of a tablebase result for the side to move (quicker wins are better)
+t_chess_value tablebase_score(int wdl, int ply)
+{
+	if (wdl == TB_WIN)
+		return TB_WIN_SCORE - ply;
+	if (wdl == TB_LOSS)
+		return -TB_WIN_SCORE + ply;
+	return 0;
+}
+
+//-- The move at the root which keeps the best result and gets to the next capture or pawn move quickest
+//-- (or puts it off for longest when losing); NULL if the root can't be settled by the tables
+struct t_move_record *probe_root_tablebase(struct t_board *board, t_chess_value *score)
+{
+	struct t_move_list move_list[1];
+	struct t_tb_position p;
+	struct t_undo undo[1];
+	struct t_move_record *best_move = NULL;
+	int root_wdl, wdl, dtz, rank;
+	int best_rank = 0;
+
+	if (!probe_wdl(board, &root_wdl))
+		return NULL;
+
+	generate_legal_moves(board, move_list);
+	for (int i = 0; i < move_list->count; i++) {
+		struct t_move_record *move = move_list->move[i];
+		BOOL zeroing = (move->captured || PIECETYPE(move->piece) == PAWN);
+
+		make_move(board, move, undo);
+		board_to_tb_position(board, &p);
+		wdl = tb_probe_position(&p, &dtz);
+		BOOL mate = is_checkmate(board);
+		unmake_move(board, undo);
+
+		//-- Every table the position leads to must be there, with its DTZ
+		if (wdl < 0 || (!zeroing && wdl != TB_DRAW && dtz < 0))
+			return NULL;
+
+		if (root_wdl == TB_WIN && wdl == TB_LOSS) {
+			rank = (mate ? -1 : (zeroing ? 0 : dtz));
+			if (best_move == NULL || rank < best_rank) {
+				best_move = move;
+				best_rank = rank;
+			}
+		}
+		else if (root_wdl == TB_DRAW && wdl == TB_DRAW) {
+			if (best_move == NULL)
+				best_move = move;
+		}
+		else if (root_wdl == TB_LOSS) {
+			rank = (zeroing ? 0 : dtz);
+			if (best_move == NULL || rank > best_rank) {
+				best_move = move;
+				best_rank = rank;
+			}
+		}
+	}
+
+	*score = tablebase_score(root_wdl, 0);
+	return best_move;
+}
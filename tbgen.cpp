@@ -0,0 +1,598 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <windows.h>
+#include <process.h>
+
+#include "defs.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+//===========================================================//
+// Tablebase Generator
+//
+// Each table is solved by retrograde analysis:
+//
+//   1. Every index is looked at once (in parallel).  Mates are
+//      lost, stalemates drawn, and moves which leave the table
+//      ("exits": captures, promotions and, when counting DTZ,
+//      pawn moves) are read from the tables already built.  The
+//      rest keep a count of their moves which stay in the table.
+//   2. Level by level, the positions just settled are un-moved
+//      (in parallel) to find their predecessors: a predecessor
+//      of a loss is a win, and a predecessor runs out of moves
+//      when all of them lead to wins for the opponent.
+//   3. Whatever is left is a draw.
+//
+// Tables with pawns are first solved for win / draw / loss with
+// pawn moves inside the table, then again counting DTZ with pawn
+// moves as exits; this last pass is repeated until nothing
+// changes as a double push read from the previous pass may allow
+// an en-passant capture the table doesn't store.
+//===========================================================//
+
+#define TBGEN_MAX_THREADS			64
+#define TBGEN_MAX_MOVES				128
+#define TBGEN_MAX_PASSES			16
+#define TBGEN_CHUNK					(1 << 20)	// source positions un-moved between each update
+#define TBGEN_UNKNOWN				4
+#define TBGEN_DRAW_EXIT				0x80		// in count[]: a move out of the table draws
+#define TBGEN_LOST					0x80000000	// in the predecessor lists: the position un-moved from is lost
+
+struct t_tbgen
+{
+	struct t_tablebase						*tb;
+	uchar									*result;
+	uchar									*dist;
+	uchar									*count;
+	const uchar								*previous;			// last pass's results, for pawn moves when counting DTZ
+	BOOL									dtz;				// pawn moves leave the table
+	BOOL									missing;			// a table this one leads to isn't there
+	int										level;
+};
+
+struct t_tbgen_thread
+{
+	struct t_tbgen							*gen;
+	unsigned int							first;
+	unsigned int							last;
+	unsigned int							*pred;
+	unsigned int							pred_count;
+	unsigned int							pred_size;
+};
+
+struct t_tb_move
+{
+	struct t_tb_position					child;
+	BOOL									exit;				// capture or promotion
+	BOOL									pawn;
+	int										ep_square;			// the square passed over by a double push, -1 otherwise
+};
+
+static t_bitboard tb_occupied(struct t_tb_position *p, int color)
+{
+	t_bitboard b = 0;
+	for (int i = 0; i < p->count; i++) {
+		if (color < 0 || COLOR(p->piece[i]) == color)
+			b |= SQUARE64(p->square[i]);
+	}
+	return b;
+}
+
+static t_bitboard tb_attacks(t_chess_piece piece, t_chess_square s, t_bitboard occupied)
+{
+	t_bitboard b = SQUARE64(s);
+
+	switch (PIECETYPE(piece)) {
+	case KNIGHT: return knight_mask[s];
+	case BISHOP: return bishop_attacks(s, occupied);
+	case ROOK: return rook_attacks(s, occupied);
+	case QUEEN: return rook_attacks(s, occupied) | bishop_attacks(s, occupied);
+	case KING: return king_mask[s];
+	case PAWN: return (((b & B8H1) << 7) >> (16 * COLOR(piece))) | (((b & A8G1) << 9) >> (16 * COLOR(piece)));
+	}
+	return 0;
+}
+
+static BOOL tb_in_check(struct t_tb_position *p, t_chess_color color)
+{
+	t_bitboard occupied = tb_occupied(p, -1);
+	t_chess_square king = 0;
+	int i;
+
+	for (i = 0; i < p->count; i++) {
+		if (p->piece[i] == PIECEINDEX(color, KING))
+			king = p->square[i];
+	}
+	for (i = 0; i < p->count; i++) {
+		if (COLOR(p->piece[i]) != color && (tb_attacks(p->piece[i], p->square[i], occupied) & SQUARE64(king)))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void tb_remove(struct t_tb_position *p, int i)
+{
+	for (int j = i; j < p->count - 1; j++) {
+		p->piece[j] = p->piece[j + 1];
+		p->square[j] = p->square[j + 1];
+	}
+	p->count--;
+}
+
+static void tb_add_move(struct t_tb_position *p, int i, t_chess_square to, t_chess_piece promote_to, int ep_square, struct t_tb_move *moves, int *n)
+{
+	struct t_tb_move *m = &moves[*n];
+	t_chess_color color = p->to_move;
+
+	m->child = *p;
+	m->child.to_move = OPPONENT(color);
+	m->child.square[i] = to;
+	m->exit = (promote_to != 0);
+	m->pawn = (PIECETYPE(p->piece[i]) == PAWN);
+	m->ep_square = ep_square;
+	if (promote_to)
+		m->child.piece[i] = promote_to;
+
+	for (int j = 0; j < p->count; j++) {
+		if (j != i && p->square[j] == to) {
+			tb_remove(&m->child, j);
+			m->exit = TRUE;
+			break;
+		}
+	}
+
+	if (!tb_in_check(&m->child, color))
+		(*n)++;
+}
+
+//-- Legal moves (without en-passant captures, which the tables never need to make)
+static int tb_generate_moves(struct t_tb_position *p, struct t_tb_move *moves)
+{
+	t_chess_color color = p->to_move;
+	t_bitboard occupied = tb_occupied(p, -1);
+	t_bitboard enemy = tb_occupied(p, OPPONENT(color));
+	t_bitboard b;
+	int n = 0;
+
+	//-- Kings are never taken in a legal position
+	for (int i = 0; i < p->count; i++) {
+		if (p->piece[i] == PIECEINDEX(OPPONENT(color), KING))
+			enemy &= ~SQUARE64(p->square[i]);
+	}
+
+	for (int i = 0; i < p->count; i++) {
+		t_chess_piece piece = p->piece[i];
+		t_chess_square s = p->square[i];
+
+		if (COLOR(piece) != color)
+			continue;
+
+		if (PIECETYPE(piece) == PAWN) {
+			int forward = (color == WHITE ? 8 : -8);
+			int last_rank = (color == WHITE ? 7 : 0);
+			int start_rank = (color == WHITE ? 1 : 6);
+
+			b = tb_attacks(piece, s, occupied) & enemy;
+			if (!(occupied & SQUARE64(s + forward)))
+				b |= SQUARE64(s + forward);
+
+			while (b) {
+				t_chess_square to = bitscan_reset(&b);
+				if (RANK(to) == last_rank) {
+					for (t_chess_piece promote = QUEEN; promote >= KNIGHT; promote--)
+						tb_add_move(p, i, to, PIECEINDEX(color, promote), -1, moves, &n);
+				}
+				else
+					tb_add_move(p, i, to, 0, -1, moves, &n);
+			}
+
+			if (RANK(s) == start_rank && !(occupied & (SQUARE64(s + forward) | SQUARE64(s + 2 * forward))))
+				tb_add_move(p, i, s + 2 * forward, 0, s + forward, moves, &n);
+		}
+		else {
+			b = tb_attacks(piece, s, occupied) & (~occupied | enemy);
+			while (b)
+				tb_add_move(p, i, bitscan_reset(&b), 0, -1, moves, &n);
+		}
+	}
+
+	return n;
+}
+
+//-- Win / draw / loss order, worst first, for the side to move
+static inline int tb_rank(int wdl)
+{
+	return (wdl == TB_LOSS ? 0 : (wdl == TB_DRAW ? 1 : 2));
+}
+
+//-- Value of a pawn move's child from the last pass, adding any en-passant capture it allows
+static int tb_pawn_move_value(struct t_tbgen *gen, struct t_tb_move *move)
+{
+	struct t_tb_move moves[TBGEN_MAX_MOVES];
+	struct t_tb_position *c = &move->child;
+	int value = gen->previous[tb_index(gen->tb, c)];
+
+	if (move->ep_square < 0)
+		return value;
+
+	t_chess_piece enemy_pawn = PIECEINDEX(c->to_move, PAWN);
+	t_chess_square to = (t_chess_square)(move->ep_square + (c->to_move == BLACK ? 8 : -8));
+	int best_ep = -1;
+
+	for (int i = 0; i < c->count; i++) {
+		if (c->piece[i] != enemy_pawn || RANK(c->square[i]) != RANK(to) || abs(COLUMN(c->square[i]) - COLUMN(to)) != 1)
+			continue;
+
+		struct t_tb_position after = *c;
+		after.square[i] = move->ep_square;
+		after.to_move = OPPONENT(c->to_move);
+		for (int j = 0; j < after.count; j++) {
+			if (after.square[j] == to && j != i) {
+				tb_remove(&after, j);
+				break;
+			}
+		}
+		if (tb_in_check(&after, c->to_move))
+			continue;
+
+		int v = tb_probe_position(&after, NULL);
+		if (v < 0) {
+			gen->missing = TRUE;
+			continue;
+		}
+		v = (v == TB_WIN ? TB_LOSS : (v == TB_LOSS ? TB_WIN : TB_DRAW));
+		if (best_ep < 0 || tb_rank(v) > tb_rank(best_ep))
+			best_ep = v;
+	}
+
+	if (best_ep < 0)
+		return value;
+
+	//-- With no other move the capture is forced
+	if (tb_generate_moves(c, moves) == 0 || tb_rank(best_ep) > tb_rank(value))
+		return best_ep;
+	return value;
+}
+
+//-- Settle what can be settled without looking at other positions in the table
+static unsigned __stdcall tbgen_init_thread(void *arguments)
+{
+	struct t_tbgen_thread *thread = (struct t_tbgen_thread *)arguments;
+	struct t_tbgen *gen = thread->gen;
+	struct t_tablebase *tb = gen->tb;
+	struct t_tb_move moves[TBGEN_MAX_MOVES];
+	struct t_tb_position p;
+	unsigned int inside[TBGEN_MAX_MOVES];
+
+	for (unsigned int index = thread->first; index < thread->last; index++) {
+		gen->dist[index] = 0;
+		gen->count[index] = 0;
+
+		tb_decode(tb, index, &p);
+		if (popcount(tb_occupied(&p, -1)) != p.count || tb_in_check(&p, OPPONENT(p.to_move)) || tb_index(tb, &p) != index) {
+			gen->result[index] = TB_ILLEGAL;
+			continue;
+		}
+
+		int n = tb_generate_moves(&p, moves);
+		if (n == 0) {
+			gen->result[index] = (tb_in_check(&p, p.to_move) ? TB_LOSS : TB_DRAW);
+			continue;
+		}
+
+		BOOL win = FALSE;
+		BOOL draw = FALSE;
+		int inside_count = 0;
+
+		for (int i = 0; i < n && !win; i++) {
+			int v;
+			if (moves[i].exit)
+				v = tb_probe_position(&moves[i].child, NULL);
+			else if (gen->dtz && moves[i].pawn)
+				v = tb_pawn_move_value(gen, &moves[i]);
+			else {
+				unsigned int child = tb_index(tb, &moves[i].child);
+				int j;
+				for (j = 0; j < inside_count && inside[j] != child; j++);
+				if (j == inside_count)
+					inside[inside_count++] = child;
+				continue;
+			}
+
+			if (v < 0)
+				gen->missing = TRUE;
+			else if (v == TB_LOSS)
+				win = TRUE;
+			else if (v == TB_DRAW)
+				draw = TRUE;
+		}
+
+		if (win) {
+			gen->result[index] = TB_WIN;
+			gen->dist[index] = 1;
+		}
+		else if (inside_count == 0) {
+			gen->result[index] = (draw ? TB_DRAW : TB_LOSS);
+			gen->dist[index] = (draw ? 0 : 1);
+		}
+		else {
+			gen->result[index] = TBGEN_UNKNOWN;
+			gen->count[index] = (uchar)inside_count | (draw ? TBGEN_DRAW_EXIT : 0);
+		}
+	}
+
+	return 0;
+}
+
+//-- Unsettled predecessors of the positions settled at the current level
+static unsigned __stdcall tbgen_unmove_thread(void *arguments)
+{
+	struct t_tbgen_thread *thread = (struct t_tbgen_thread *)arguments;
+	struct t_tbgen *gen = thread->gen;
+	struct t_tablebase *tb = gen->tb;
+	struct t_tb_position c, y;
+	unsigned int pred[TBGEN_MAX_MOVES * 2];
+
+	thread->pred_count = 0;
+
+	for (unsigned int index = thread->first; index < thread->last; index++) {
+		if (gen->dist[index] != gen->level || (gen->result[index] != TB_WIN && gen->result[index] != TB_LOSS))
+			continue;
+
+		tb_decode(tb, index, &c);
+		t_chess_color mover = OPPONENT(c.to_move);
+		t_bitboard occupied = tb_occupied(&c, -1);
+		int pred_count = 0;
+
+		for (int i = 0; i < c.count; i++) {
+			t_chess_piece piece = c.piece[i];
+			t_chess_square s = c.square[i];
+			t_bitboard from;
+
+			if (COLOR(piece) != mover)
+				continue;
+
+			if (PIECETYPE(piece) == PAWN) {
+				if (gen->dtz)
+					continue;
+				int back = (mover == WHITE ? -8 : 8);
+				from = 0;
+				if (RANK(s + back) >= 1 && RANK(s + back) <= 6 && !(occupied & SQUARE64(s + back))) {
+					from |= SQUARE64(s + back);
+					if (RANK(s) == (mover == WHITE ? 3 : 4) && !(occupied & SQUARE64(s + 2 * back)))
+						from |= SQUARE64(s + 2 * back);
+				}
+			}
+			else
+				from = tb_attacks(piece, s, occupied) & ~occupied;
+
+			while (from) {
+				y = c;
+				y.square[i] = bitscan_reset(&from);
+				y.to_move = mover;
+				if (tb_in_check(&y, c.to_move))
+					continue;
+
+				unsigned int p = tb_index(tb, &y);
+				if (gen->result[p] != TBGEN_UNKNOWN)
+					continue;
+
+				int j;
+				for (j = 0; j < pred_count && pred[j] != p; j++);
+				if (j == pred_count)
+					pred[pred_count++] = p;
+			}
+		}
+
+		if (thread->pred_count + pred_count > thread->pred_size) {
+			thread->pred_size = 2 * thread->pred_size + pred_count;
+			thread->pred = (unsigned int *)realloc(thread->pred, thread->pred_size * sizeof(unsigned int));
+			assert(thread->pred);
+		}
+		for (int j = 0; j < pred_count; j++)
+			thread->pred[thread->pred_count++] = pred[j] | (gen->result[index] == TB_LOSS ? TBGEN_LOST : 0);
+	}
+
+	return 0;
+}
+
+//-- Split [first, last) between the threads and wait for them all
+static void tbgen_run(unsigned (__stdcall *function)(void *), struct t_tbgen_thread *thread, int threads, unsigned int first, unsigned int last)
+{
+	HANDLE handle[TBGEN_MAX_THREADS];
+	unsigned int id;
+	unsigned int slice = (last - first + threads - 1) / threads;
+
+	for (int t = 0; t < threads; t++) {
+		thread[t].first = first + t * slice;
+		thread[t].last = thread[t].first + slice;
+		if (thread[t].first > last) thread[t].first = last;
+		if (thread[t].last > last) thread[t].last = last;
+		handle[t] = (HANDLE)_beginthreadex(NULL, 0, function, &thread[t], 0, &id);
+	}
+	for (int t = 0; t < threads; t++) {
+		WaitForSingleObject(handle[t], INFINITE);
+		CloseHandle(handle[t]);
+	}
+}
+
+//-- One complete solve of the table; FALSE if a table it leads to is missing
+static BOOL tbgen_pass(struct t_tbgen *gen, struct t_tbgen_thread *thread, int threads)
+{
+	unsigned int size = gen->tb->size;
+	int max_level = 1;
+
+	gen->missing = FALSE;
+	tbgen_run(&tbgen_init_thread, thread, threads, 0, size);
+	if (gen->missing)
+		return FALSE;
+
+	for (gen->level = 0; gen->level <= max_level; gen->level++) {
+		assert(gen->level < 255);
+		uchar next = (uchar)(gen->level + 1);
+
+		for (unsigned int chunk = 0; chunk < size; chunk += TBGEN_CHUNK) {
+			tbgen_run(&tbgen_unmove_thread, thread, threads, chunk, (size - chunk > TBGEN_CHUNK ? chunk + TBGEN_CHUNK : size));
+
+			for (int t = 0; t < threads; t++) {
+				for (unsigned int i = 0; i < thread[t].pred_count; i++) {
+					unsigned int p = thread[t].pred[i] & ~TBGEN_LOST;
+					if (gen->result[p] != TBGEN_UNKNOWN)
+						continue;
+					if (thread[t].pred[i] & TBGEN_LOST) {
+						gen->result[p] = TB_WIN;
+						gen->dist[p] = next;
+						max_level = gen->level + 1;
+					}
+					else if (--gen->count[p] == 0) {
+						gen->result[p] = TB_LOSS;
+						gen->dist[p] = next;
+						max_level = gen->level + 1;
+					}
+				}
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < size; i++) {
+		if (gen->result[i] == TBGEN_UNKNOWN) {
+			gen->result[i] = TB_DRAW;
+			gen->dist[i] = 0;
+		}
+	}
+	return TRUE;
+}
+
+static BOOL write_tablebase_file(char *path, const char *name, const char *extension, const char *magic, uchar *data, size_t length, unsigned int size)
+{
+	char filename[FILENAME_MAX];
+	char header[TB_HEADER_SIZE];
+	unsigned long long count = size;
+
+	tablebase_file_name(filename, path, name, extension);
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL)
+		return FALSE;
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, magic, strlen(magic));
+	memcpy(header + 8, &count, sizeof(count));
+	BOOL ok = (fwrite(header, 1, TB_HEADER_SIZE, f) == TB_HEADER_SIZE && fwrite(data, 1, length, f) == length);
+	fclose(f);
+	return ok;
+}
+
+//-- Build one table (every table it leads to must be loaded) and write it to path, or keep it in memory if path is NULL
+BOOL generate_tablebase(struct t_tablebase *tb, char *path, int threads)
+{
+	struct t_tbgen gen[1];
+	struct t_tbgen_thread thread[TBGEN_MAX_THREADS];
+	uchar *previous = NULL;
+	BOOL ok;
+
+	if (threads < 1) threads = 1;
+	if (threads > TBGEN_MAX_THREADS) threads = TBGEN_MAX_THREADS;
+
+	memset(gen, 0, sizeof(gen));
+	gen->tb = tb;
+	gen->result = (uchar *)malloc(tb->size);
+	gen->dist = (uchar *)malloc(tb->size);
+	gen->count = (uchar *)malloc(tb->size);
+	assert(gen->result && gen->dist && gen->count);
+
+	memset(thread, 0, sizeof(thread));
+	for (int t = 0; t < threads; t++)
+		thread[t].gen = gen;
+
+	//-- Without pawns there is nothing to iterate
+	gen->dtz = !tb->pawns;
+	ok = tbgen_pass(gen, thread, threads);
+
+	if (ok && tb->pawns) {
+		previous = (uchar *)malloc(tb->size);
+		assert(previous);
+		gen->dtz = TRUE;
+		gen->previous = previous;
+		for (int pass = 0; ok && pass < TBGEN_MAX_PASSES; pass++) {
+			memcpy(previous, gen->result, tb->size);
+			ok = tbgen_pass(gen, thread, threads);
+			if (ok && !memcmp(previous, gen->result, tb->size))
+				break;
+		}
+		free(previous);
+	}
+
+	for (int t = 0; t < threads; t++)
+		free(thread[t].pred);
+
+	if (ok) {
+		uchar *wdl = (uchar *)calloc((tb->size + 3) / 4, 1);
+		assert(wdl);
+		for (unsigned int i = 0; i < tb->size; i++) {
+			wdl[i >> 2] |= gen->result[i] << (2 * (i & 3));
+			if (gen->result[i] != TB_WIN && gen->result[i] != TB_LOSS)
+				gen->dist[i] = 0;
+		}
+
+		if (path == NULL) {
+			set_tablebase_memory(tb, wdl, gen->dist);
+			gen->dist = NULL;
+		}
+		else {
+			ok = write_tablebase_file(path, tb->name, "mtw", TB_WDL_MAGIC, wdl, (tb->size + 3) / 4, tb->size)
+				&& write_tablebase_file(path, tb->name, "mtz", TB_DTZ_MAGIC, gen->dist, tb->size, tb->size)
+				&& load_tablebase(tb, path);
+			free(wdl);
+		}
+	}
+
+	free(gen->result);
+	free(gen->dist);
+	free(gen->count);
+	return ok;
+}
+
+//-- "tbgen [<path>] [threads <n>]": build every table not already in path
+void generate_tablebases(char *s)
+{
+	char path[FILENAME_MAX];
+	char info[FILENAME_MAX + 64];
+	int threads = processor_count();
+	int i;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	if ((i = index_of("threads", s)) > 0)
+		threads = number_index(i + 1, s);
+
+	strcpy(path, ".");
+	if (word_count(s) > 1 && i != 1)
+		strcpy(path, word_index(1, s));
+
+	unload_tablebases();
+	for (i = 0; i < TB_TABLE_COUNT; i++) {
+		if (load_tablebase(&tablebase[i], path))
+			continue;
+
+		unsigned long start = time_now();
+		BOOL ok = generate_tablebase(&tablebase[i], path, threads);
+		sprintf(info, "%s %s in %lu ms", tablebase[i].name, ok ? "generated" : "FAILED", time_now() - start);
+		send_info(info);
+		if (!ok)
+			break;
+	}
+
+	sprintf(info, "%d tablebases in %s (complete up to %d pieces)", tablebase_count, path, tablebase_pieces);
+	send_info(info);
+}
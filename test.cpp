@@ -9,9 +9,11 @@
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
+#include <math.h>
 #include <Windows.h>
 
 #include "defs.h"
+#include "eval.h"
 #include "data.h"
 #include "procs.h"
 #include "bittwiddle.h"
@@ -27,11 +29,24 @@ void test_procedure()
     assert(test_make_unmake());
     assert(test_hash());
     assert(test_eval());
+    assert(test_attack_maps());
+    assert(test_eval_kernels());
+    assert(test_slider_fills());
+    assert(test_nnue());
+    assert(test_tuning());
+    assert(test_material());
+    assert(test_kpk());
+    assert(test_recognizer());
+    assert(test_tablebase());
     assert(test_capture_gen());
     assert(test_check_gen());
     assert(test_alt_move_gen());
+    assert(test_check_info());
     assert(test_see());
     assert(test_position());
+    assert(test_copy_board());
+    assert(test_copy_make());
+    assert(test_repetition());
 	assert(test_hash_table());
 	test_ep_capture();
 	//assert(test_book());
@@ -101,11 +116,11 @@ BOOL test_genmove() {
     generate_moves(position, moves);
     //write_move_list(moves, "movelist.txt");
     assert(move_list_integrity(position, moves));
-    ok = ok && (moves->count == 46);
+    ok = ok && (moves->count == 45);
 
     flip_board(position);
     generate_moves(position, moves);
-    ok = ok && (moves->count == 46);
+    ok = ok && (moves->count == 45);
 
     //write_move_list(&moves, "movelist.txt");
 
@@ -126,11 +141,10 @@ BOOL test_make_unmake() {
         generate_moves(position, moves);
         for (i = 0; i < moves->count; i++) {
             assert(integrity(position));
-            if (make_move(position, moves->pinned_pieces, moves->move[i], undo)) {
-                assert(integrity(position));
-                unmake_move(position, undo);
-                assert(integrity(position));
-            }
+            make_move(position, moves->move[i], undo);
+            assert(integrity(position));
+            unmake_move(position, undo);
+            assert(integrity(position));
         }
         flip_board(position);
     }
@@ -142,11 +156,10 @@ BOOL test_make_unmake() {
         generate_moves(position, moves);
         for (i = 0; i < moves->count; i++) {
             assert(integrity(position));
-            if (make_move(position, moves->pinned_pieces, moves->move[i], undo)) {
-                assert(integrity(position));
-                unmake_move(position, undo);
-                assert(integrity(position));
-            }
+            make_move(position, moves->move[i], undo);
+            assert(integrity(position));
+            unmake_move(position, undo);
+            assert(integrity(position));
         }
         flip_board(position);
     }
@@ -351,6 +364,37 @@ BOOL test_hash() {
 
 }
 
+BOOL test_check_info() {
+
+    struct t_check_info *info;
+    struct t_undo undo[1];
+    BOOL ok = TRUE;
+
+    //-- The knight is pinned by the bishop and also stands in front of the rook
+    set_fen(position, "3k4/8/1b6/8/3N4/8/8/3R2K1 w - -");
+    info = get_check_info(position);
+    ok &= (info->pinned[WHITE] == SQUARE64(D4) && info->pinners[WHITE] == SQUARE64(B6));
+    ok &= (info->discovered == SQUARE64(D4) && info->pinned[BLACK] == 0);
+    ok &= (info->check_squares[KNIGHT] == knight_mask[D8] && info->check_squares[ROOK] == rook_attacks(D8, position->all_pieces));
+
+    //-- Discovered check, then double check
+    set_fen(position, "3k4/8/8/8/3N4/8/8/3R2K1 w - -");
+    make_move(position, lookup_move(position, "d4f5"), undo);
+    ok &= (position->in_check == 1 && position->check_attacker == D1);
+    unmake_move(position, undo);
+    make_move(position, lookup_move(position, "d4c6"), undo);
+    ok &= (position->in_check == 2);
+    unmake_move(position, undo);
+
+    //-- Moving along the line doesn't uncover anything
+    set_fen(position, "3k4/8/8/8/8/3P4/8/3Q2K1 w - -");
+    make_move(position, lookup_move(position, "d3d4"), undo);
+    ok &= (position->in_check == 0);
+    unmake_move(position, undo);
+
+    return ok;
+}
+
 BOOL test_capture_gen() {
 
     BOOL ok = TRUE;
@@ -358,11 +402,11 @@ BOOL test_capture_gen() {
 
     set_fen(position, "8/pppr2pp/3pKp2/2Q3bn/8/b6k/PPP1P2P/3R2n1 w - -");
     generate_captures(position, moves);
-    ok &= (moves->count == 12);
+    ok &= (moves->count == 10);
 
     flip_board(position);
     generate_captures(position, moves);
-    ok &= (moves->count == 12);
+    ok &= (moves->count == 10);
 
     return ok;
 
@@ -471,6 +515,453 @@ BOOL test_eval() {
 
 }
 
+BOOL test_attack_maps() {
+
+    struct t_chess_eval *eval = search_stack->ply[1].eval;
+    struct t_move_list moves[1];
+    struct t_undo undo[1];
+    BOOL ok = TRUE;
+
+    //-- The knight is attacked by the pawn, so its retreats go first and Nc5 is fine too
+    set_fen(position, "4k3/8/8/3p4/4N3/8/8/4K3 w - -");
+    calc_evaluation(position, eval);
+    ok &= (eval->attack_hash == position->hash);
+    ok &= ((eval->attacks[BLACK][PAWN] & SQUARE64(E4)) && (eval->attacks[WHITE][KNIGHT] & SQUARE64(D6)));
+
+    generate_moves(position, moves);
+    moves->hash_move = NULL;
+    order_moves(position, moves, 1);
+    ok &= (moves->attack_eval == eval);
+    for (int i = 0; i < moves->count; i++) {
+        struct t_move_record *move = moves->move[i];
+        t_chess_value bonus = (t_chess_value)(moves->value[i] - move->history);
+        if (move->captured || move == search_stack->ply[1].killer1 || move == search_stack->ply[1].killer2)
+            continue;
+        if (PIECETYPE(move->piece) == KNIGHT)
+            ok &= (bonus == MOVE_ORDER_ESCAPE);
+        else
+            ok &= (bonus == 0);
+    }
+
+    //-- The maps belong to one position only
+    make_move(position, lookup_move(position, "e4c3"), undo);
+    ok &= (eval->attack_hash != position->hash);
+    unmake_move(position, undo);
+
+    return ok;
+}
+
+BOOL test_eval_kernels() {
+
+    struct t_chess_eval eval[1];
+    t_bitboard attacklist[15];
+    t_chess_value v;
+    BOOL ok = TRUE;
+
+    //-- Nothing to compare without the vector kernels
+    if (!avx2_kernels_available())
+        return TRUE;
+
+    BOOL saved_avx2 = use_avx2;
+    init_eval(eval);
+
+    //-- Includes promoted sliders so the kernels run more than one group of four
+    char *fen[] = {
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/8/7k/2R1Q1n1/1pRp4/8/2B5/5K2 w - -",
+        "2k5/p1pp4/1p3B2/8/3Q1R2/2N5/5P2/5K2 w - -",
+        "R1R1R1R1/QQ1b1b1b/8/7k/8/8/rr1q1q1K/BBB1b3 w - -",
+    };
+
+    for (int i = 0; i < 4; i++) {
+        set_fen(position, fen[i]);
+        for (int j = 0; j <= 1; j++) {
+            use_avx2 = FALSE;
+            v = calc_evaluation(position, eval);
+            memcpy(attacklist, eval->attacklist, sizeof(attacklist));
+            use_avx2 = TRUE;
+            ok &= (v == calc_evaluation(position, eval));
+            ok &= (memcmp(attacklist, eval->attacklist, sizeof(attacklist)) == 0);
+            flip_board(position);
+        }
+    }
+
+    use_avx2 = saved_avx2;
+    return ok;
+}
+
+BOOL test_slider_fills() {
+
+    t_bitboard sliders[2], empty[2], fill[2], magic[2];
+    BOOL ok = TRUE;
+
+    int saved_kernel = fill_kernel;
+
+    //-- Sliders on the edges and corners, where a fill could wrap round
+    char *fen[] = {
+        "R1R1R1R1/QQ1b1b1b/8/7k/8/8/rr1q1q1K/BBB1b3 w - -",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+        "q5kb/8/8/3BR3/8/8/8/B5QK w - -",
+    };
+
+    for (int i = 0; i < 3; i++) {
+        set_fen(position, fen[i]);
+        for (int piece = BISHOP; piece <= QUEEN; piece++) {
+            for (t_chess_color color = WHITE; color <= BLACK; color++) {
+                t_bitboard b = sliders[color] = position->pieces[color][piece];
+                empty[color] = ~position->all_pieces;
+                magic[color] = 0;
+                while (b) {
+                    t_chess_square s = bitscan_reset(&b);
+                    if (piece != BISHOP)
+                        magic[color] |= rook_attacks(s, position->all_pieces);
+                    if (piece != ROOK)
+                        magic[color] |= bishop_attacks(s, position->all_pieces);
+                }
+            }
+            for (int kernel = FILL_KERNEL_SCALAR; kernel <= FILL_KERNEL_AVX2; kernel++) {
+                if (kernel == FILL_KERNEL_AVX2 && !avx2_kernels_available())
+                    break;
+                fill_kernel = kernel;
+                if (piece == ROOK)
+                    rook_fill(sliders, empty, fill);
+                else if (piece == BISHOP)
+                    bishop_fill(sliders, empty, fill);
+                else
+                    queen_fill(sliders, empty, fill);
+                ok &= (fill[WHITE] == magic[WHITE] && fill[BLACK] == magic[BLACK]);
+            }
+        }
+
+        //-- The whole-side map must agree with the attackers of every square
+        for (t_chess_color color = WHITE; color <= BLACK; color++) {
+            t_bitboard map = attack_map(position, color, position->all_pieces);
+            for (t_chess_square s = A1; s <= H8; s++)
+                ok &= (((map & SQUARE64(s)) != 0) == is_square_attacked(position, s, color));
+        }
+    }
+
+    //-- ...and the evasions generated from it must give the same perft
+    char *check[] = {
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+    };
+    BOOL saved_evasions = use_fill_evasions;
+    for (int i = 0; i < 2; i++) {
+        set_fen(position, check[i]);
+        use_fill_evasions = FALSE;
+        t_nodes n = do_perft(position, 4);
+        use_fill_evasions = TRUE;
+        ok &= (do_perft(position, 4) == n);
+    }
+    use_fill_evasions = saved_evasions;
+
+    fill_kernel = saved_kernel;
+    return ok;
+}
+
+//-- Make / unmake every move to the given depth, checking the incremental accumulators against a full refresh
+static BOOL nnue_walk(struct t_board *board, int depth) {
+
+    struct t_move_list move_list[1];
+    struct t_undo undo[1];
+    struct t_nnue_accumulator before, incremental;
+    BOOL ok = TRUE;
+
+    generate_legal_moves(board, move_list);
+    for (int i = 0; i < move_list->count; i++) {
+        before = board->nnue;
+        make_move(board, move_list->move[i], undo);
+
+        incremental = board->nnue;
+        nnue_refresh_all(board);
+        ok &= (memcmp(&incremental, &board->nnue, sizeof(incremental)) == 0);
+
+        if (depth > 1)
+            ok &= nnue_walk(board, depth - 1);
+
+        unmake_move(board, undo);
+        ok &= (memcmp(&before, &board->nnue, sizeof(before)) == 0);
+    }
+    return ok;
+}
+
+BOOL test_nnue() {
+
+    struct t_chess_eval eval[1];
+    BOOL ok = TRUE;
+
+    //-- A random network in the weights file format (small values so nothing overflows)
+    char *weights = (char *)malloc(NNUE_FILE_SIZE);
+    unsigned int header[2] = { NNUE_VERSION, NNUE_HIDDEN };
+    t_hash r = 0x2545f4914f6cdd1dULL;
+
+    memcpy(weights, NNUE_MAGIC, 8);
+    memcpy(weights + 8, header, sizeof(header));
+    for (size_t i = NNUE_HEADER_SIZE; i < NNUE_FILE_SIZE; i++) {
+        r ^= r >> 12; r ^= r << 25; r ^= r >> 27;
+        weights[i] = (char)((r * 0x2545f4914f6cdd1dULL) >> 58) - 32;
+    }
+    for (size_t i = NNUE_HEADER_SIZE + 1; i < NNUE_HEADER_SIZE + 2 * NNUE_HIDDEN + 2 * (size_t)NNUE_FEATURES * NNUE_HIDDEN; i += 2)
+        weights[i] = (weights[i - 1] < 0) ? -1 : 0;
+
+    BOOL saved_nnue = use_nnue;
+    BOOL saved_avx2 = cpu.avx2;
+    struct t_nnue_network saved_network = nnue_network;
+
+    ok &= nnue_set_weights(weights, NNUE_FILE_SIZE);
+    use_nnue = TRUE;
+    init_eval(eval);
+
+    char *fen[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+
+    for (int i = 0; i < 4; i++) {
+        set_fen(position, fen[i]);
+        ok &= nnue_walk(position, 3);
+
+        //-- The SSE2 and AVX2 inference must agree
+        t_chess_value v = nnue_evaluate(position, eval);
+        cpu.avx2 = FALSE;
+        ok &= (v == nnue_evaluate(position, eval));
+        cpu.avx2 = saved_avx2;
+    }
+
+    nnue_network = saved_network;
+    use_nnue = saved_nnue;
+    free(weights);
+    return ok;
+}
+
+BOOL test_tuning() {
+
+    struct t_chess_eval eval[1];
+    struct t_tune_position positions[6];
+    t_chess_value scores[6];
+    BOOL ok = TRUE;
+
+    char *fen[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "2r3k1/1q1nbppp/r3p3/3pP3/pPpP4/P1Q2N2/2RN1PPP/2R4K b - - 0 22",
+        "8/8/8/8/8/4k3/8/3BK3 b - -"
+    };
+
+    struct t_board *board = (struct t_board *)malloc(sizeof(struct t_board));
+    init_board(board);
+    init_eval(eval);
+
+    //-- A packed position must come back exactly as set_fen left it
+    for (int i = 0; i < 6; i++) {
+        set_fen(position, fen[i]);
+        pack_position(position, positions + i);
+        positions[i].result = i % 3;
+        unpack_position(board, positions + i);
+
+        ok &= (board->hash == position->hash);
+        ok &= (board->pawn_hash == position->pawn_hash);
+        ok &= (board->material_index == position->material_index);
+        ok &= (board->material_pst == position->material_pst);
+        ok &= (board->game_phase == position->game_phase);
+        ok &= (board->ep_square == position->ep_square);
+        ok &= (board->castling == position->castling);
+        ok &= (board->to_move == position->to_move);
+    }
+
+    //-- The loss must not depend on how the work is split
+    double single = tuning_loss(positions, 6, 1.0, 1, scores);
+    ok &= fabs(single - tuning_loss(positions, 6, 1.0, 4, NULL)) < 1e-12;
+    ok &= (single > 0 && single < 1);
+
+    for (int i = 0; i < 4; i++) {
+        set_fen(position, fen[i]);
+        ok &= (scores[i] == calc_evaluation(position, eval) * (1 - 2 * position->to_move));
+    }
+
+    //-- The tuner mustn't write to the transposition table (the last position is a dead draw)
+    clear_hash();
+    tuning_loss(positions, 6, 1.0, 4, NULL);
+    set_fen(position, fen[5]);
+    ok &= (probe(position->hash) == NULL);
+
+    free(board);
+    return ok;
+}
+
+BOOL test_material() {
+
+    struct t_material_record spare;
+    struct t_material_record *record;
+    BOOL ok = TRUE;
+
+    //-- Bishop pair for white, nothing scaled with pawns on the board
+    set_fen(position, "rn1qkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -");
+    ok &= (position->material_index < MATERIAL_INDEX_SIZE);
+    record = lookup_material(position, &spare);
+    ok &= (record->imbalance == MAKE_SCORE(eval_terms.mg_bishop_pair, eval_terms.eg_bishop_pair));
+    ok &= (record->scale[WHITE] == MATERIAL_SCALE_NORMAL && record->scale[BLACK] == MATERIAL_SCALE_NORMAL);
+
+    //-- Rook vs. bishop is drawish, a lone knight can't win
+    set_fen(position, "8/8/3k4/8/3b4/8/3RK3/8 w - -");
+    record = lookup_material(position, &spare);
+    ok &= (record->scale[WHITE] == MATERIAL_SCALE_NORMAL / 4 && record->scale[BLACK] == 0);
+
+    //-- A second queen doesn't fit the index, and undoing the promotion puts it back
+    set_fen(position, "8/1P6/8/8/8/2k5/8/4K2Q w - -");
+    t_material_index index = position->material_index;
+    struct t_undo undo[1];
+    make_move(position, lookup_move(position, "b7b8q"), undo);
+    ok &= (position->material_index >= MATERIAL_INDEX_SIZE);
+    ok &= (lookup_material(position, &spare) == &spare && spare.eval_endgame == NULL);
+    unmake_move(position, undo);
+    ok &= (position->material_index == index);
+
+    return ok;
+}
+
+BOOL test_kpk() {
+
+    struct t_chess_eval eval[1];
+    t_chess_value v;
+    BOOL ok = TRUE;
+
+    init_eval(eval);
+
+    //-- White wins whoever is to move
+    char *win[] = {
+        "4k3/8/4K3/4P3/8/8/8/8 w - -",
+        "4k3/8/4K3/4P3/8/8/8/8 b - -",
+        "8/8/8/8/8/2K5/2P5/k7 w - -",
+        "8/8/8/2k5/8/8/6P1/6K1 w - -"
+    };
+
+    //-- Draws: opposition, rook pawn, the pawn falls, stalemate
+    char *draw[] = {
+        "8/8/8/8/8/4k3/4P3/4K3 w - -",
+        "k7/8/K7/P7/8/8/8/8 w - -",
+        "8/8/8/8/8/1k6/2P5/7K b - -",
+        "5k2/5P2/5K2/8/8/8/8/8 b - -"
+    };
+
+    for (int i = 0; i < 4; i++) {
+        set_fen(position, win[i]);
+        v = evaluate(position, eval);
+        ok &= (v * (1 - 2 * position->to_move) >= KPK_WIN_SCORE);
+        flip_board(position);
+        ok &= (v == evaluate(position, eval));
+
+        set_fen(position, draw[i]);
+        ok &= (evaluate(position, eval) == 0);
+        flip_board(position);
+        ok &= (evaluate(position, eval) == 0);
+    }
+
+    return ok;
+}
+
+BOOL test_recognizer() {
+
+    t_nodes start;
+    t_chess_value v;
+    BOOL ok = TRUE;
+
+    clear_hash();
+
+    //-- A lone knight is a dead draw, no moves are searched
+    set_fen(position, "8/8/8/4k3/8/8/8/1N2K3 w - -");
+    search_stack->ply[1].eval->evaluated = FALSE;
+    start = nodes;
+    ok &= (alphabeta(position, 1, 6, -100, 100) == 0);
+    ok &= (nodes - start == 1);
+
+    //-- Queen vs. king fails high with the queen to move, and low for the lone king
+    set_fen(position, "8/8/8/4k3/8/8/8/Q3K3 w - -");
+    search_stack->ply[1].eval->evaluated = FALSE;
+    start = nodes;
+    ok &= (alphabeta(position, 1, 6, -100, 100) >= 100);
+    ok &= (nodes - start == 1);
+
+    set_fen(position, "8/8/8/4k3/8/8/8/Q3K3 b - -");
+    search_stack->ply[1].eval->evaluated = FALSE;
+    start = nodes;
+    ok &= (alphabeta(position, 1, 6, -100, 100) <= -100);
+    ok &= (nodes - start == 1);
+
+    //-- ...unless the queen hangs
+    set_fen(position, "8/8/8/8/8/8/3kQ3/7K b - -");
+    search_stack->ply[1].eval->evaluated = FALSE;
+    start = nodes;
+    v = alphabeta(position, 1, 4, -100, 100);
+    ok &= (v > -100 && nodes - start > 1);
+
+    clear_hash();
+
+    return ok;
+}
+
+BOOL test_tablebase() {
+
+    struct t_tb_position p;
+    t_chess_value score;
+    int wdl, max_dtz = 0;
+    BOOL ok = TRUE;
+
+    //-- Build the 3 man tables in memory
+    unload_tablebases();
+    for (int i = 0; i < 5; i++)
+        ok &= generate_tablebase(&tablebase[i], NULL, 2);
+    ok &= (tablebase_pieces == 3);
+
+    //-- KPvK must agree with the bitbase, one position at a time
+    struct t_tablebase *kpk = &tablebase[4];
+    for (unsigned int index = 0; index < kpk->size; index++) {
+        int r = (kpk->wdl[index >> 2] >> (2 * (index & 3))) & 3;
+        if (r == TB_ILLEGAL)
+            continue;
+        tb_decode(kpk, index, &p);
+        ok &= (tb_index(kpk, &p) == index);
+        BOOL win = kpk_win(p.to_move, p.square[0], p.square[1], p.square[2]);
+        ok &= (win == (r == (p.to_move == WHITE ? TB_WIN : TB_LOSS)));
+    }
+
+    //-- Longest KQvK win is mate in 10
+    for (unsigned int index = 0; index < tablebase[0].size; index++) {
+        if (tablebase[0].dtz[index] > max_dtz)
+            max_dtz = tablebase[0].dtz[index];
+    }
+    ok &= (max_dtz == 20);
+
+    //-- The same result with the colours or the board flipped
+    char *fen[] = {
+        "8/8/8/4k3/8/8/8/R3K3 b - -",
+        "8/8/8/8/8/2K5/8/k1B5 w - -",
+        "8/8/8/8/8/k7/p7/3K4 b - -",
+        "8/8/8/8/8/k7/p7/K7 w - -"
+    };
+    int result[] = { TB_LOSS, TB_DRAW, TB_WIN, TB_DRAW };
+
+    for (int i = 0; i < 4; i++) {
+        set_fen(position, fen[i]);
+        ok &= (probe_wdl(position, &wdl) && wdl == result[i]);
+        flip_board(position);
+        ok &= (probe_wdl(position, &wdl) && wdl == result[i]);
+    }
+
+    //-- Mate in one at the root
+    set_fen(position, "7k/8/6K1/8/8/8/Q7/8 w - -");
+    struct t_move_record *move = probe_root_tablebase(position, &score);
+    ok &= (move != NULL && !strcmp(move_as_str(move), "a2a8") && score == TB_WIN_SCORE);
+
+    unload_tablebases();
+    return ok;
+}
+
 BOOL test_see() {
 
     t_move_record *move;
@@ -520,6 +1011,60 @@ BOOL test_see() {
     return ok;
 }
 
+BOOL test_copy_board()
+{
+    struct t_board board[1];
+    struct t_move_list moves[1], copy_moves[1];
+    struct t_undo undo[1];
+    BOOL ok = TRUE;
+
+    set_fen(position, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    copy_board(board, position);
+
+    //-- The copy is the same position and has its own piece lists
+    ok &= (board->hash == position->hash && board->pieces[WHITE] == board->piecelist);
+    generate_moves(position, moves);
+    generate_moves(board, copy_moves);
+    ok &= (moves->count == copy_moves->count);
+
+    make_move(board, lookup_move(board, "e5f7"), undo);
+    ok &= integrity(board) && integrity(position);
+    ok &= (board->hash != position->hash && position->square[F7] == BLACKPAWN);
+    unmake_move(board, undo);
+    ok &= (board->hash == position->hash);
+
+    //-- Each ply's PV row starts where the previous one ends
+    for (int i = 1; i <= MAXPLY; i++)
+        ok &= (search_stack->ply[i].best_line + i == search_stack->ply[i - 1].best_line + MAXPLY + 1);
+
+    return ok;
+}
+
+BOOL test_copy_make()
+{
+    struct t_board child[1];
+    struct t_undo undo[1];
+    BOOL ok = TRUE;
+
+    //-- Castling, e.p. and promotions, with and without check
+    set_fen(position, "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    ok &= (do_perft_copy(position, 4) == do_perft(position, 4));
+    set_fen(position, "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -");
+    ok &= (do_perft_copy(position, 5) == do_perft(position, 5));
+
+    //-- The move is made on the copy and the position is left alone
+    set_fen(position, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    t_hash hash = position->hash;
+    int count = draw_stack_count;
+    copy_make_move(position, lookup_move(position, "e5f7"), child, undo);
+    ok &= integrity(child) && integrity(position);
+    ok &= (position->hash == hash && position->square[F7] == BLACKPAWN && child->square[F7] == WHITEKNIGHT);
+    ok &= (child->pieces[BLACK] == child->piecelist + 8 && draw_stack_count == count + 1);
+    draw_stack_count--;
+
+    return ok;
+}
+
 BOOL test_position()
 {
 	uci_position(position, "position startpos moves d2d4 g7g6 g1f3 g8f6 c2c4 f8g7 b1c3 d7d5 d1b3 d5c4 b3c4 e8g8 e2e4 a7a6 e4e5 b7b5 c4b3 f6d7 e5e6 f7e6 f3g5 d7b6 g5e6 c8e6 b3e6 g8h8 c1e3 d8d6 e6d6 e7d6");
@@ -542,8 +1087,8 @@ BOOL test_ep_capture()
 
 	generate_moves(position, moves);
 	for (int i = 0; i < moves->count; i++){
-		if (make_move(position, moves->pinned_pieces, moves->move[i], undo))
-			unmake_move(position, undo);
+		make_move(position, moves->move[i], undo);
+		unmake_move(position, undo);
 	}
 
 	return TRUE;
@@ -589,6 +1134,47 @@ BOOL test_book()
     return TRUE;
 }
 
+BOOL test_repetition()
+{
+    struct t_undo undo[5];
+    char *moves[] = { "a1a2", "g8h8", "a2a1" };
+    BOOL ok = TRUE;
+
+    //-- Ra1-a2 Kg8-h8 Ra2-a1, now Kh8-g8 repeats the starting position
+    set_fen(position, "6k1/8/8/8/8/8/8/R5K1 w - -");
+    for (int i = 0; i < 3; i++) {
+        ok &= !upcoming_repetition(position);
+        make_move(position, lookup_move(position, moves[i]), &undo[i]);
+    }
+    ok &= upcoming_repetition(position);
+
+    //-- ...and after Kh8-g8 white can go back to the position after Ra1-a2
+    make_move(position, lookup_move(position, "h8g8"), &undo[3]);
+    ok &= upcoming_repetition(position);
+
+    //-- A pawn move makes everything before it unreachable
+    set_fen(position, "6k1/8/8/8/8/8/P7/R5K1 w - -");
+    make_move(position, lookup_move(position, "a1b1"), &undo[0]);
+    make_move(position, lookup_move(position, "g8h8"), &undo[1]);
+    make_move(position, lookup_move(position, "a2a3"), &undo[2]);
+    ok &= !upcoming_repetition(position);
+
+    //-- Kg8-h8 Ra1-a2 (null) Ra2-a3 Kh8-g8; Ra3-a1 would only repeat a position before the null move
+    set_fen(position, "6k1/8/8/8/8/8/8/R5K1 b - -");
+    make_move(position, lookup_move(position, "g8h8"), &undo[0]);
+    make_move(position, lookup_move(position, "a1a2"), &undo[1]);
+    make_null_move(position, &undo[2]);
+    make_move(position, lookup_move(position, "a2a3"), &undo[3]);
+    make_move(position, lookup_move(position, "h8g8"), &undo[4]);
+    ok &= !upcoming_repetition(position);
+    unmake_move(position, &undo[4]);
+    unmake_move(position, &undo[3]);
+    unmake_null_move(position, &undo[2]);
+    ok &= (null_move_draw_stack_count == 0);
+
+    return ok;
+}
+
 BOOL test_hash_table()
 {
 	t_move_list moves[1];
@@ -0,0 +1,403 @@
+//===========================================================//
+//
+// Maverick Chess Engine
+// Copyright 2013 Steve Maughan
+//
+//===========================================================//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <windows.h>
+#include <process.h>
+
+#include "defs.h"
+#include "eval.h"
+#include "data.h"
+#include "procs.h"
+#include "bittwiddle.h"
+
+#define TUNE_LINE_LENGTH			1024
+#define TUNE_MAX_THREADS			64
+#define TUNE_PAWN_HASH_SIZE			(1 << 14)	// entries in each thread's private pawn hash
+#define TUNE_MAX_PASSES				100
+
+//-- The terms the tuner walks over; the pawn values are left alone to anchor the scale
+struct t_tune_param
+{
+	const char								*name;
+	t_chess_value							*value;
+	BOOL									pst;				// the piece-square tables must be rebuilt after a change
+};
+
+static struct t_tune_param tune_params[] = {
+	{ "Knight MG", &piece_value[0][KNIGHT], TRUE },
+	{ "Knight EG", &piece_value[1][KNIGHT], TRUE },
+	{ "Bishop MG", &piece_value[0][BISHOP], TRUE },
+	{ "Bishop EG", &piece_value[1][BISHOP], TRUE },
+	{ "Rook MG", &piece_value[0][ROOK], TRUE },
+	{ "Rook EG", &piece_value[1][ROOK], TRUE },
+	{ "Queen MG", &piece_value[0][QUEEN], TRUE },
+	{ "Queen EG", &piece_value[1][QUEEN], TRUE },
+	{ "Isolated Pawn MG", &eval_terms.mg_isolated_pawn, FALSE },
+	{ "Isolated Pawn EG", &eval_terms.eg_isolated_pawn, FALSE },
+	{ "Bishop Pair MG", &eval_terms.mg_bishop_pair, FALSE },
+	{ "Bishop Pair EG", &eval_terms.eg_bishop_pair, FALSE },
+	{ "Connected Knights MG", &eval_terms.mg_connected_knights, FALSE },
+	{ "Connected Knights EG", &eval_terms.eg_connected_knights, FALSE },
+	{ "Rook on 7th", &eval_terms.rook_on_7th, FALSE },
+	{ "Rook on Open File", &eval_terms.mg_rook_on_open_file, FALSE },
+	{ "Rook on Semi-Open File", &eval_terms.mg_rook_on_semi_open_file, FALSE }
+};
+
+#define TUNE_PARAM_COUNT			(int)(sizeof(tune_params) / sizeof(tune_params[0]))
+
+//-- One slice of the corpus and everything a thread needs to score it
+struct t_tune_thread
+{
+	struct t_tune_position					*positions;
+	int										count;
+	double									k;
+	t_chess_value							*scores;
+	struct t_board							*board;
+	struct t_chess_eval						eval[1];
+	double									error;
+};
+
+//-- Store the board in 36 bytes
+void pack_position(struct t_board *board, struct t_tune_position *p)
+{
+	for (t_chess_square s = A1; s <= H8; s += 2)
+		p->square[s >> 1] = (uchar)(board->square[s] | (board->square[s + 1] << 4));
+	p->to_move = (uchar)board->to_move;
+	p->castling = board->castling;
+	p->ep = (uchar)(board->ep_square ? bitscan(board->ep_square) : 0);
+}
+
+//-- Rebuild a board from its packed form (as set_fen, but without touching any global state)
+void unpack_position(struct t_board *board, struct t_tune_position *p)
+{
+	t_chess_piece piece;
+
+	clear_board(board);
+	board->material_index = 0;
+
+	for (t_chess_square s = A1; s <= H8; s++) {
+		piece = (p->square[s >> 1] >> (4 * (s & 1))) & 15;
+		if (piece)
+			add_piece(board, piece, s);
+	}
+
+	board->to_move = p->to_move;
+	board->castling = p->castling;
+	board->hash ^= castle_hash[board->castling];
+	if (p->ep) {
+		board->ep_square = SQUARE64(p->ep);
+		board->hash ^= ep_hash[COLUMN(p->ep)];
+	}
+	if (board->to_move == WHITE) {
+		board->hash ^= white_to_move_hash;
+		board->pawn_hash ^= white_to_move_hash;
+	}
+
+	//-- The evaluation never looks at in_check, so it is not worked out here
+	assert(board->hash == calc_board_hash(board));
+	assert(board->pawn_hash == calc_pawn_hash(board));
+}
+
+//-- Game result from an EPD/FEN line: "1-0", "0-1", "1/2-1/2" or "[1.0]", "[0.5]", "[0.0]"; -1 if there is none
+static int parse_result(char *line)
+{
+	if (strstr(line, "1/2-1/2") || strstr(line, "[0.5]"))
+		return 1;
+	if (strstr(line, "1-0") || strstr(line, "[1.0]") || strstr(line, "[1]"))
+		return 2;
+	if (strstr(line, "0-1") || strstr(line, "[0.0]") || strstr(line, "[0]"))
+		return 0;
+	return -1;
+}
+
+//-- Replace the position by the end of its quiescence principal variation
+static void quiesce_position(struct t_board *board)
+{
+	struct t_undo undo[MAXPLY];
+	int saved_deepest = deepest;
+
+	//-- Keep qsearch from sending "info depth"
+	deepest = MAXPLY + 1;
+
+	search_stack->ply[0].best_line_length = 0;
+	search_stack->ply[0].eval->evaluated = FALSE;
+
+	qsearch(board, 0, 0, -CHESS_INFINITY, CHESS_INFINITY);
+
+	int length = search_stack->ply[0].best_line_length;
+	for (int i = 0; i < length; i++)
+		make_move(board, search_stack->ply[0].best_line[i], undo + i);
+
+	deepest = saved_deepest;
+}
+
+//-- Read a labelled corpus into a packed array; returns the number of positions
+int load_tuning_positions(char *filename, struct t_tune_position **positions, BOOL quiesce)
+{
+	int count = 0;
+	int size = 0;
+	char line[TUNE_LINE_LENGTH];
+
+	*positions = NULL;
+
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) {
+		printf("info string Unable to open %s\n", filename);
+		return 0;
+	}
+
+	struct t_board *board = (struct t_board *)malloc(sizeof(struct t_board));
+	assert(board);
+	init_board(board);
+
+	BOOL saved_stop = uci.stop;
+	uci.stop = FALSE;
+
+	while (fgets(line, TUNE_LINE_LENGTH, f)) {
+		int result = parse_result(line);
+		if (result < 0 || strlen(line) < 8)
+			continue;
+
+		set_fen(board, line);
+		if (quiesce)
+			quiesce_position(board);
+
+		if (count == size) {
+			size = (size ? 2 * size : 65536);
+			*positions = (struct t_tune_position *)realloc(*positions, size * sizeof(struct t_tune_position));
+			assert(*positions);
+		}
+		pack_position(board, *positions + count);
+		(*positions)[count++].result = (uchar)result;
+	}
+
+	uci.stop = saved_stop;
+	fclose(f);
+	free(board);
+	return count;
+}
+
+//-- Handcrafted evaluation from white's point of view, bypassing the shared eval and pawn hash tables.
+//-- Dead draws are scored here: known_endgame_insufficient_material would also poke the draw into the hash.
+static t_chess_value tuning_score(struct t_board *board, struct t_chess_eval *eval)
+{
+	t_chess_value score;
+	void (*eval_endgame)(struct t_board *board, struct t_chess_eval *eval) = NULL;
+
+	if (board->material_index < MATERIAL_INDEX_SIZE)
+		eval_endgame = material_record[board->material_index].eval_endgame;
+
+	if (eval_endgame == &known_endgame_insufficient_material)
+		score = 0;
+	else if (eval_endgame) {
+		eval_endgame(board, eval);
+		score = eval->static_score;
+	}
+	else
+		score = calc_evaluation(board, eval);
+
+	return score * (1 - 2 * board->to_move);
+}
+
+//-- Expected score for white given an evaluation in centipawns
+static inline double win_probability(double k, t_chess_value score)
+{
+	return 1.0 / (1.0 + pow(10.0, -k * score / 400.0));
+}
+
+unsigned __stdcall tuning_thread(void *arguments)
+{
+	struct t_tune_thread *thread = (struct t_tune_thread *)arguments;
+
+	thread->error = 0;
+	for (int i = 0; i < thread->count; i++) {
+		struct t_tune_position *p = thread->positions + i;
+
+		unpack_position(thread->board, p);
+		t_chess_value score = tuning_score(thread->board, thread->eval);
+		if (thread->scores)
+			thread->scores[i] = score;
+
+		double e = p->result / 2.0 - win_probability(thread->k, score);
+		thread->error += e * e;
+	}
+
+	_endthreadex(0);
+	return 0;
+}
+
+//-- Mean squared error between the results and the evaluation of every position, split across threads
+double tuning_loss(struct t_tune_position *positions, int count, double k, int threads, t_chess_value *scores)
+{
+	struct t_tune_thread thread[TUNE_MAX_THREADS];
+	HANDLE handle[TUNE_MAX_THREADS];
+	unsigned id;
+	double error = 0;
+
+	if (count <= 0)
+		return 0;
+	if (threads < 1) threads = 1;
+	if (threads > TUNE_MAX_THREADS) threads = TUNE_MAX_THREADS;
+	if (threads > count) threads = count;
+
+	int slice = (count + threads - 1) / threads;
+	threads = (count + slice - 1) / slice;
+
+	for (int t = 0; t < threads; t++) {
+		int first = t * slice;
+		thread[t].positions = positions + first;
+		thread[t].count = (first + slice <= count ? slice : count - first);
+		thread[t].k = k;
+		thread[t].scores = (scores ? scores + first : NULL);
+		thread[t].board = (struct t_board *)malloc(sizeof(struct t_board));
+		assert(thread[t].board);
+		init_board(thread[t].board);
+		init_eval(thread[t].eval);
+
+		//-- Pawn terms may have changed since the last call, so each call starts with an empty table
+		thread[t].eval->pawn_table = (struct t_pawn_hash_record *)calloc(TUNE_PAWN_HASH_SIZE, sizeof(struct t_pawn_hash_record));
+		assert(thread[t].eval->pawn_table);
+		thread[t].eval->pawn_table_mask = TUNE_PAWN_HASH_SIZE - 1;
+
+		handle[t] = (HANDLE)_beginthreadex(NULL, 0, &tuning_thread, &thread[t], 0, &id);
+	}
+
+	for (int t = 0; t < threads; t++) {
+		WaitForSingleObject(handle[t], INFINITE);
+		CloseHandle(handle[t]);
+		error += thread[t].error;
+		free(thread[t].eval->pawn_table);
+		free(thread[t].board);
+	}
+
+	return error / count;
+}
+
+//-- The same loss from scores already worked out (the evaluation does not depend on K)
+static double scores_loss(struct t_tune_position *positions, t_chess_value *scores, int count, double k)
+{
+	double error = 0;
+
+	for (int i = 0; i < count; i++) {
+		double e = positions[i].result / 2.0 - win_probability(k, scores[i]);
+		error += e * e;
+	}
+	return error / count;
+}
+
+//-- The scaling constant which best maps the current evaluation onto the results
+static double fit_scaling_constant(struct t_tune_position *positions, t_chess_value *scores, int count)
+{
+	double k = 1.0;
+	double best = scores_loss(positions, scores, count, k);
+
+	for (double step = 0.1; step > 0.0001; step /= 10) {
+		BOOL improved = TRUE;
+		while (improved) {
+			improved = FALSE;
+			for (int direction = -1; direction <= 1; direction += 2) {
+				double e = scores_loss(positions, scores, count, k + direction * step);
+				if (k + direction * step > 0 && e < best) {
+					best = e;
+					k += direction * step;
+					improved = TRUE;
+					break;
+				}
+			}
+		}
+	}
+	return k;
+}
+
+//-- "tune <file> [quiesce] [threads <n>]": coordinate descent over tune_params, then the defaults are put back
+void tune_eval(char *s)
+{
+	char filename[TUNE_LINE_LENGTH];
+	struct t_tune_position *positions;
+	t_chess_value original[TUNE_PARAM_COUNT];
+	BOOL quiesce = (index_of("quiesce", s) > 0);
+	int threads = processor_count();
+	int i;
+
+	if (!uci.engine_initialized)
+		init_engine(position);
+
+	if ((i = index_of("threads", s)) > 0)
+		threads = number_index(i + 1, s);
+
+	strcpy(filename, word_index(1, s));
+	unsigned long start = time_now();
+	int count = load_tuning_positions(filename, &positions, quiesce);
+	if (count == 0) {
+		free(positions);
+		return;
+	}
+	printf("info string Tune: %d positions (%d bytes each) loaded in %d milliseconds\n", count, (int)sizeof(struct t_tune_position), time_now() - start);
+
+	//-- Score everything once to measure the speed and fit K
+	t_chess_value *scores = (t_chess_value *)malloc(count * sizeof(t_chess_value));
+	assert(scores);
+
+	start = time_now();
+	tuning_loss(positions, count, 1.0, threads, scores);
+	unsigned long finish = time_now();
+	if (finish == start)
+		finish++;
+	printf("info string Tune: %d positions evaluated in %d milliseconds = %I64d positions per second on %d threads\n",
+		   count, finish - start, (long long)1000 * count / (finish - start), threads);
+
+	double k = fit_scaling_constant(positions, scores, count);
+	double best = scores_loss(positions, scores, count, k);
+	printf("info string Tune: K = %.4f, loss = %.8f\n", k, best);
+	free(scores);
+
+	for (i = 0; i < TUNE_PARAM_COUNT; i++)
+		original[i] = *tune_params[i].value;
+
+	//-- Coordinate descent: nudge each term by one until nothing improves the loss
+	for (int pass = 1; pass <= TUNE_MAX_PASSES; pass++) {
+		BOOL improved = FALSE;
+
+		for (i = 0; i < TUNE_PARAM_COUNT; i++) {
+			t_chess_value value = *tune_params[i].value;
+
+			for (int delta = 1; delta >= -1; delta -= 2) {
+				*tune_params[i].value = value + delta;
+				if (tune_params[i].pst)
+					init_piece_square_tables();
+				fill_material_records();
+
+				double e = tuning_loss(positions, count, k, threads, NULL);
+				if (e < best) {
+					best = e;
+					improved = TRUE;
+					break;
+				}
+				*tune_params[i].value = value;
+				if (tune_params[i].pst)
+					init_piece_square_tables();
+				fill_material_records();
+			}
+		}
+
+		printf("info string Tune: pass %d, loss = %.8f\n", pass, best);
+		if (!improved)
+			break;
+	}
+
+	for (i = 0; i < TUNE_PARAM_COUNT; i++)
+		printf("info string Tune: %s = %d (was %d)\n", tune_params[i].name, *tune_params[i].value, original[i]);
+
+	//-- The move directory's piece-square deltas were built from the defaults, so put them back
+	init_eval_function();
+	free(positions);
+}
@@ -134,6 +134,18 @@ void listen_for_uci_input()
             test_perft();
         if (!strcmp(input_string, "testbook") || !strcmp(input_string, "TESTBOOK"))
             test_book();
+        if ((index_of("evalbench", input_string) == 0) || (index_of("EVALBENCH", input_string) == 0))
+            eval_bench(word_index(1, input_string));
+        if ((index_of("fillbench", input_string) == 0) || (index_of("FILLBENCH", input_string) == 0))
+            fill_bench(word_index(1, input_string));
+        if ((index_of("makebench", input_string) == 0) || (index_of("MAKEBENCH", input_string) == 0))
+            make_bench(word_index(1, input_string));
+        if (!strcmp(input_string, "footprint") || !strcmp(input_string, "FOOTPRINT"))
+            footprint_report();
+        if ((index_of("tune", input_string) == 0) || (index_of("TUNE", input_string) == 0))
+            tune_eval(input_string);
+        if ((index_of("tbgen", input_string) == 0) || (index_of("TBGEN", input_string) == 0))
+            generate_tablebases(input_string);
 
     }
     WaitForSingleObject(thread_handle, INFINITE);
@@ -204,6 +216,23 @@ void uci_set_mode()
     sprintf(s, "option name UCI_EngineAbout type string default Maverick (v%s) by Steve Maughan www.chessprogramming.net", ENGINE_VERSION);
     send_command(s);
 
+	sprintf(s, "option name Eval Hash type spin default %d min %d max %d", EVAL_HASH_DEFAULT, EVAL_HASH_MIN, EVAL_HASH_MAX);
+	send_command(s);
+
+	if (avx2_kernels_available()) {
+		strcpy(s, "option name Vector Eval type check default false");
+		send_command(s);
+	}
+
+	strcpy(s, "option name Fill Evasions type check default false");
+	send_command(s);
+
+	strcpy(s, "option name EvalFile type string default <empty>");
+	send_command(s);
+
+	strcpy(s, "option name TablebasePath type string default <empty>");
+	send_command(s);
+
 	strcpy(s, "option name Show Search Statistics type check default true");
 	uci.options.show_search_statistics = TRUE;
 	send_command(s);
@@ -212,6 +241,8 @@ void uci_set_mode()
 	uci.options.smart_book = FALSE;
 	send_command(s);
 
+	send_info(cpu_kernel_string());
+
 	strcpy(s, "uciok");
     send_command(s);
 }
@@ -354,6 +385,31 @@ void uci_setoption(char *s)
 		return;
     }
 
+	if ((index_of("EvalFile", s) == 2) || (index_of("evalfile", s) == 2) || (index_of("EVALFILE", s) == 2)) {
+		set_eval_file(leftstr(s, 4));
+		return;
+	}
+
+	if ((index_of("TablebasePath", s) == 2) || (index_of("tablebasepath", s) == 2) || (index_of("TABLEBASEPATH", s) == 2)) {
+		set_tablebase_path(leftstr(s, 4));
+		return;
+	}
+
+	if (((index_of("Fill", s) == 2) || (index_of("fill", s) == 2) || (index_of("FILL", s) == 2)) && ((index_of("Evasions", s) == 3) || (index_of("evasions", s) == 3) || (index_of("EVASIONS", s) == 3))) {
+		use_fill_evasions = (!strcmp(word_index(5, s), "true") || !strcmp(word_index(5, s), "TRUE"));
+		return;
+	}
+
+	if (((index_of("Vector", s) == 2) || (index_of("vector", s) == 2) || (index_of("VECTOR", s) == 2)) && ((index_of("Eval", s) == 3) || (index_of("eval", s) == 3) || (index_of("EVAL", s) == 3))) {
+		if (!strcmp(word_index(5, s), "true") || !strcmp(word_index(5, s), "TRUE"))
+			use_avx2 = avx2_kernels_available();
+		else
+			use_avx2 = FALSE;
+		select_fill_kernel();
+		send_info(cpu_kernel_string());
+		return;
+	}
+
 	if ((index_of("EvalTest", s) == 2) || (index_of("EVALTEST", s) == 2) || (index_of("evaltest", s) == 2)){
 		if (!strcmp(word_index(4, s), "true") || !strcmp(word_index(4, s), "TRUE"))
 			uci.options.eval_test = TRUE;
@@ -362,6 +418,12 @@ void uci_setoption(char *s)
 		return;
 	}
 
+	if (((index_of("Eval", s) == 2) || (index_of("eval", s) == 2) || (index_of("EVAL", s) == 2)) && ((index_of("Hash", s) == 3) || (index_of("hash", s) == 3) || (index_of("HASH", s) == 3))) {
+		int size = number_index(5, s);
+		set_eval_hash(size < EVAL_HASH_MIN ? EVAL_HASH_MIN : size);
+		return;
+	}
+
 	if((index_of("Statistics", s) == 4) || (index_of("statistics", s) == 4) || (index_of("STATISTICS", s) == 4)){
         if (!strcmp(word_index(6, s), "true") || !strcmp(word_index(6, s), "TRUE"))
         	uci.options.show_search_statistics = TRUE;
@@ -386,6 +448,8 @@ void uci_setoption(char *s)
 /*=======================================================*/
 void do_uci_new_pv(struct t_board *board, int score, int depth)
 {
+	(void)board;
+
 	//-- Don' waist bandwidth
 		if (depth < 2)
 			return;
@@ -411,10 +475,10 @@ void do_uci_new_pv(struct t_board *board, int score, int depth)
     }
 
     pv[0] = 0;
-    for (i = 0; i < board->pv_data[0].best_line_length; i++) {
+    for (i = 0; i < search_stack->ply[0].best_line_length; i++) {
         if (i>0)
             strcat(pv," ");
-        strcat(pv, move_as_str(board->pv_data[0].best_line[i]));
+        strcat(pv, move_as_str(search_stack->ply[0].best_line[i]));
     }
 
     strcat(s, pv);
@@ -424,6 +488,8 @@ void do_uci_new_pv(struct t_board *board, int score, int depth)
 
 void do_uci_fail_high(struct t_board *board, int score, int depth)
 {
+	(void)board;
+
 	//-- Don' waist bandwidth
 	if (depth < 4)
 		return;
@@ -449,13 +515,15 @@ void do_uci_fail_high(struct t_board *board, int score, int depth)
     else{
     	sprintf(s, "info score cp %d lowerbound time %ld depth %d seldepth %d nodes %I64d pv ", score, t, depth, deepest, nodes + qnodes);
     }
-    strcpy(pv,move_as_str(board->pv_data[0].current_move));
+    strcpy(pv,move_as_str(search_stack->ply[0].current_move));
     strcat(s,pv);
     send_command(s);
 }
 
 void do_uci_fail_low(struct t_board *board, int score, int depth)
 {
+    (void)board;
+
     static char pv[2048];
     static char s[2048];
 
@@ -477,7 +545,7 @@ void do_uci_fail_low(struct t_board *board, int score, int depth)
     else{
     	sprintf(s, "info score cp %d upperbound time %ld depth %d seldepth %d nodes %I64d pv ", score, t, depth, deepest, nodes + qnodes);
     }
-    strcpy(pv,move_as_str(board->pv_data[0].current_move));
+    strcpy(pv,move_as_str(search_stack->ply[0].current_move));
     strcat(s,pv);
     send_command(s);
 }
@@ -500,12 +568,14 @@ void do_uci_send_nodes()
 
 void do_uci_consider_move(struct t_board *board, int depth)
 {
+    (void)board;
+
     static char s[64];
     unsigned long t1;
 
     t1 = time_now();
     if (t1 - 300 > search_start_time) {
-        sprintf(s,"info currmove %s currmovenumber %d depth %d seldepth %d\n", move_as_str(board->pv_data[0].current_move), board->pv_data[0].legal_moves_played, depth, deepest);
+        sprintf(s,"info currmove %s currmovenumber %d depth %d seldepth %d\n", move_as_str(search_stack->ply[0].current_move), search_stack->ply[0].legal_moves_played, depth, deepest);
         send_command(s);
     }
 }
@@ -520,13 +590,15 @@ void do_uci_hash_full()
 
 void do_uci_bestmove(struct t_board *board)
 {
+    (void)board;
+
     static char s[64];
 
     strcpy(s, "bestmove ");
-    strcat(s, move_as_str(board->pv_data[0].best_line[0]));
-    if (board->pv_data[0].best_line_length > 1) {
+    strcat(s, move_as_str(search_stack->ply[0].best_line[0]));
+    if (search_stack->ply[0].best_line_length > 1) {
         strcat(s, " ponder ");
-        strcat(s, move_as_str(board->pv_data[0].best_line[1]));
+        strcat(s, move_as_str(search_stack->ply[0].best_line[1]));
     }
     send_command(s);
 }
@@ -541,19 +613,23 @@ void do_uci_depth()
 
 void uci_current_line(struct t_board *board, int ply)
 {
+    (void)board;
+
     static char s[1024];
     int i;
 
     strcpy(s, "info currline");
     for(i = 0; i < ply; i++){
     	strcat(s, " ");
-    	strcat(s, move_as_str(board->pv_data[i].current_move));
+    	strcat(s, move_as_str(search_stack->ply[i].current_move));
     }
     send_command(s);
 }
 
 BOOL is_search_complete(struct t_board *board, int score, int ply, struct t_move_list *move_list)
 {
+    (void)board;
+
     int s;
 
     //-- Maximum search depth
@@ -815,7 +891,7 @@ void do_uci_show_stats()
 
 		static char s[2048];
 		static char t[2048];
-		double n, f = 0, h = 0;
+		double n, f = 0, h = 0, e = 0;
 
     	/* nodes */
     	n = 100 * (double)qnodes / (qnodes + nodes);
@@ -827,12 +903,18 @@ void do_uci_show_stats()
     		h = (100 * h / hash_probes );
     	}
 
+    	/* eval cache performance */
+    	if (eval_hash_probes){
+    		e = (double)eval_hash_hits;
+    		e = (100 * e / eval_hash_probes);
+    	}
+
     	/* move order */
     	if (cutoffs){
     		f = first_move_cutoffs;
     		f = (100 * f / cutoffs );
     	}
-		sprintf(s, "info string QNodes = %3.1f%%, Hash Hits = %3.1f%%, Move Order = %3.1f%%\n", n, h, f);
+		sprintf(s, "info string QNodes = %3.1f%%, Hash Hits = %3.1f%%, Eval Cache Hits = %3.1f%%, Move Order = %3.1f%%\n", n, h, e, f);
 		send_command(s);
     }
 }
@@ -847,6 +929,8 @@ void send_info(char *s)
 
 void uci_new_game(struct t_board *board)
 {
+	(void)board;
+
 	if (uci.engine_state != UCI_ENGINE_WAITING)
 		uci_stop();
 
@@ -915,15 +999,20 @@ void init_engine(struct t_board *board)
 
 		uci.debug = FALSE;
         //initialize stuff
+        detect_cpu();
         init_eval_function();
         init_board(board);
+        init_search_stack(search_stack);
         init_hash();
         init_pawn_hash();
-        init_bitboards();
+        init_eval_hash();
         init_move_directory();
         init_magic();
         init_can_move();
-		init_material_hash();
+		init_cuckoo();
+		init_material_index();
+		init_kpk();
+		init_tablebases();
         uci.engine_initialized = TRUE;
     }
 };
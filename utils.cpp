@@ -9,6 +9,12 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
 #include "defs.h"
 #include "data.h"
 #include "procs.h"
@@ -183,3 +189,90 @@ void qsort_moves(struct t_move_list *move_list, int first, int last)
     if (first < high) qsort_moves(move_list, first, high);
     if (low < last) qsort_moves(move_list, low, last);
 }
+
+static void cpuid(unsigned int leaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex((int *)regs, leaf, 0);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+//-- XCR0: which register states the OS saves on a context switch
+static unsigned long long xgetbv0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    return 0;
+#endif
+}
+
+void detect_cpu()
+{
+    unsigned int regs[4];
+    unsigned int max_leaf, family;
+    BOOL amd, osxsave;
+
+    cpu.popcnt = cpu.bmi1 = cpu.bmi2 = cpu.avx2 = cpu.fast_pext = FALSE;
+
+#if defined(_WIN64) || defined(__x86_64__)
+    //-- Vendor and highest standard leaf
+    cpuid(0, regs);
+    max_leaf = regs[0];
+    amd = (regs[1] == 0x68747541 && regs[3] == 0x69746e65 && regs[2] == 0x444d4163);
+
+    cpuid(1, regs);
+    cpu.popcnt = ((regs[2] >> 23) & 1);
+    osxsave = ((regs[2] >> 27) & 1);
+    family = (regs[0] >> 8) & 0x0f;
+    if (family == 0x0f)
+        family += (regs[0] >> 20) & 0xff;
+
+    if (max_leaf >= 7) {
+        cpuid(7, regs);
+        cpu.bmi1 = ((regs[1] >> 3) & 1);
+        cpu.bmi2 = ((regs[1] >> 8) & 1);
+        //-- AVX2 also needs the OS to save the YMM registers
+        cpu.avx2 = ((regs[1] >> 5) & 1) && osxsave && ((xgetbv0() & 6) == 6);
+    }
+
+    //-- AMD before Zen 3 (family 19h) microcodes PEXT and it's far slower than a multiply
+    cpu.fast_pext = cpu.bmi2 && !(amd && family < 0x19);
+#endif
+
+    use_popcnt = cpu.popcnt;
+    //-- The vector eval kernels are opt-in ("Vector Eval"); on the machines measured so far the scalar ones are faster
+    use_avx2 = FALSE;
+    select_fill_kernel();
+}
+
+char *cpu_kernel_string()
+{
+    static char s[256];
+
+    sprintf(s, "CPU kernels: popcount %s, bitscan %s, sliders %s, vector %s",
+            use_popcnt ? "popcnt" : "software",
+#if defined(_MSC_VER) || defined(__GNUC__)
+            cpu.bmi1 ? "tzcnt" : "bsf",
+#else
+            "de bruijn",
+#endif
+            cpu.fast_pext ? "pext" : "magic",
+            use_avx2 ? "avx2" : "scalar");
+    return s;
+}
+
+int processor_count()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
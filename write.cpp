@@ -123,6 +123,8 @@ void write_move_list(struct t_move_list *move_list, char filename[1024])
 }
 
 void write_path(struct t_board *board, int ply, char filename[1024]) {
+    (void)board;
+
     FILE *tfile = NULL;
     int i;
     char s[10];
@@ -130,7 +132,7 @@ void write_path(struct t_board *board, int ply, char filename[1024]) {
     tfile = fopen(filename, "w");
 
     for (i = 0; i < ply; i++) {
-        strcpy(s, move_as_str(board->pv_data[i].current_move));
+        strcpy(s, move_as_str(search_stack->ply[i].current_move));
         fprintf(tfile, s);
         fprintf(tfile, "\n");
     }